@@ -0,0 +1,190 @@
+// weatherclock-bench: compares the old json-glib DOM path of parse_weather_json
+// against the streaming forecast_parse() on recorded Open-Meteo responses.
+//
+// Usage: weatherclock-bench [--iterations N] [response.json ...]
+// Without files, the recordings in bench/data are used.
+
+#include <glib.h>
+#include <json-glib/json-glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "forecast.h"
+
+#define DEFAULT_ITERATIONS 2000
+
+#ifndef BENCH_DATA_DIR
+#define BENCH_DATA_DIR "bench/data"
+#endif
+
+static const char *default_recordings[] = {
+    "toronto-2d.json",
+    "berlin-16d.json",
+    "error-latitude.json",
+};
+
+// The pre-streaming implementation: build the DOM, then walk every cell with
+// json_array_get_element/json_node_get_value_type into the same columns.
+static gboolean dom_parse(const char *json_data_str, WeatherForecast *out) {
+    out->n_hours = 0;
+    if (!json_data_str || strlen(json_data_str) == 0 || json_data_str[0] == '<') {
+        return FALSE;
+    }
+    if (strlen(json_data_str) >= 500) {
+        gchar *preview = g_strndup(json_data_str, 500);
+        g_free(preview);
+    }
+
+    JsonParser *parser = json_parser_new();
+    if (!json_parser_load_from_data(parser, json_data_str, -1, NULL)) {
+        g_object_unref(parser);
+        return FALSE;
+    }
+    JsonNode *root = json_parser_get_root(parser);
+    JsonObject *root_obj = root ? json_node_get_object(root) : NULL;
+    if (!root_obj) {
+        g_object_unref(parser);
+        return FALSE;
+    }
+
+    if (json_object_has_member(root_obj, "timezone")) {
+        const gchar *tz_str = json_node_get_string(json_object_get_member(root_obj, "timezone"));
+        if (tz_str) {
+            g_strlcpy(out->timezone, tz_str, sizeof(out->timezone));
+        }
+    }
+    if (json_object_has_member(root_obj, "utc_offset_seconds")) {
+        JsonNode *offset_node = json_object_get_member(root_obj, "utc_offset_seconds");
+        if (json_node_get_value_type(offset_node) == G_TYPE_INT64) {
+            out->utc_offset_seconds = (gint)json_node_get_int(offset_node);
+        } else if (json_node_get_value_type(offset_node) == G_TYPE_DOUBLE) {
+            out->utc_offset_seconds = (gint)json_node_get_double(offset_node);
+        }
+    }
+    if (json_object_has_member(root_obj, "error") || !json_object_has_member(root_obj, "hourly")) {
+        g_object_unref(parser);
+        return FALSE;
+    }
+
+    JsonObject *hourly = json_object_get_object_member(root_obj, "hourly");
+    JsonArray *time_array = hourly ? json_object_get_array_member(hourly, "time") : NULL;
+    JsonArray *temp_array = hourly ? json_object_get_array_member(hourly, "temperature_2m") : NULL;
+    JsonArray *code_array = hourly ? json_object_get_array_member(hourly, "weathercode") : NULL;
+    if (!time_array || !temp_array || !code_array) {
+        g_object_unref(parser);
+        return FALSE;
+    }
+
+    guint length = json_array_get_length(time_array);
+    length = MIN(length, MIN(json_array_get_length(temp_array), json_array_get_length(code_array)));
+    length = MIN(length, out->capacity);
+    for (guint i = 0; i < length; i++) {
+        const gchar *time_str = json_node_get_string(json_array_get_element(time_array, i));
+        JsonNode *temp_node = json_array_get_element(temp_array, i);
+        JsonNode *code_node = json_array_get_element(code_array, i);
+
+        out->hours[i] = FORECAST_HOUR_INVALID;
+        if (time_str && strlen(time_str) >= 16) {
+            out->hours[i] = forecast_hours_from_civil(atoi(time_str), atoi(time_str + 5),
+                                                      atoi(time_str + 8), atoi(time_str + 11));
+        }
+        out->temps[i] = 0.0f;
+        if (json_node_get_value_type(temp_node) == G_TYPE_DOUBLE) {
+            out->temps[i] = (gfloat)json_node_get_double(temp_node);
+        } else if (json_node_get_value_type(temp_node) == G_TYPE_INT64) {
+            out->temps[i] = (gfloat)json_node_get_int(temp_node);
+        }
+        out->codes[i] = 0;
+        if (json_node_get_value_type(code_node) == G_TYPE_INT64) {
+            out->codes[i] = (guint8)json_node_get_int(code_node);
+        } else if (json_node_get_value_type(code_node) == G_TYPE_DOUBLE) {
+            out->codes[i] = (guint8)json_node_get_double(code_node);
+        }
+    }
+    out->n_hours = length;
+
+    g_object_unref(parser);
+    return TRUE;
+}
+
+static void discard_log(const gchar *domain, GLogLevelFlags level, const gchar *message, gpointer user_data) {
+    (void)domain;
+    (void)level;
+    (void)message;
+    (void)user_data;
+}
+
+static void bench_recording(const char *path, guint iterations) {
+    gchar *contents = NULL;
+    gsize length = 0;
+    GError *error = NULL;
+
+    if (!g_file_get_contents(path, &contents, &length, &error)) {
+        fprintf(stderr, "Skipping %s: %s\n", path, error->message);
+        g_error_free(error);
+        return;
+    }
+
+    WeatherForecast *forecast = forecast_new();
+    char error_msg[FORECAST_ERROR_MAX];
+
+    // Warm up and size the column buffers so neither path measures growth
+    ForecastParseResult result = forecast_parse(forecast, contents, length, error_msg, sizeof(error_msg));
+    guint stream_hours = forecast->n_hours;
+
+    gint64 start = g_get_monotonic_time();
+    for (guint i = 0; i < iterations; i++) {
+        forecast_parse(forecast, contents, length, error_msg, sizeof(error_msg));
+    }
+    gint64 stream_us = g_get_monotonic_time() - start;
+
+    dom_parse(contents, forecast);
+    guint dom_hours = forecast->n_hours;
+
+    start = g_get_monotonic_time();
+    for (guint i = 0; i < iterations; i++) {
+        dom_parse(contents, forecast);
+    }
+    gint64 dom_us = g_get_monotonic_time() - start;
+
+    gdouble stream_ns = stream_us * 1000.0 / iterations;
+    gdouble dom_ns = dom_us * 1000.0 / iterations;
+    gchar *name = g_path_get_basename(path);
+    printf("%-22s %8" G_GSIZE_FORMAT " B %5u h  dom %10.0f ns  stream %10.0f ns  %6.1fx  %7.1f MB/s%s\n",
+           name, length, stream_hours, dom_ns, stream_ns, stream_ns > 0 ? dom_ns / stream_ns : 0.0,
+           stream_ns > 0 ? length / stream_ns * 1000.0 : 0.0,
+           result == FORECAST_PARSE_OK && dom_hours != stream_hours ? "  (hour count mismatch!)" : "");
+
+    g_free(name);
+    forecast_free(forecast);
+    g_free(contents);
+}
+
+int main(int argc, char *argv[]) {
+    guint iterations = DEFAULT_ITERATIONS;
+    int first_file = 1;
+
+    if (argc >= 3 && strcmp(argv[1], "--iterations") == 0) {
+        iterations = (guint)MAX(1, atoi(argv[2]));
+        first_file = 3;
+    }
+
+    // Parse warnings for malformed recordings would repeat once per iteration
+    g_log_set_handler(NULL, G_LOG_LEVEL_WARNING, discard_log, NULL);
+
+    printf("%-22s %10s %7s  %-13s  %-16s  %7s  %s\n", "recording", "size", "hours",
+           "dom/op", "stream/op", "speedup", "stream rate");
+    if (first_file < argc) {
+        for (int i = first_file; i < argc; i++) {
+            bench_recording(argv[i], iterations);
+        }
+    } else {
+        for (gsize i = 0; i < G_N_ELEMENTS(default_recordings); i++) {
+            gchar *path = g_build_filename(BENCH_DATA_DIR, default_recordings[i], NULL);
+            bench_recording(path, iterations);
+            g_free(path);
+        }
+    }
+    return 0;
+}
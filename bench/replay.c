@@ -0,0 +1,602 @@
+// weatherclock-replay: runs recorded Open-Meteo responses through the pipeline
+// the app runs after each fetch, without the network: decode, cache encode and
+// reload, daily aggregates, commit to the forecast strips, draw and rasterize
+// them, and one clock tick. Reports p50/p99 latency, throughput and heap
+// allocations per stage.
+//
+// Usage: weatherclock-replay [--iterations N] [--hours N] [--days N] [--soak MONTHS [--compact]]
+//                            [response.json ...]
+// Without files, the recordings in bench/data are used. --soak instead runs
+// MONTHS simulated months of hourly refreshes, the recordings taking turns, and
+// reports resident memory at the end of each month; --compact applies the
+// app's [Memory] compact settings first. The widget stages need
+// a display; on a headless machine run under broadwayd (GDK_BACKEND=broadway)
+// or xvfb-run. Without any display they are skipped.
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L  // clock_gettime() under -std=c11
+#endif
+
+#include <gtk/gtk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "clockface.h"
+#include "forecast.h"
+#include "metrics.h"
+#include "strip.h"
+
+#define DEFAULT_ITERATIONS 500
+#define DEFAULT_HOURS 6        // The app's default hours_to_show
+#define MAX_LOCATIONS 8        // As in main.c: locations fetched in one batch request
+#define SOAK_REFRESHES_PER_MONTH (30 * 24)
+#define COMPACT_MALLOC_ARENAS 2  // As in main.c
+
+#ifndef BENCH_DATA_DIR
+#define BENCH_DATA_DIR "bench/data"
+#endif
+
+static const char *default_recordings[] = {
+    "toronto-2d.json",
+    "berlin-16d.json",
+    "batch-toronto-berlin.json",
+    "error-latitude.json",
+};
+
+// Heap allocation counting: glibc lets the executable interpose malloc and
+// forward to the real allocator. Counts every thread, GTK's included.
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static guint64 n_allocations;
+
+void *malloc(size_t size) {
+    __atomic_fetch_add(&n_allocations, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+    __atomic_fetch_add(&n_allocations, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    __atomic_fetch_add(&n_allocations, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+#define HAVE_ALLOCATION_COUNT 1
+static guint64 allocation_count(void) {
+    return __atomic_load_n(&n_allocations, __ATOMIC_RELAXED);
+}
+#else
+#define HAVE_ALLOCATION_COUNT 0
+static guint64 allocation_count(void) {
+    return 0;
+}
+#endif
+
+typedef enum {
+    STAGE_PARSE,      // forecast_parse_batch(), as on the decode worker
+    STAGE_ENCODE,     // forecast_cache_encode() of every location, as forecast_refreshed()
+    STAGE_RELOAD,     // forecast_cache_decode() of those records, as the launch path
+    STAGE_DAILY,      // forecast_daily_update() on the reloaded forecasts, with one changed day
+    STAGE_COMMIT,     // forecast_find_hour() and weather_strip_set_forecast() per strip
+    STAGE_DRAW,       // Strip snapshots to render nodes
+    STAGE_RASTER,     // Those nodes rendered to a texture by the window's renderer
+    STAGE_CLOCK,      // clock_face_set_text() for the next second, snapshot and raster
+    N_STAGES
+} Stage;
+
+static const char *stage_names[N_STAGES] = { "parse", "encode", "reload", "daily", "commit", "draw", "raster", "clock" };
+
+typedef struct {
+    GArray *samples;       // gint64 nanoseconds, one per iteration
+    guint64 allocations;
+} StageStats;
+
+// The widgets the commit, draw and clock stages work on (NULL without a display)
+typedef struct {
+    GtkWidget *window;
+    GtkWidget *strips[MAX_LOCATIONS];
+    GtkWidget *clock;
+    GskRenderer *renderer;
+} Scene;
+
+static gint64 now_ns(void) {
+#ifdef G_OS_UNIX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (gint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+    return g_get_monotonic_time() * 1000;
+#endif
+}
+
+static void discard_log(const gchar *domain, GLogLevelFlags level, const gchar *message, gpointer user_data) {
+    (void)domain;
+    (void)level;
+    (void)message;
+    (void)user_data;
+}
+
+// Top-level elements of a root array (a batch response), or 1 for an object
+static guint count_locations(const gchar *json, gsize length) {
+    gsize i = 0;
+    while (i < length && g_ascii_isspace(json[i])) {
+        i++;
+    }
+    if (i == length || json[i] != '[') {
+        return 1;
+    }
+
+    guint count = 0;
+    gint depth = 0;
+    gboolean in_string = FALSE;
+    for (; i < length; i++) {
+        gchar c = json[i];
+        if (in_string) {
+            if (c == '\\') {
+                i++;
+            } else if (c == '"') {
+                in_string = FALSE;
+            }
+        } else if (c == '"') {
+            in_string = TRUE;
+        } else if (c == '{' || c == '[') {
+            if (depth++ == 1 && c == '{') {
+                count++;
+            }
+        } else if (c == '}' || c == ']') {
+            depth--;
+        }
+    }
+    return CLAMP(count, 1, MAX_LOCATIONS);
+}
+
+static gboolean scene_init(Scene *scene, guint hours, guint days) {
+    memset(scene, 0, sizeof(*scene));
+    if (!gtk_init_check()) {
+        return FALSE;
+    }
+
+    // Realized for its renderer, never shown
+    scene->window = gtk_window_new();
+    GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+    for (guint i = 0; i < MAX_LOCATIONS; i++) {
+        scene->strips[i] = weather_strip_new(hours, days);
+        gtk_box_append(GTK_BOX(box), scene->strips[i]);
+    }
+    scene->clock = clock_face_new("00:00:00");
+    gtk_box_append(GTK_BOX(box), scene->clock);
+    gtk_window_set_child(GTK_WINDOW(scene->window), box);
+    gtk_widget_realize(scene->window);
+    scene->renderer = gtk_native_get_renderer(GTK_NATIVE(scene->window));
+    return TRUE;
+}
+
+static void scene_free(Scene *scene) {
+    if (scene->window) {
+        gtk_window_destroy(GTK_WINDOW(scene->window));
+    }
+    memset(scene, 0, sizeof(*scene));
+}
+
+static GskRenderNode *snapshot_widget(GtkWidget *widget) {
+    GtkSnapshot *snapshot = gtk_snapshot_new();
+    GTK_WIDGET_GET_CLASS(widget)->snapshot(widget, snapshot);
+    return gtk_snapshot_free_to_node(snapshot);
+}
+
+static void raster_node(Scene *scene, GskRenderNode *node) {
+    if (!scene->renderer || !node) {
+        return;
+    }
+    GdkTexture *texture = gsk_renderer_render_texture(scene->renderer, node, NULL);
+    if (texture) {
+        g_object_unref(texture);
+    }
+}
+
+// Close the stage that began at *start and begin the next one
+static void end_stage(StageStats *stats, gint64 *start, guint64 *allocations) {
+    gint64 elapsed = now_ns() - *start;
+    g_array_append_val(stats->samples, elapsed);
+    stats->allocations += allocation_count() - *allocations;
+    *allocations = allocation_count();
+    *start = now_ns();
+}
+
+static int compare_samples(const void *a, const void *b) {
+    gint64 x = *(const gint64 *)a;
+    gint64 y = *(const gint64 *)b;
+    return (x > y) - (x < y);
+}
+
+static gdouble percentile_us(GArray *samples, gdouble fraction) {
+    guint index = (guint)(fraction * (samples->len - 1) + 0.5);
+    return g_array_index(samples, gint64, index) / 1000.0;
+}
+
+static void report_stage(Stage stage, StageStats *stats, gsize input_bytes) {
+    GArray *samples = stats->samples;
+    if (samples->len == 0) {
+        return;
+    }
+
+    gint64 total = 0;
+    for (guint i = 0; i < samples->len; i++) {
+        total += g_array_index(samples, gint64, i);
+    }
+    qsort(samples->data, samples->len, sizeof(gint64), compare_samples);
+    gdouble mean_ns = (gdouble)total / samples->len;
+
+    char rate[32];
+    if (stage == STAGE_PARSE && input_bytes > 0) {
+        snprintf(rate, sizeof(rate), "%8.1f MB/s", input_bytes / mean_ns * 1000.0);
+    } else {
+        snprintf(rate, sizeof(rate), "%8.0f op/s", mean_ns > 0 ? 1e9 / mean_ns : 0.0);
+    }
+    char allocations[24];
+    if (HAVE_ALLOCATION_COUNT) {
+        snprintf(allocations, sizeof(allocations), "%8.1f", (gdouble)stats->allocations / samples->len);
+    } else {
+        g_strlcpy(allocations, "     n/a", sizeof(allocations));
+    }
+    printf("  %-8s p50 %9.1f us  p99 %9.1f us  %s  %s allocs/op\n", stage_names[stage],
+           percentile_us(samples, 0.50), percentile_us(samples, 0.99), rate, allocations);
+}
+
+static void bench_recording(const char *path, guint iterations, Scene *scene) {
+    gchar *contents = NULL;
+    gsize length = 0;
+    GError *error = NULL;
+
+    if (!g_file_get_contents(path, &contents, &length, &error)) {
+        fprintf(stderr, "Skipping %s: %s\n", path, error->message);
+        g_error_free(error);
+        return;
+    }
+
+    guint n_locations = count_locations(contents, length);
+    WeatherForecast *forecasts[MAX_LOCATIONS];
+    WeatherForecast *reloaded[MAX_LOCATIONS];
+    ForecastDaily *dailies[MAX_LOCATIONS];
+    GBytes *records[MAX_LOCATIONS];
+    for (guint i = 0; i < n_locations; i++) {
+        forecasts[i] = forecast_new();
+        reloaded[i] = forecast_new();
+        dailies[i] = forecast_daily_new();
+    }
+    char error_msg[FORECAST_ERROR_MAX];
+
+    // Warm up, so no stage measures its buffers growing to the recording's size
+    ForecastParseResult result = forecast_parse_batch(forecasts, n_locations, contents, length,
+                                                      error_msg, sizeof(error_msg));
+    gboolean full = result == FORECAST_PARSE_OK;
+    gboolean widgets = full && scene->window;
+
+    StageStats stats[N_STAGES];
+    for (guint s = 0; s < N_STAGES; s++) {
+        stats[s].samples = g_array_sized_new(FALSE, FALSE, sizeof(gint64), iterations);
+        stats[s].allocations = 0;
+    }
+
+    // Wall-clock second the clock stage starts from
+    gint64 clock_second = 12 * 3600 + 34 * 60;
+
+    for (guint iteration = 0; iteration < iterations; iteration++) {
+        gint64 start = now_ns();
+        guint64 allocations = allocation_count();
+
+        forecast_parse_batch(forecasts, n_locations, contents, length, error_msg, sizeof(error_msg));
+        end_stage(&stats[STAGE_PARSE], &start, &allocations);
+        if (!full) {
+            continue;  // An error response stops after decoding
+        }
+
+        for (guint i = 0; i < n_locations; i++) {
+            records[i] = forecast_cache_encode(forecasts[i], "bench", 0);
+        }
+        end_stage(&stats[STAGE_ENCODE], &start, &allocations);
+
+        for (guint i = 0; i < n_locations; i++) {
+            gsize record_length = 0;
+            const guint8 *record = g_bytes_get_data(records[i], &record_length);
+            gchar location[FORECAST_CACHE_LOCATION_MAX];
+            gint64 fetched_at = 0;
+            forecast_cache_decode(reloaded[i], record, record_length, location, sizeof(location), &fetched_at, NULL);
+        }
+        end_stage(&stats[STAGE_RELOAD], &start, &allocations);
+        for (guint i = 0; i < n_locations; i++) {
+            g_bytes_unref(records[i]);
+        }
+
+        // Odd iterations bump the last hour and even ones reload the original, so
+        // each update sees one changed day, like a refresh that only moved the far
+        // end of the forecast
+        start = now_ns();
+        allocations = allocation_count();
+        for (guint i = 0; i < n_locations; i++) {
+            WeatherForecast *forecast = reloaded[i];
+            if ((iteration & 1) && forecast->n_hours > 0) {
+                forecast->temps[forecast->n_hours - 1] += 1.0f;
+            }
+            forecast_daily_update(dailies[i], forecast);
+        }
+        end_stage(&stats[STAGE_DAILY], &start, &allocations);
+        if (!widgets) {
+            continue;
+        }
+
+        // Alternate between the first and second hour, so every commit moves
+        // the strip on by one card like an hourly refresh does
+        start = now_ns();
+        allocations = allocation_count();
+        for (guint i = 0; i < n_locations; i++) {
+            const WeatherForecast *forecast = forecasts[i];
+            gint64 now = forecast->n_hours > 1 ? forecast->times[iteration & 1] : 0;
+            guint start_index = forecast_find_hour(forecast, now);
+            weather_strip_set_forecast(WEATHER_STRIP(scene->strips[i]), forecast,
+                                       start_index < forecast->n_hours ? start_index : 0);
+            weather_strip_set_days(WEATHER_STRIP(scene->strips[i]), dailies[i]->days, dailies[i]->n_days);
+        }
+        end_stage(&stats[STAGE_COMMIT], &start, &allocations);
+
+        GskRenderNode *nodes[MAX_LOCATIONS];
+        for (guint i = 0; i < n_locations; i++) {
+            nodes[i] = snapshot_widget(scene->strips[i]);
+        }
+        end_stage(&stats[STAGE_DRAW], &start, &allocations);
+
+        if (scene->renderer) {
+            for (guint i = 0; i < n_locations; i++) {
+                raster_node(scene, nodes[i]);
+            }
+            end_stage(&stats[STAGE_RASTER], &start, &allocations);
+        }
+        for (guint i = 0; i < n_locations; i++) {
+            if (nodes[i]) {
+                gsk_render_node_unref(nodes[i]);
+            }
+        }
+
+        gint64 second = clock_second + iteration;
+        char text[CLOCK_FACE_MAX_CHARS];
+        start = now_ns();
+        allocations = allocation_count();
+        snprintf(text, sizeof(text), "%02d:%02d:%02d", (int)(second / 3600 % 24), (int)(second / 60 % 60),
+                 (int)(second % 60));
+        clock_face_set_text(CLOCK_FACE(scene->clock), text);
+        GskRenderNode *clock_node = snapshot_widget(scene->clock);
+        raster_node(scene, clock_node);
+        if (clock_node) {
+            gsk_render_node_unref(clock_node);
+        }
+        end_stage(&stats[STAGE_CLOCK], &start, &allocations);
+    }
+
+    gchar *name = g_path_get_basename(path);
+    printf("%s: %" G_GSIZE_FORMAT " B, %u location(s), %u h%s\n", name, length, n_locations,
+           forecasts[0]->n_hours, full ? "" : " (error response: decode only)");
+    for (guint s = 0; s < N_STAGES; s++) {
+        report_stage((Stage)s, &stats[s], length);
+        g_array_free(stats[s].samples, TRUE);
+    }
+
+    g_free(name);
+    for (guint i = 0; i < n_locations; i++) {
+        forecast_free(forecasts[i]);
+        forecast_free(reloaded[i]);
+        forecast_daily_free(dailies[i]);
+    }
+    g_free(contents);
+}
+
+// Heap bytes in use, where glibc can say
+static guint64 heap_in_use(void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+static void report_memory(const char *label, guint64 allocations, guint refreshes) {
+    printf("  %-10s RSS %8.2f MiB  heap %8.2f MiB  %8.1f allocs/refresh\n", label,
+           metrics_resident_bytes() / 1048576.0, heap_in_use() / 1048576.0,
+           refreshes > 0 ? (gdouble)allocations / refreshes : 0.0);
+}
+
+// --soak: hourly refreshes as the app runs them. Each response arrives in a new
+// buffer as from libsoup and is decoded into the spare forecasts (main.c's
+// double-buffered snapshots), which are then swapped with the shown ones,
+// aggregated into days, cached and committed to the strips. After the buffers
+// have grown in the first month, RSS should stay flat.
+static void soak(char **paths, guint n_paths, guint months, gboolean compact, Scene *scene) {
+    GPtrArray *recordings = g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+    for (guint i = 0; i < n_paths; i++) {
+        gchar *contents = NULL;
+        gsize length = 0;
+        GError *error = NULL;
+        if (!g_file_get_contents(paths[i], &contents, &length, &error)) {
+            fprintf(stderr, "Skipping %s: %s\n", paths[i], error->message);
+            g_error_free(error);
+            continue;
+        }
+        g_ptr_array_add(recordings, g_bytes_new_take(contents, length));
+    }
+    guint n_recordings = recordings->len;
+    if (n_recordings == 0) {
+        g_ptr_array_unref(recordings);
+        return;
+    }
+
+    WeatherForecast *shown[MAX_LOCATIONS];
+    WeatherForecast *spare[MAX_LOCATIONS];
+    ForecastDaily *dailies[MAX_LOCATIONS];
+    for (guint i = 0; i < MAX_LOCATIONS; i++) {
+        shown[i] = forecast_new();
+        spare[i] = forecast_new();
+        dailies[i] = forecast_daily_new();
+    }
+    char error_msg[FORECAST_ERROR_MAX];
+
+    printf("Soak: %u month(s) of hourly refreshes over %u recording(s)%s\n", months, n_recordings,
+           compact ? ", compact heap" : "");
+    report_memory("start", 0, 0);
+    guint64 month_rss = 0;
+    guint64 first_month_rss = 0;
+    for (guint month = 1; month <= months; month++) {
+        guint64 allocations = allocation_count();
+        for (guint refresh = 0; refresh < SOAK_REFRESHES_PER_MONTH; refresh++) {
+            GBytes *recording = g_ptr_array_index(recordings, refresh % n_recordings);
+            gsize length = 0;
+            const gchar *json = g_bytes_get_data(recording, &length);
+            GBytes *body = g_bytes_new(json, length);
+            json = g_bytes_get_data(body, &length);
+
+            guint n_locations = count_locations(json, length);
+            if (forecast_parse_batch(spare, n_locations, json, length, error_msg, sizeof(error_msg)) ==
+                FORECAST_PARSE_OK) {
+                GByteArray *cache = g_byte_array_new();
+                for (guint i = 0; i < n_locations; i++) {
+                    WeatherForecast *previous = shown[i];
+                    shown[i] = spare[i];
+                    spare[i] = previous;
+                    forecast_daily_update(dailies[i], shown[i]);
+
+                    GBytes *record = forecast_cache_encode(shown[i], "soak", 0);
+                    g_byte_array_append(cache, g_bytes_get_data(record, NULL), (guint)g_bytes_get_size(record));
+                    g_bytes_unref(record);
+
+                    if (scene->window) {
+                        WeatherStrip *strip = WEATHER_STRIP(scene->strips[i]);
+                        weather_strip_set_forecast(strip, shown[i], 0);
+                        weather_strip_set_days(strip, dailies[i]->days, dailies[i]->n_days);
+                        GskRenderNode *node = snapshot_widget(scene->strips[i]);
+                        if (node) {
+                            gsk_render_node_unref(node);
+                        }
+                    }
+                }
+                g_byte_array_unref(cache);
+            }
+            g_bytes_unref(body);
+#ifdef __GLIBC__
+            if (compact) {
+                malloc_trim(0);
+            }
+#endif
+        }
+
+        char label[16];
+        snprintf(label, sizeof(label), "month %u", month);
+        report_memory(label, allocation_count() - allocations, SOAK_REFRESHES_PER_MONTH);
+        month_rss = metrics_resident_bytes();
+        if (month == 1) {
+            first_month_rss = month_rss;
+        }
+    }
+    if (months > 1 && first_month_rss > 0) {
+        printf("  RSS growth after month 1: %+.2f MiB\n",
+               ((gdouble)month_rss - (gdouble)first_month_rss) / 1048576.0);
+    }
+
+    for (guint i = 0; i < MAX_LOCATIONS; i++) {
+        forecast_free(shown[i]);
+        forecast_free(spare[i]);
+        forecast_daily_free(dailies[i]);
+    }
+    g_ptr_array_unref(recordings);
+}
+
+int main(int argc, char *argv[]) {
+    guint iterations = DEFAULT_ITERATIONS;
+    guint hours = DEFAULT_HOURS;
+    guint days = 0;
+    guint soak_months = 0;
+    gboolean compact = FALSE;
+    int first_file = 1;
+
+    while (first_file < argc) {
+        if (strcmp(argv[first_file], "--compact") == 0) {
+            compact = TRUE;
+            first_file++;
+            continue;
+        }
+        if (first_file + 1 >= argc) {
+            break;
+        }
+        if (strcmp(argv[first_file], "--iterations") == 0) {
+            iterations = (guint)MAX(1, atoi(argv[first_file + 1]));
+        } else if (strcmp(argv[first_file], "--hours") == 0) {
+            hours = (guint)CLAMP(atoi(argv[first_file + 1]), 1, 168);
+        } else if (strcmp(argv[first_file], "--days") == 0) {
+            days = (guint)CLAMP(atoi(argv[first_file + 1]), 0, 16);
+        } else if (strcmp(argv[first_file], "--soak") == 0) {
+            soak_months = (guint)CLAMP(atoi(argv[first_file + 1]), 1, 120);
+        } else {
+            break;
+        }
+        first_file += 2;
+    }
+
+#ifdef __GLIBC__
+    // Before GTK starts its threads, as main.c does
+    if (compact) {
+        mallopt(M_ARENA_MAX, COMPACT_MALLOC_ARENAS);
+    }
+#endif
+
+    // Parse warnings for malformed recordings would repeat once per iteration
+    g_log_set_handler(NULL, G_LOG_LEVEL_WARNING, discard_log, NULL);
+
+    Scene scene;
+    if (!scene_init(&scene, hours, days)) {
+        fprintf(stderr, "No display: skipping the commit, draw, raster and clock stages "
+                        "(try GDK_BACKEND=broadway with broadwayd, or xvfb-run)\n");
+    } else if (!scene.renderer) {
+        fprintf(stderr, "No renderer: skipping rasterization\n");
+    }
+    printf("%u iterations, %u hour cards and %u day panels per strip%s\n\n", iterations, hours, days,
+           HAVE_ALLOCATION_COUNT ? "" : " (allocation counts need glibc)");
+
+    if (soak_months > 0) {
+        char *paths[G_N_ELEMENTS(default_recordings)];
+        guint n_paths = 0;
+        if (first_file < argc) {
+            soak(argv + first_file, (guint)(argc - first_file), soak_months, compact, &scene);
+        } else {
+            for (gsize i = 0; i < G_N_ELEMENTS(default_recordings); i++) {
+                paths[n_paths++] = g_build_filename(BENCH_DATA_DIR, default_recordings[i], NULL);
+            }
+            soak(paths, n_paths, soak_months, compact, &scene);
+            for (guint i = 0; i < n_paths; i++) {
+                g_free(paths[i]);
+            }
+        }
+    } else if (first_file < argc) {
+        for (int i = first_file; i < argc; i++) {
+            bench_recording(argv[i], iterations, &scene);
+        }
+    } else {
+        for (gsize i = 0; i < G_N_ELEMENTS(default_recordings); i++) {
+            gchar *path = g_build_filename(BENCH_DATA_DIR, default_recordings[i], NULL);
+            bench_recording(path, iterations, &scene);
+            g_free(path);
+        }
+    }
+
+    scene_free(&scene);
+    return 0;
+}
@@ -0,0 +1,250 @@
+#include "broker.h"
+
+#include <string.h>
+
+static const gchar introspection_xml[] =
+    "<node>"
+    "  <interface name='" FORECAST_BROKER_INTERFACE "'>"
+    "    <method name='GetSnapshot'>"
+    "      <arg type='ay' name='snapshot' direction='out'/>"
+    "    </method>"
+    "    <signal name='SnapshotChanged'>"
+    "      <arg type='ay' name='snapshot'/>"
+    "    </signal>"
+    "  </interface>"
+    "</node>";
+
+struct _ForecastBroker {
+    gchar *bus_name;
+    guint owner_id;
+    GDBusConnection *connection;
+    GDBusNodeInfo *node_info;
+    guint registration_id;
+    guint subscription_id;
+    GCancellable *cancellable;   // Outstanding GetSnapshot calls
+    ForecastBrokerRole role;
+    GBytes *snapshot;            // Last published snapshot (owner only)
+    ForecastBrokerRoleFunc role_func;
+    ForecastBrokerSnapshotFunc snapshot_func;
+    gpointer user_data;
+};
+
+// Wrap without copying: the GVariant keeps a reference on the bytes
+static GVariant *snapshot_to_variant(GBytes *snapshot) {
+    return g_variant_new_from_bytes(G_VARIANT_TYPE_BYTESTRING, snapshot, TRUE);
+}
+
+static void deliver_snapshot(ForecastBroker *broker, GVariant *parameters) {
+    GVariant *child = g_variant_get_child_value(parameters, 0);
+    GBytes *bytes = g_variant_get_data_as_bytes(child);
+    if (g_bytes_get_size(bytes) > 0 && broker->snapshot_func) {
+        broker->snapshot_func(bytes, broker->user_data);
+    }
+    g_bytes_unref(bytes);
+    g_variant_unref(child);
+}
+
+static void handle_method_call(GDBusConnection *connection, const gchar *sender, const gchar *object_path,
+                               const gchar *interface_name, const gchar *method_name, GVariant *parameters,
+                               GDBusMethodInvocation *invocation, gpointer user_data) {
+    (void)connection;
+    (void)sender;
+    (void)object_path;
+    (void)interface_name;
+    (void)parameters;
+    ForecastBroker *broker = (ForecastBroker *)user_data;
+
+    if (g_strcmp0(method_name, "GetSnapshot") != 0) {
+        g_dbus_method_invocation_return_error(invocation, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+                                              "Unknown method %s", method_name);
+        return;
+    }
+    if (broker->role != FORECAST_BROKER_OWNER || !broker->snapshot) {
+        // Subscribers answer with an empty array; so does an owner that hasn't fetched yet
+        g_dbus_method_invocation_return_value(invocation, g_variant_new("(@ay)",
+                                              g_variant_new_array(G_VARIANT_TYPE_BYTE, NULL, 0)));
+        return;
+    }
+    g_dbus_method_invocation_return_value(invocation, g_variant_new("(@ay)", snapshot_to_variant(broker->snapshot)));
+}
+
+static const GDBusInterfaceVTable interface_vtable = {
+    handle_method_call,
+    NULL,
+    NULL,
+    { 0 }
+};
+
+static void on_snapshot_changed(GDBusConnection *connection, const gchar *sender_name, const gchar *object_path,
+                                const gchar *interface_name, const gchar *signal_name, GVariant *parameters,
+                                gpointer user_data) {
+    (void)connection;
+    (void)sender_name;
+    (void)object_path;
+    (void)interface_name;
+    (void)signal_name;
+    ForecastBroker *broker = (ForecastBroker *)user_data;
+
+    if (broker->role == FORECAST_BROKER_SUBSCRIBER &&
+        g_variant_is_of_type(parameters, G_VARIANT_TYPE("(ay)"))) {
+        deliver_snapshot(broker, parameters);
+    }
+}
+
+static void on_get_snapshot_reply(GObject *source_object, GAsyncResult *res, gpointer user_data) {
+    GError *error = NULL;
+    GVariant *reply = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source_object), res, &error);
+    if (!reply) {
+        // Cancelled means the broker is gone; don't touch it
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            g_info("Shared fetch: GetSnapshot failed: %s", error->message);
+        }
+        g_clear_error(&error);
+        return;
+    }
+
+    ForecastBroker *broker = (ForecastBroker *)user_data;
+    if (broker->role == FORECAST_BROKER_SUBSCRIBER) {
+        deliver_snapshot(broker, reply);
+    }
+    g_variant_unref(reply);
+}
+
+static void set_role(ForecastBroker *broker, ForecastBrokerRole role) {
+    if (broker->role == role) {
+        return;
+    }
+    broker->role = role;
+    if (broker->role_func) {
+        broker->role_func(role, broker->user_data);
+    }
+}
+
+static void on_bus_acquired(GDBusConnection *connection, const gchar *name, gpointer user_data) {
+    (void)name;
+    ForecastBroker *broker = (ForecastBroker *)user_data;
+    GError *error = NULL;
+
+    broker->connection = g_object_ref(connection);
+    broker->registration_id = g_dbus_connection_register_object(connection, FORECAST_BROKER_OBJECT_PATH,
+                                                                broker->node_info->interfaces[0],
+                                                                &interface_vtable, broker, NULL, &error);
+    if (broker->registration_id == 0) {
+        g_warning("Shared fetch: failed to export forecast object: %s", error ? error->message : "Unknown");
+        g_clear_error(&error);
+    }
+}
+
+static void on_name_acquired(GDBusConnection *connection, const gchar *name, gpointer user_data) {
+    (void)connection;
+    ForecastBroker *broker = (ForecastBroker *)user_data;
+
+    if (broker->subscription_id != 0) {
+        g_dbus_connection_signal_unsubscribe(broker->connection, broker->subscription_id);
+        broker->subscription_id = 0;
+    }
+    g_info("Shared fetch: this instance owns %s and fetches for the others", name);
+    set_role(broker, FORECAST_BROKER_OWNER);
+}
+
+static void on_name_lost(GDBusConnection *connection, const gchar *name, gpointer user_data) {
+    ForecastBroker *broker = (ForecastBroker *)user_data;
+
+    if (!connection) {
+        // No session bus (e.g. started outside a desktop session): fetch on our own
+        g_warning("Shared fetch: session bus unavailable, fetching independently");
+        set_role(broker, FORECAST_BROKER_OWNER);
+        return;
+    }
+
+    g_clear_pointer(&broker->snapshot, g_bytes_unref);
+    if (broker->subscription_id == 0) {
+        broker->subscription_id = g_dbus_connection_signal_subscribe(connection, name, FORECAST_BROKER_INTERFACE,
+                                                                     "SnapshotChanged", FORECAST_BROKER_OBJECT_PATH,
+                                                                     NULL, G_DBUS_SIGNAL_FLAGS_NONE,
+                                                                     on_snapshot_changed, broker, NULL);
+    }
+    g_info("Shared fetch: %s is owned by another instance, subscribing to its forecasts", name);
+    set_role(broker, FORECAST_BROKER_SUBSCRIBER);
+
+    // Catch up on the owner's current forecast instead of waiting for its next refresh
+    g_dbus_connection_call(connection, name, FORECAST_BROKER_OBJECT_PATH, FORECAST_BROKER_INTERFACE,
+                           "GetSnapshot", NULL, G_VARIANT_TYPE("(ay)"), G_DBUS_CALL_FLAGS_NONE, -1,
+                           broker->cancellable, on_get_snapshot_reply, broker);
+}
+
+ForecastBroker *forecast_broker_new(const gchar *location_key, ForecastBrokerRoleFunc role_func,
+                                    ForecastBrokerSnapshotFunc snapshot_func, gpointer user_data) {
+    ForecastBroker *broker = g_new0(ForecastBroker, 1);
+    broker->role = FORECAST_BROKER_PENDING;
+    broker->role_func = role_func;
+    broker->snapshot_func = snapshot_func;
+    broker->user_data = user_data;
+    broker->cancellable = g_cancellable_new();
+    broker->node_info = g_dbus_node_info_new_for_xml(introspection_xml, NULL);
+
+    // Bus name elements may not start with a digit, hence the 'L'
+    broker->bus_name = g_strdup_printf(FORECAST_BROKER_NAME_PREFIX ".L%08x",
+                                       g_str_hash(location_key ? location_key : ""));
+
+    // Default flags queue us behind the current owner, so ownership fails over
+    // to the next instance when the owner exits
+    broker->owner_id = g_bus_own_name(G_BUS_TYPE_SESSION, broker->bus_name, G_BUS_NAME_OWNER_FLAGS_NONE,
+                                      on_bus_acquired, on_name_acquired, on_name_lost, broker, NULL);
+    return broker;
+}
+
+void forecast_broker_free(ForecastBroker *broker) {
+    if (!broker) {
+        return;
+    }
+
+    g_cancellable_cancel(broker->cancellable);
+    g_object_unref(broker->cancellable);
+    if (broker->connection) {
+        if (broker->subscription_id != 0) {
+            g_dbus_connection_signal_unsubscribe(broker->connection, broker->subscription_id);
+        }
+        if (broker->registration_id != 0) {
+            g_dbus_connection_unregister_object(broker->connection, broker->registration_id);
+        }
+        g_object_unref(broker->connection);
+    }
+    // Releasing the name promotes the next queued instance
+    g_bus_unown_name(broker->owner_id);
+    g_dbus_node_info_unref(broker->node_info);
+    if (broker->snapshot) {
+        g_bytes_unref(broker->snapshot);
+    }
+    g_free(broker->bus_name);
+    g_free(broker);
+}
+
+ForecastBrokerRole forecast_broker_get_role(const ForecastBroker *broker) {
+    return broker ? broker->role : FORECAST_BROKER_OWNER;
+}
+
+void forecast_broker_publish(ForecastBroker *broker, GBytes *snapshot) {
+    if (!broker || !snapshot || broker->role != FORECAST_BROKER_OWNER) {
+        return;
+    }
+
+    g_bytes_ref(snapshot);
+    if (broker->snapshot) {
+        g_bytes_unref(broker->snapshot);
+    }
+    broker->snapshot = snapshot;
+
+    // The owner may run without a bus connection (see on_name_lost)
+    if (!broker->connection) {
+        return;
+    }
+
+    GError *error = NULL;
+    if (!g_dbus_connection_emit_signal(broker->connection, NULL, FORECAST_BROKER_OBJECT_PATH,
+                                       FORECAST_BROKER_INTERFACE, "SnapshotChanged",
+                                       g_variant_new("(@ay)", snapshot_to_variant(snapshot)), &error)) {
+        g_warning("Shared fetch: failed to publish snapshot: %s", error ? error->message : "Unknown");
+        g_clear_error(&error);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef WEATHERCLOCK_BROKER_H
+#define WEATHERCLOCK_BROKER_H
+
+#include <gio/gio.h>
+
+// Shared-fetch mode: several weatherclock processes on one session bus, all
+// showing the same location, elect a single owner through the D-Bus name queue.
+// The owner fetches as usual and publishes every new forecast (in the
+// forecast_cache_encode() format) to the others, so N instances cost one
+// upstream request per refresh. If the owner exits, the next queued instance
+// is promoted automatically.
+
+#define FORECAST_BROKER_NAME_PREFIX "com.weatherclock.app.Fetcher"
+#define FORECAST_BROKER_OBJECT_PATH "/com/weatherclock/app/Forecast"
+#define FORECAST_BROKER_INTERFACE "com.weatherclock.app.Forecast"
+
+typedef enum {
+    FORECAST_BROKER_PENDING,     // Name request not answered yet - don't fetch
+    FORECAST_BROKER_OWNER,       // This process fetches and publishes
+    FORECAST_BROKER_SUBSCRIBER   // Another process fetches; snapshots arrive over D-Bus
+} ForecastBrokerRole;
+
+typedef struct _ForecastBroker ForecastBroker;
+
+// Called on the main thread whenever the role changes (never with PENDING)
+typedef void (*ForecastBrokerRoleFunc)(ForecastBrokerRole role, gpointer user_data);
+// Called on the main thread for each snapshot received as a subscriber
+typedef void (*ForecastBrokerSnapshotFunc)(GBytes *snapshot, gpointer user_data);
+
+// Instances only share with others using the same location key; it is hashed
+// into the bus name so different locations never contend for one owner.
+ForecastBroker *forecast_broker_new(const gchar *location_key, ForecastBrokerRoleFunc role_func,
+                                    ForecastBrokerSnapshotFunc snapshot_func, gpointer user_data);
+void forecast_broker_free(ForecastBroker *broker);
+
+ForecastBrokerRole forecast_broker_get_role(const ForecastBroker *broker);
+
+// Owner only: remember the snapshot for GetSnapshot and broadcast SnapshotChanged.
+// Ignored in any other role.
+void forecast_broker_publish(ForecastBroker *broker, GBytes *snapshot);
+
+#endif // WEATHERCLOCK_BROKER_H
@@ -14,6 +14,8 @@ SKIP_CLEAN=false
 SKIP_RUN=false
 BUILD_DIR="build"
 DEPLOY=false
+RELEASE=false
+PGO=false
 
 # Parse command line arguments
 while [[ $# -gt 0 ]]; do
@@ -30,6 +32,15 @@ while [[ $# -gt 0 ]]; do
             DEPLOY=true
             shift
             ;;
+        -Release|--release)
+            RELEASE=true
+            shift
+            ;;
+        -Pgo|--pgo)
+            RELEASE=true
+            PGO=true
+            shift
+            ;;
         -h|--help)
             echo "Usage: $0 [OPTIONS]"
             echo ""
@@ -37,6 +48,8 @@ while [[ $# -gt 0 ]]; do
             echo "  -SkipClean, --skip-clean    Skip cleaning build directory"
             echo "  -SkipRun, --skip-run         Build but don't run"
             echo "  -Deploy, --deploy           Create deployment package"
+            echo "  -Release, --release         Production build: -O2, LTO, section GC, CPU tuning"
+            echo "  -Pgo, --pgo                 Release build optimized with a weatherclock-replay profile"
             echo "  -h, --help                  Show this help message"
             exit 0
             ;;
@@ -75,10 +88,6 @@ if ! pkg-config --exists libsoup-3.0; then
     MISSING_DEPS+=("libsoup-3.0-dev")
 fi
 
-if ! pkg-config --exists json-glib-1.0; then
-    MISSING_DEPS+=("json-glib-dev")
-fi
-
 if [ ${#MISSING_DEPS[@]} -ne 0 ]; then
     echo -e "${YELLOW}Missing dependencies:${NC}"
     for dep in "${MISSING_DEPS[@]}"; do
@@ -91,6 +100,9 @@ if [ ${#MISSING_DEPS[@]} -ne 0 ]; then
 fi
 
 echo -e "${GREEN}All dependencies found${NC}"
+if ! pkg-config --exists json-glib-1.0; then
+    echo "json-glib not found: weatherclock-bench will be skipped (install libjson-glib-dev to build it)"
+fi
 echo ""
 
 # Clean build directory
@@ -111,9 +123,18 @@ echo "Creating build directory..."
 mkdir -p "$BUILD_DIR"
 cd "$BUILD_DIR"
 
+# Same settings as the "release" preset in CMakePresets.json
+CMAKE_ARGS=()
+if [ "$RELEASE" = true ]; then
+    CMAKE_ARGS+=(-DCMAKE_BUILD_TYPE=Release -DWEATHERCLOCK_LTO=ON -DWEATHERCLOCK_GC_SECTIONS=ON -DWEATHERCLOCK_TUNE=auto)
+fi
+if [ "$PGO" = true ]; then
+    CMAKE_ARGS+=(-DWEATHERCLOCK_PGO=GENERATE)
+fi
+
 # Configure with CMake
 echo "Configuring with CMake..."
-cmake ..
+cmake "${CMAKE_ARGS[@]}" ..
 if [ $? -ne 0 ]; then
     echo -e "${RED}CMake configuration failed${NC}"
     exit 1
@@ -128,6 +149,15 @@ if [ $? -ne 0 ]; then
     echo -e "${RED}Build failed${NC}"
     exit 1
 fi
+
+# Profile the instrumented build on the replay benchmark, then rebuild with it
+if [ "$PGO" = true ]; then
+    echo "Recording PGO profile..."
+    cmake --build . --target pgo-train
+    cmake -DWEATHERCLOCK_PGO=USE ..
+    echo "Rebuilding with profile..."
+    cmake --build . -j$(nproc)
+fi
 echo -e "${GREEN}Build successful!${NC}"
 echo ""
 
@@ -0,0 +1,281 @@
+#include "clockface.h"
+
+#include <math.h>
+#include <string.h>
+
+#define GLYPH_CHARS "0123456789:"
+#define N_GLYPHS 11
+#define GLYPH_SPACING -4  // Logical pixels between cells, as the .clock-time letter-spacing
+
+struct _ClockFace {
+    GtkWidget parent_instance;
+
+    gchar text[CLOCK_FACE_MAX_CHARS];
+    guint n_chars;
+    gboolean all_glyphs;                     // Every character of text has a glyph texture
+
+    // Cell metrics, valid for metrics_font
+    PangoFontDescription *metrics_font;
+    int digit_width;                         // Widest digit: digits share one cell width
+    int colon_width;
+    int cell_height;
+
+    // Glyph textures, valid for metrics_font at glyph_scale in glyph_colour
+    GdkTexture *glyphs[N_GLYPHS];
+    gdouble glyph_scale;
+    GdkRGBA glyph_colour;
+
+    // One texture node per position, reused while that position shows the same
+    // character. Unchanged nodes let GSK skip repainting their part of the screen.
+    GskRenderNode *cells[CLOCK_FACE_MAX_CHARS];
+    gchar cell_chars[CLOCK_FACE_MAX_CHARS];
+};
+
+G_DEFINE_TYPE(ClockFace, clock_face, GTK_TYPE_WIDGET)
+
+static int glyph_index(gchar c) {
+    const gchar *p = c != '\0' ? strchr(GLYPH_CHARS, c) : NULL;
+    return p ? (int)(p - GLYPH_CHARS) : -1;
+}
+
+static int cell_width(ClockFace *self, gchar c) {
+    return c == ':' ? self->colon_width : self->digit_width;
+}
+
+static void clear_cells(ClockFace *self) {
+    for (guint i = 0; i < CLOCK_FACE_MAX_CHARS; i++) {
+        g_clear_pointer(&self->cells[i], gsk_render_node_unref);
+        self->cell_chars[i] = '\0';
+    }
+}
+
+static void clear_glyphs(ClockFace *self) {
+    for (guint i = 0; i < N_GLYPHS; i++) {
+        g_clear_object(&self->glyphs[i]);
+    }
+    clear_cells(self);
+}
+
+static PangoLayout *create_layout(ClockFace *self, const gchar *text) {
+    PangoLayout *layout = gtk_widget_create_pango_layout(GTK_WIDGET(self), text);
+    pango_layout_set_font_description(layout, self->metrics_font);
+    return layout;
+}
+
+// Re-measure the cells when the CSS font changed (cheap compare otherwise)
+static void ensure_metrics(ClockFace *self) {
+    const PangoFontDescription *font = pango_context_get_font_description(gtk_widget_get_pango_context(GTK_WIDGET(self)));
+    if (self->metrics_font && pango_font_description_equal(self->metrics_font, font)) {
+        return;
+    }
+
+    g_clear_pointer(&self->metrics_font, pango_font_description_free);
+    self->metrics_font = pango_font_description_copy(font);
+    clear_glyphs(self);
+
+    PangoLayout *layout = create_layout(self, "");
+    self->digit_width = 0;
+    self->cell_height = 0;
+    for (guint i = 0; i < N_GLYPHS; i++) {
+        int width, height;
+        pango_layout_set_text(layout, GLYPH_CHARS + i, 1);
+        pango_layout_get_pixel_size(layout, &width, &height);
+        if (GLYPH_CHARS[i] == ':') {
+            self->colon_width = width;
+        } else {
+            self->digit_width = MAX(self->digit_width, width);
+        }
+        self->cell_height = MAX(self->cell_height, height);
+    }
+    g_object_unref(layout);
+}
+
+// Device pixels per logical pixel, fractional where GTK supports it
+static gdouble get_scale(ClockFace *self) {
+#if GTK_CHECK_VERSION(4, 12, 0)
+    GtkNative *native = gtk_widget_get_native(GTK_WIDGET(self));
+    GdkSurface *surface = native ? gtk_native_get_surface(native) : NULL;
+    if (surface) {
+        return gdk_surface_get_scale(surface);
+    }
+#endif
+    return gtk_widget_get_scale_factor(GTK_WIDGET(self));
+}
+
+static void get_colour(ClockFace *self, GdkRGBA *colour) {
+#if GTK_CHECK_VERSION(4, 10, 0)
+    gtk_widget_get_color(GTK_WIDGET(self), colour);
+#else
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+    gtk_style_context_get_color(gtk_widget_get_style_context(GTK_WIDGET(self)), colour);
+    G_GNUC_END_IGNORE_DEPRECATIONS
+#endif
+}
+
+// Rasterize all glyphs for the current font, colour and scale. FALSE if there
+// is no renderer yet; the caller then draws plain text.
+static gboolean ensure_glyphs(ClockFace *self) {
+    gdouble scale = get_scale(self);
+    GdkRGBA colour;
+    get_colour(self, &colour);
+    if (scale != self->glyph_scale || !gdk_rgba_equal(&colour, &self->glyph_colour)) {
+        clear_glyphs(self);
+        self->glyph_scale = scale;
+        self->glyph_colour = colour;
+    }
+    if (self->glyphs[0]) {
+        return TRUE;
+    }
+
+    GtkNative *native = gtk_widget_get_native(GTK_WIDGET(self));
+    GskRenderer *renderer = native ? gtk_native_get_renderer(native) : NULL;
+    if (!renderer) {
+        return FALSE;
+    }
+
+    PangoLayout *layout = create_layout(self, "");
+    for (guint i = 0; i < N_GLYPHS; i++) {
+        int cell = cell_width(self, GLYPH_CHARS[i]);
+        int width;
+        pango_layout_set_text(layout, GLYPH_CHARS + i, 1);
+        pango_layout_get_pixel_size(layout, &width, NULL);
+
+        // Centred in its cell, so narrower digits (often '1') don't shift the rest
+        GtkSnapshot *snapshot = gtk_snapshot_new();
+        gtk_snapshot_scale(snapshot, (float)scale, (float)scale);
+        gtk_snapshot_translate(snapshot, &GRAPHENE_POINT_INIT((cell - width) / 2.0f, 0));
+        gtk_snapshot_append_layout(snapshot, layout, &colour);
+        GskRenderNode *node = gtk_snapshot_free_to_node(snapshot);
+        if (node) {
+            graphene_rect_t viewport = GRAPHENE_RECT_INIT(0, 0, ceilf((float)(cell * scale)),
+                                                          ceilf((float)(self->cell_height * scale)));
+            self->glyphs[i] = gsk_renderer_render_texture(renderer, node, &viewport);
+            gsk_render_node_unref(node);
+        }
+        if (!self->glyphs[i]) {
+            g_object_unref(layout);
+            clear_glyphs(self);
+            return FALSE;
+        }
+    }
+    g_object_unref(layout);
+    return TRUE;
+}
+
+static void clock_face_snapshot(GtkWidget *widget, GtkSnapshot *snapshot) {
+    ClockFace *self = CLOCK_FACE(widget);
+
+    ensure_metrics(self);
+    if (!self->all_glyphs || !ensure_glyphs(self)) {
+        PangoLayout *layout = create_layout(self, self->text);
+        GdkRGBA colour;
+        get_colour(self, &colour);
+        gtk_snapshot_append_layout(snapshot, layout, &colour);
+        g_object_unref(layout);
+        return;
+    }
+
+    int x = 0;
+    for (guint i = 0; i < self->n_chars; i++) {
+        gchar c = self->text[i];
+        int width = cell_width(self, c);
+        if (!self->cells[i] || self->cell_chars[i] != c) {
+            g_clear_pointer(&self->cells[i], gsk_render_node_unref);
+            self->cells[i] = gsk_texture_node_new(self->glyphs[glyph_index(c)],
+                                                  &GRAPHENE_RECT_INIT(x, 0, width, self->cell_height));
+            self->cell_chars[i] = c;
+        }
+        gtk_snapshot_append_node(snapshot, self->cells[i]);
+        x += width + GLYPH_SPACING;
+    }
+}
+
+static void clock_face_measure(GtkWidget *widget, GtkOrientation orientation, int for_size,
+                               int *minimum, int *natural, int *minimum_baseline, int *natural_baseline) {
+    (void)for_size;
+    ClockFace *self = CLOCK_FACE(widget);
+
+    ensure_metrics(self);
+    if (orientation == GTK_ORIENTATION_VERTICAL) {
+        *minimum = *natural = self->cell_height;
+    } else if (self->all_glyphs) {
+        int width = 0;
+        for (guint i = 0; i < self->n_chars; i++) {
+            width += cell_width(self, self->text[i]) + (i > 0 ? GLYPH_SPACING : 0);
+        }
+        *minimum = *natural = MAX(width, 0);
+    } else {
+        PangoLayout *layout = create_layout(self, self->text);
+        pango_layout_get_pixel_size(layout, natural, NULL);
+        *minimum = *natural;
+        g_object_unref(layout);
+    }
+    *minimum_baseline = *natural_baseline = -1;
+}
+
+static void clock_face_unrealize(GtkWidget *widget) {
+    // Textures from this surface's renderer don't outlive it
+    clear_glyphs(CLOCK_FACE(widget));
+    GTK_WIDGET_CLASS(clock_face_parent_class)->unrealize(widget);
+}
+
+static void clock_face_finalize(GObject *object) {
+    ClockFace *self = CLOCK_FACE(object);
+
+    clear_glyphs(self);
+    g_clear_pointer(&self->metrics_font, pango_font_description_free);
+
+    G_OBJECT_CLASS(clock_face_parent_class)->finalize(object);
+}
+
+static void clock_face_class_init(ClockFaceClass *klass) {
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    GtkWidgetClass *widget_class = GTK_WIDGET_CLASS(klass);
+
+    object_class->finalize = clock_face_finalize;
+    widget_class->snapshot = clock_face_snapshot;
+    widget_class->measure = clock_face_measure;
+    widget_class->unrealize = clock_face_unrealize;
+    gtk_widget_class_set_css_name(widget_class, "clockface");
+}
+
+static void clock_face_init(ClockFace *self) {
+    (void)self;
+}
+
+GtkWidget *clock_face_new(const gchar *text) {
+    ClockFace *self = g_object_new(CLOCK_TYPE_FACE, NULL);
+    clock_face_set_text(self, text);
+    return GTK_WIDGET(self);
+}
+
+void clock_face_set_text(ClockFace *self, const gchar *text) {
+    g_return_if_fail(CLOCK_IS_FACE(self));
+
+    gchar buffer[CLOCK_FACE_MAX_CHARS];
+    g_strlcpy(buffer, text ? text : "", sizeof(buffer));
+    if (strcmp(buffer, self->text) == 0) {
+        return;
+    }
+
+    guint n_chars = (guint)strlen(buffer);
+    gboolean all_glyphs = TRUE;
+    for (guint i = 0; i < n_chars; i++) {
+        all_glyphs = all_glyphs && glyph_index(buffer[i]) >= 0;
+    }
+
+    // Same length with the colons in place (the usual tick) keeps the size
+    gboolean resize = n_chars != self->n_chars || all_glyphs != self->all_glyphs || !all_glyphs;
+    for (guint i = 0; i < n_chars && !resize; i++) {
+        resize = (buffer[i] == ':') != (self->text[i] == ':');
+    }
+
+    memcpy(self->text, buffer, sizeof(self->text));
+    self->n_chars = n_chars;
+    self->all_glyphs = all_glyphs;
+    if (resize) {
+        clear_cells(self);  // Positions moved
+        gtk_widget_queue_resize(GTK_WIDGET(self));
+    }
+    gtk_widget_queue_draw(GTK_WIDGET(self));
+}
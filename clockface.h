@@ -0,0 +1,23 @@
+#ifndef WEATHERCLOCK_CLOCKFACE_H
+#define WEATHERCLOCK_CLOCKFACE_H
+
+#include <gtk/gtk.h>
+
+// The big clock text drawn from pre-rendered glyphs. The ten digits and the
+// colon are rasterized into textures once per font, colour and display scale;
+// a tick then only swaps the texture of the characters that changed, so the
+// per-second cost doesn't grow with the font size or the resolution. Takes its
+// font and colour from CSS like a label would (e.g. the .clock-time class).
+
+#define CLOCK_TYPE_FACE (clock_face_get_type())
+G_DECLARE_FINAL_TYPE(ClockFace, clock_face, CLOCK, FACE, GtkWidget)
+
+#define CLOCK_FACE_MAX_CHARS 16
+
+GtkWidget *clock_face_new(const gchar *text);
+
+// Anything other than digits and ':' is still shown, just drawn as plain text.
+// Text longer than CLOCK_FACE_MAX_CHARS - 1 is truncated.
+void clock_face_set_text(ClockFace *self, const gchar *text);
+
+#endif // WEATHERCLOCK_CLOCKFACE_H
@@ -0,0 +1,853 @@
+#include "forecast.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "jsonscan.h"
+
+#define ROOT_KEYS_MAX 256  // Enough for every top-level key Open-Meteo sends
+#define CACHE_MAGIC 0x46435857u  // "WXCF" when read little-endian
+
+// On-disk header of forecast_cache_encode(). Field order keeps every member
+// naturally aligned so the struct has no padding on any supported ABI.
+typedef struct {
+    guint32 magic;
+    guint16 version;
+    guint16 header_size;
+    guint32 n_hours;
+    gint32 utc_offset_seconds;
+    gint64 fetched_at;
+    guint32 flags;
+    guint32 reserved;
+    gchar timezone[FORECAST_TIMEZONE_MAX];
+    gchar location[FORECAST_CACHE_LOCATION_MAX];
+} CacheHeader;
+
+#define CACHE_FLAG_HAS_UTC_OFFSET (1u << 0)
+
+G_STATIC_ASSERT(sizeof(CacheHeader) == 144);
+
+typedef enum {
+    ERROR_VALUE_NONE,
+    ERROR_VALUE_BOOLEAN,
+    ERROR_VALUE_STRING,
+    ERROR_VALUE_OTHER
+} ErrorValueKind;
+
+// Everything we learn about the root object during the single pass.
+// Strings point into the input buffer; nothing here is heap allocated.
+typedef struct {
+    WeatherForecast *forecast;
+    gchar keys[ROOT_KEYS_MAX];
+    gsize keys_len;
+    ErrorValueKind error_kind;
+    gboolean error_bool;
+    const gchar *error_type_name;
+    const gchar *error_str;
+    gsize error_str_len;
+    const gchar *reason;
+    gsize reason_len;
+    gboolean has_reason;
+    gboolean has_hourly;
+    gboolean hourly_is_object;
+    gboolean has_time;
+    gboolean has_temp;
+    gboolean has_code;
+    gboolean has_precip;
+    guint n_time;
+    guint n_temp;
+    guint n_code;
+    guint n_precip;
+} ParseContext;
+
+typedef enum {
+    COLUMN_TEMP,
+    COLUMN_CODE,
+    COLUMN_PRECIP
+} NumberColumn;
+
+WeatherForecast *forecast_new(void) {
+    return g_new0(WeatherForecast, 1);
+}
+
+void forecast_free(WeatherForecast *forecast) {
+    if (!forecast) {
+        return;
+    }
+    g_free(forecast->slab);
+    g_free(forecast);
+}
+
+void forecast_clear(WeatherForecast *forecast) {
+    if (!forecast) {
+        return;
+    }
+    forecast->n_hours = 0;
+    forecast->utc_offset_seconds = 0;
+    forecast->has_utc_offset = FALSE;
+    forecast->timezone[0] = '\0';
+}
+
+static void forecast_reserve(WeatherForecast *forecast, guint n) {
+    if (n <= forecast->capacity) {
+        return;
+    }
+    guint capacity = forecast->capacity ? forecast->capacity : 64;  // 2 days fit without growing
+    while (capacity < n) {
+        capacity *= 2;
+    }
+
+    // All columns in one block, widest first so each stays aligned (capacity is
+    // a multiple of 8). The parser grows the columns as it fills them, so the
+    // old entries move over.
+    guint8 *slab = g_malloc((gsize)capacity * FORECAST_HOUR_BYTES);
+    gint64 *times = (gint64 *)slab;
+    gint32 *hours = (gint32 *)(times + capacity);
+    gfloat *temps = (gfloat *)(hours + capacity);
+    gfloat *precip = temps + capacity;
+    guint8 *codes = (guint8 *)(precip + capacity);
+    if (forecast->capacity > 0) {
+        guint old = forecast->capacity;
+        memcpy(times, forecast->times, old * sizeof(*times));
+        memcpy(hours, forecast->hours, old * sizeof(*hours));
+        memcpy(temps, forecast->temps, old * sizeof(*temps));
+        memcpy(precip, forecast->precip, old * sizeof(*precip));
+        memcpy(codes, forecast->codes, old * sizeof(*codes));
+    }
+    g_free(forecast->slab);
+    forecast->slab = slab;
+    forecast->times = times;
+    forecast->hours = hours;
+    forecast->temps = temps;
+    forecast->precip = precip;
+    forecast->codes = codes;
+    forecast->capacity = capacity;
+}
+
+gint32 forecast_hours_from_civil(gint year, gint month, gint day, gint hour) {
+    // Days since 1970-01-01 in the proleptic Gregorian calendar (H. Hinnant's algorithm)
+    year -= month <= 2;
+    gint era = (year >= 0 ? year : year - 399) / 400;
+    gint yoe = year - era * 400;
+    gint doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    gint doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    gint64 days = (gint64)era * 146097 + doe - 719468;
+    return (gint32)(days * 24 + hour);
+}
+
+void forecast_civil_from_days(gint32 days, gint *year, gint *month, gint *day) {
+    // Inverse of the above (same algorithm)
+    gint64 z = (gint64)days + 719468;
+    gint64 era = (z >= 0 ? z : z - 146096) / 146097;
+    gint doe = (gint)(z - era * 146097);
+    gint yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    gint doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    gint mp = (5 * doy + 2) / 153;
+    gint m = mp < 10 ? mp + 3 : mp - 9;
+    if (year) {
+        *year = (gint)(yoe + era * 400) + (m <= 2);
+    }
+    if (month) {
+        *month = m;
+    }
+    if (day) {
+        *day = doy - (153 * mp + 2) / 5 + 1;
+    }
+}
+
+static inline gboolean is_digits(const gchar *p, gsize n) {
+    for (gsize i = 0; i < n; i++) {
+        if (!g_ascii_isdigit(p[i])) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static inline gint digits_value(const gchar *p, gsize n) {
+    gint value = 0;
+    for (gsize i = 0; i < n; i++) {
+        value = value * 10 + (p[i] - '0');
+    }
+    return value;
+}
+
+// "YYYY-MM-DDTHH:MM" -> packed hours, or FORECAST_HOUR_INVALID
+static gint32 parse_iso_hour(const gchar *str, gsize len) {
+    if (len < 13 || !is_digits(str, 4) || str[4] != '-' || !is_digits(str + 5, 2) ||
+        str[7] != '-' || !is_digits(str + 8, 2) || str[10] != 'T' || !is_digits(str + 11, 2)) {
+        return FORECAST_HOUR_INVALID;
+    }
+    return forecast_hours_from_civil(digits_value(str, 4), digits_value(str + 5, 2),
+                                     digits_value(str + 8, 2), digits_value(str + 11, 2));
+}
+
+static void append_root_key(ParseContext *ctx, const gchar *key, gsize key_len) {
+    gsize needed = key_len + (ctx->keys_len > 0 ? 2 : 0);
+    if (ctx->keys_len + needed + 1 > sizeof(ctx->keys)) {
+        return;  // Key list is diagnostics only; drop what doesn't fit
+    }
+    if (ctx->keys_len > 0) {
+        ctx->keys[ctx->keys_len++] = ',';
+        ctx->keys[ctx->keys_len++] = ' ';
+    }
+    memcpy(ctx->keys + ctx->keys_len, key, key_len);
+    ctx->keys_len += key_len;
+    ctx->keys[ctx->keys_len] = '\0';
+}
+
+static gboolean parse_time_column(JsonScanner *s, ParseContext *ctx) {
+    WeatherForecast *forecast = ctx->forecast;
+    guint n = 0;
+
+    if (!json_scan_expect(s, '[')) {
+        return FALSE;
+    }
+    while (json_scan_array_next(s, n)) {
+        forecast_reserve(forecast, n + 1);
+        if (*s->p == '"') {
+            const gchar *str;
+            gsize len;
+            if (!json_scan_string(s, &str, &len)) {
+                return FALSE;
+            }
+            forecast->hours[n] = parse_iso_hour(str, len);
+        } else {
+            if (!json_scan_skip_value(s)) {
+                return FALSE;
+            }
+            forecast->hours[n] = FORECAST_HOUR_INVALID;
+        }
+        n++;
+    }
+    ctx->n_time = n;
+    return s->error == NULL;
+}
+
+static gboolean parse_number_column(JsonScanner *s, ParseContext *ctx, NumberColumn column) {
+    WeatherForecast *forecast = ctx->forecast;
+    guint n = 0;
+
+    if (!json_scan_expect(s, '[')) {
+        return FALSE;
+    }
+    while (json_scan_array_next(s, n)) {
+        forecast_reserve(forecast, n + 1);
+        gdouble value = NAN;
+        if (*s->p == '-' || g_ascii_isdigit(*s->p)) {
+            if (!json_scan_number(s, &value, NULL)) {
+                return FALSE;
+            }
+        } else if (!json_scan_skip_value(s)) {
+            return FALSE;
+        }
+        if (column == COLUMN_TEMP) {
+            forecast->temps[n] = (gfloat)value;
+        } else if (column == COLUMN_PRECIP) {
+            forecast->precip[n] = (gfloat)value;
+        } else {
+            forecast->codes[n] = (isnan(value) || value < 0) ? 0 : (value > 255 ? 255 : (guint8)value);
+        }
+        n++;
+    }
+    if (column == COLUMN_TEMP) {
+        ctx->n_temp = n;
+    } else if (column == COLUMN_PRECIP) {
+        ctx->n_precip = n;
+    } else {
+        ctx->n_code = n;
+    }
+    return s->error == NULL;
+}
+
+static gboolean parse_hourly_member(JsonScanner *s, const gchar *key, gsize key_len, gpointer user_data) {
+    ParseContext *ctx = (ParseContext *)user_data;
+    // Non-array columns are treated as missing, like json_object_get_array_member()
+    gboolean is_array = (s->p < s->end && *s->p == '[');
+
+    if (json_key_equals(key, key_len, "time") && is_array) {
+        ctx->has_time = TRUE;
+        return parse_time_column(s, ctx);
+    }
+    if (json_key_equals(key, key_len, "temperature_2m") && is_array) {
+        ctx->has_temp = TRUE;
+        return parse_number_column(s, ctx, COLUMN_TEMP);
+    }
+    if (json_key_equals(key, key_len, "weathercode") && is_array) {
+        ctx->has_code = TRUE;
+        return parse_number_column(s, ctx, COLUMN_CODE);
+    }
+    if (json_key_equals(key, key_len, "precipitation") && is_array) {
+        ctx->has_precip = TRUE;
+        return parse_number_column(s, ctx, COLUMN_PRECIP);
+    }
+    return json_scan_skip_value(s);
+}
+
+static gboolean parse_root_member(JsonScanner *s, const gchar *key, gsize key_len, gpointer user_data) {
+    ParseContext *ctx = (ParseContext *)user_data;
+    WeatherForecast *forecast = ctx->forecast;
+    gchar c = s->p < s->end ? *s->p : '\0';
+
+    append_root_key(ctx, key, key_len);
+
+    if (json_key_equals(key, key_len, "timezone") && c == '"') {
+        const gchar *str;
+        gsize len;
+        if (!json_scan_string(s, &str, &len)) {
+            return FALSE;
+        }
+        json_decode_string(str, len, forecast->timezone, sizeof(forecast->timezone));
+        return TRUE;
+    }
+    if (json_key_equals(key, key_len, "utc_offset_seconds") && (c == '-' || g_ascii_isdigit(c))) {
+        gdouble offset;
+        if (!json_scan_number(s, &offset, NULL)) {
+            return FALSE;
+        }
+        forecast->utc_offset_seconds = (gint)offset;
+        forecast->has_utc_offset = TRUE;
+        return TRUE;
+    }
+    if (json_key_equals(key, key_len, "error")) {
+        if (c == 't' || c == 'f') {
+            ctx->error_kind = ERROR_VALUE_BOOLEAN;
+            ctx->error_bool = (c == 't');
+            return json_scan_literal(s, c == 't' ? "true" : "false");
+        }
+        if (c == '"') {
+            ctx->error_kind = ERROR_VALUE_STRING;
+            return json_scan_string(s, &ctx->error_str, &ctx->error_str_len);
+        }
+        ctx->error_kind = ERROR_VALUE_OTHER;
+        if (c == '-' || g_ascii_isdigit(c)) {
+            gboolean is_integer = TRUE;
+            if (!json_scan_number(s, NULL, &is_integer)) {
+                return FALSE;
+            }
+            ctx->error_type_name = is_integer ? "gint64" : "gdouble";
+            return TRUE;
+        }
+        ctx->error_type_name = c == '{' ? "JsonObject" : c == '[' ? "JsonArray" : "null";
+        return json_scan_skip_value(s);
+    }
+    if (json_key_equals(key, key_len, "reason")) {
+        ctx->has_reason = TRUE;
+        if (c == '"') {
+            return json_scan_string(s, &ctx->reason, &ctx->reason_len);
+        }
+        return json_scan_skip_value(s);
+    }
+    if (json_key_equals(key, key_len, "hourly")) {
+        ctx->has_hourly = TRUE;
+        if (c == '{') {
+            ctx->hourly_is_object = TRUE;
+            return json_scan_object(s, parse_hourly_member, ctx);
+        }
+        return json_scan_skip_value(s);
+    }
+    return json_scan_skip_value(s);
+}
+
+static ForecastParseResult report_api_error(ParseContext *ctx, gchar *error_msg, gsize error_msg_len) {
+    gchar decoded[FORECAST_ERROR_MAX];
+    const gchar *message = NULL;
+
+    if (ctx->error_kind == ERROR_VALUE_BOOLEAN) {
+        if (!ctx->error_bool) {
+            message = "API returned error=false (should not happen)";
+        } else if (!ctx->has_reason) {
+            message = "API returned error=true but no reason field";
+        } else if (ctx->reason) {
+            json_decode_string(ctx->reason, ctx->reason_len, decoded, sizeof(decoded));
+            message = decoded;
+        }
+    } else if (ctx->error_kind == ERROR_VALUE_STRING) {
+        json_decode_string(ctx->error_str, ctx->error_str_len, decoded, sizeof(decoded));
+        message = decoded;
+    }
+
+    if (message) {
+        snprintf(error_msg, error_msg_len, "API Error: %s (Keys: %s)", message, ctx->keys);
+    } else if (ctx->error_kind == ERROR_VALUE_OTHER) {
+        snprintf(error_msg, error_msg_len, "API Error: Error type: %s (Keys: %s)",
+                 ctx->error_type_name, ctx->keys);
+    } else {
+        snprintf(error_msg, error_msg_len, "API Error: Unknown (Keys: %s)", ctx->keys);
+    }
+    return FORECAST_PARSE_API_ERROR;
+}
+
+// Fill the times column from the wall-clock hours. The location's own zone is
+// used when the tz database has it, so hours on the far side of a DST change
+// land correctly; otherwise (e.g. on Windows) the response's fixed UTC offset.
+static void resolve_times(WeatherForecast *forecast) {
+    GTimeZone *tz = forecast->timezone[0] != '\0' ? g_time_zone_new_identifier(forecast->timezone) : NULL;
+    gint64 previous = G_MININT64;
+    for (guint i = 0; i < forecast->n_hours; i++) {
+        if (forecast->hours[i] == FORECAST_HOUR_INVALID) {
+            forecast->times[i] = previous;
+            continue;
+        }
+        gint64 time = (gint64)forecast->hours[i] * 3600;
+        if (tz) {
+            // Daylight time for an ambiguous hour: that's its first occurrence
+            gint64 local = time;
+            gint interval = g_time_zone_adjust_time(tz, G_TIME_TYPE_DAYLIGHT, &local);
+            time = local - g_time_zone_get_offset(tz, interval);
+        } else {
+            time -= forecast->utc_offset_seconds;
+        }
+        if (time <= previous) {
+            time = previous + 3600;  // The repeated hour when clocks go back
+        }
+        forecast->times[i] = previous = time;
+    }
+    if (tz) {
+        g_time_zone_unref(tz);
+    }
+}
+
+guint forecast_find_hour(const WeatherForecast *forecast, gint64 now) {
+    g_return_val_if_fail(forecast != NULL, 0);
+
+    // First index whose hour ends after now, i.e. times[i] > now - 1 h
+    gint64 threshold = now - 3600;
+    guint lo = 0;
+    guint hi = forecast->n_hours;
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        if (forecast->times[mid] > threshold) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+// Parse one location object starting at s->p. For a single-location response the
+// object is the whole document, so anything after it is an error.
+static ForecastParseResult parse_location(JsonScanner *s, const gchar *json, WeatherForecast *forecast,
+                                          gboolean is_document, gchar *error_msg, gsize error_msg_len) {
+    ParseContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.forecast = forecast;
+
+    forecast_clear(forecast);
+    if (json_scan_object(s, parse_root_member, &ctx) && is_document) {
+        json_scan_skip_ws(s);
+        if (s->p != s->end) {
+            json_scan_fail(s, "trailing data");
+        }
+    }
+    if (s->error) {
+        g_warning("JSON parse error: %s at offset %" G_GSIZE_FORMAT, s->error, (gsize)(s->p - json));
+        snprintf(error_msg, error_msg_len, "Parse error: %s at offset %" G_GSIZE_FORMAT " - retrying...",
+                 s->error, (gsize)(s->p - json));
+        forecast_clear(forecast);
+        return FORECAST_PARSE_RETRY;
+    }
+
+    // Check for API errors first - Open-Meteo returns "error" as boolean or "reason" as string
+    if (ctx.error_kind != ERROR_VALUE_NONE) {
+        return report_api_error(&ctx, error_msg, error_msg_len);
+    }
+
+    if (!ctx.has_hourly) {
+        g_warning("No 'hourly' key found. Available keys: %s", ctx.keys);
+        snprintf(error_msg, error_msg_len, "No hourly data - retrying... Keys: %s", ctx.keys);
+        return FORECAST_PARSE_RETRY;  // Server may have returned partial data
+    }
+    if (!ctx.hourly_is_object) {
+        snprintf(error_msg, error_msg_len, "No hourly data available - retrying...");
+        return FORECAST_PARSE_RETRY;
+    }
+    if (!ctx.has_time || !ctx.has_temp || !ctx.has_code) {
+        snprintf(error_msg, error_msg_len, "Incomplete weather data - retrying...");
+        return FORECAST_PARSE_RETRY;
+    }
+
+    forecast->n_hours = MIN(ctx.n_time, MIN(ctx.n_temp, ctx.n_code));
+    // Precipitation is optional (only the extended view asks for it)
+    for (guint i = ctx.has_precip ? ctx.n_precip : 0; i < forecast->n_hours; i++) {
+        forecast->precip[i] = NAN;
+    }
+    resolve_times(forecast);
+    return FORECAST_PARSE_OK;
+}
+
+// Shared front end of forecast_parse()/forecast_parse_batch(). With max_forecasts > 1
+// a root array is accepted and split into one forecast per element.
+static ForecastParseResult parse_response(WeatherForecast **forecasts, guint max_forecasts, const gchar *json,
+                                          gsize length, guint *n_parsed, gchar *error_msg, gsize error_msg_len) {
+    *n_parsed = 0;
+    error_msg[0] = '\0';
+    for (guint i = 0; i < max_forecasts; i++) {
+        forecast_clear(forecasts[i]);
+    }
+
+    if (!json || length == 0) {
+        snprintf(error_msg, error_msg_len, "Empty weather data received");
+        return FORECAST_PARSE_RETRY;
+    }
+
+    JsonScanner scanner = { json, json + length, NULL };
+    JsonScanner *s = &scanner;
+    json_scan_skip_ws(s);
+
+    // Check if response looks like HTML (API returned error page instead of JSON)
+    if (s->p < s->end && *s->p == '<') {
+        g_warning("API returned HTML instead of JSON (likely server error)");
+        snprintf(error_msg, error_msg_len, "Server returned error page - retrying...");
+        return FORECAST_PARSE_RETRY;
+    }
+    if (s->p >= s->end) {
+        snprintf(error_msg, error_msg_len, "Empty weather data received");
+        return FORECAST_PARSE_RETRY;
+    }
+
+    if (*s->p == '{') {
+        // Single location (or an API error object for the whole batch)
+        ForecastParseResult result = parse_location(s, json, forecasts[0], TRUE, error_msg, error_msg_len);
+        if (result == FORECAST_PARSE_OK) {
+            *n_parsed = 1;
+        }
+        return result;
+    }
+
+    if (*s->p == '[' && max_forecasts > 1) {
+        // Multi-location response: one object per requested coordinate, in request order
+        s->p++;
+        guint n = 0;
+        while (json_scan_array_next(s, n)) {
+            if (n >= max_forecasts) {
+                // Surplus elements only matter for the count check below
+                if (!json_scan_skip_value(s)) {
+                    break;
+                }
+                n++;
+                continue;
+            }
+            if (*s->p != '{') {
+                snprintf(error_msg, error_msg_len, "Invalid weather data format - retrying...");
+                return FORECAST_PARSE_RETRY;
+            }
+            ForecastParseResult result = parse_location(s, json, forecasts[n], FALSE, error_msg, error_msg_len);
+            if (result != FORECAST_PARSE_OK) {
+                // One bad location fails the batch; which one is useful for the log
+                g_debug("Location %u of batch failed: %s", n, error_msg);
+                return result;
+            }
+            n++;
+        }
+        if (!s->error) {
+            json_scan_skip_ws(s);
+            if (s->p != s->end) {
+                json_scan_fail(s, "trailing data");
+            }
+        }
+        if (s->error) {
+            g_warning("JSON parse error: %s at offset %" G_GSIZE_FORMAT, s->error, (gsize)(s->p - json));
+            snprintf(error_msg, error_msg_len, "Parse error: %s at offset %" G_GSIZE_FORMAT " - retrying...",
+                     s->error, (gsize)(s->p - json));
+            return FORECAST_PARSE_RETRY;
+        }
+        if (n != max_forecasts) {
+            g_warning("Batch response has %u locations, expected %u", n, max_forecasts);
+            snprintf(error_msg, error_msg_len, "Incomplete weather data - retrying...");
+            return FORECAST_PARSE_RETRY;
+        }
+        *n_parsed = n;
+        return FORECAST_PARSE_OK;
+    }
+
+    // Still has to be valid JSON to get the "format" message rather than a parse error
+    if (json_scan_skip_value(s)) {
+        json_scan_skip_ws(s);
+    }
+    if (!s->error && s->p == s->end) {
+        snprintf(error_msg, error_msg_len, "Invalid weather data format - retrying...");
+    } else {
+        snprintf(error_msg, error_msg_len, "Parse error: %s at offset %" G_GSIZE_FORMAT " - retrying...",
+                 s->error ? s->error : "trailing data", (gsize)(s->p - json));
+    }
+    return FORECAST_PARSE_RETRY;
+}
+
+ForecastParseResult forecast_parse(WeatherForecast *forecast, const gchar *json, gsize length,
+                                   gchar *error_msg, gsize error_msg_len) {
+    g_return_val_if_fail(forecast != NULL, FORECAST_PARSE_RETRY);
+    g_return_val_if_fail(error_msg != NULL && error_msg_len > 0, FORECAST_PARSE_RETRY);
+
+    guint n_parsed;
+    return parse_response(&forecast, 1, json, length, &n_parsed, error_msg, error_msg_len);
+}
+
+ForecastParseResult forecast_parse_batch(WeatherForecast **forecasts, guint n_forecasts, const gchar *json,
+                                         gsize length, gchar *error_msg, gsize error_msg_len) {
+    g_return_val_if_fail(forecasts != NULL && n_forecasts > 0, FORECAST_PARSE_RETRY);
+    g_return_val_if_fail(error_msg != NULL && error_msg_len > 0, FORECAST_PARSE_RETRY);
+
+    guint n_parsed = 0;
+    ForecastParseResult result = parse_response(forecasts, n_forecasts, json, length, &n_parsed,
+                                                error_msg, error_msg_len);
+    if (result == FORECAST_PARSE_OK && n_parsed != n_forecasts) {
+        // A lone object answers a one-location request only
+        g_warning("Batch response has %u locations, expected %u", n_parsed, n_forecasts);
+        snprintf(error_msg, error_msg_len, "Incomplete weather data - retrying...");
+        return FORECAST_PARSE_RETRY;
+    }
+    return result;
+}
+
+// The codes column is padded so snapshot sizes stay a multiple of 4 bytes
+static inline gsize cache_codes_size(guint n) {
+    return ((gsize)n + 3) & ~(gsize)3;
+}
+
+static inline gsize cache_size(guint n) {
+    return sizeof(CacheHeader) + (gsize)n * sizeof(gint32) + 2 * (gsize)n * sizeof(gfloat) + cache_codes_size(n);
+}
+
+GBytes *forecast_cache_encode(const WeatherForecast *forecast, const gchar *location, gint64 fetched_at) {
+    g_return_val_if_fail(forecast != NULL, NULL);
+
+    guint n = forecast->n_hours;
+    gsize size = cache_size(n);
+    guint8 *buffer = g_malloc0(size);
+
+    CacheHeader *header = (CacheHeader *)buffer;
+    header->magic = CACHE_MAGIC;
+    header->version = FORECAST_CACHE_VERSION;
+    header->header_size = sizeof(CacheHeader);
+    header->n_hours = n;
+    header->utc_offset_seconds = forecast->utc_offset_seconds;
+    header->fetched_at = fetched_at;
+    header->flags = forecast->has_utc_offset ? CACHE_FLAG_HAS_UTC_OFFSET : 0;
+    g_strlcpy(header->timezone, forecast->timezone, sizeof(header->timezone));
+    if (location) {
+        g_strlcpy(header->location, location, sizeof(header->location));
+    }
+
+    guint8 *p = buffer + sizeof(CacheHeader);
+    if (n > 0) {
+        memcpy(p, forecast->hours, n * sizeof(gint32));
+        p += n * sizeof(gint32);
+        memcpy(p, forecast->temps, n * sizeof(gfloat));
+        p += n * sizeof(gfloat);
+        memcpy(p, forecast->precip, n * sizeof(gfloat));
+        p += n * sizeof(gfloat);
+        memcpy(p, forecast->codes, n);
+    }
+
+    return g_bytes_new_take(buffer, size);
+}
+
+gboolean forecast_cache_decode(WeatherForecast *forecast, const guint8 *data, gsize length,
+                               gchar *location, gsize location_len, gint64 *fetched_at,
+                               gsize *record_length) {
+    g_return_val_if_fail(forecast != NULL, FALSE);
+
+    forecast_clear(forecast);
+    if (!data || length < sizeof(CacheHeader)) {
+        return FALSE;
+    }
+
+    // The header is copied out rather than cast in place: mapped files are page
+    // aligned, but callers may hand us any buffer (e.g. a D-Bus byte array)
+    CacheHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != CACHE_MAGIC || header.version != FORECAST_CACHE_VERSION ||
+        header.header_size != sizeof(CacheHeader)) {
+        return FALSE;
+    }
+    // Reject counts that could be nonsense before doing size arithmetic with them
+    if (header.n_hours > G_MAXUINT16 || cache_size(header.n_hours) > length) {
+        return FALSE;
+    }
+
+    guint n = header.n_hours;
+    forecast_reserve(forecast, n);
+    const guint8 *p = data + sizeof(CacheHeader);
+    if (n > 0) {
+        memcpy(forecast->hours, p, n * sizeof(gint32));
+        p += n * sizeof(gint32);
+        memcpy(forecast->temps, p, n * sizeof(gfloat));
+        p += n * sizeof(gfloat);
+        memcpy(forecast->precip, p, n * sizeof(gfloat));
+        p += n * sizeof(gfloat);
+        memcpy(forecast->codes, p, n);
+    }
+    forecast->n_hours = n;
+    forecast->utc_offset_seconds = header.utc_offset_seconds;
+    forecast->has_utc_offset = (header.flags & CACHE_FLAG_HAS_UTC_OFFSET) != 0;
+
+    // Fixed-size strings from disk are not trusted to be terminated
+    header.timezone[sizeof(header.timezone) - 1] = '\0';
+    header.location[sizeof(header.location) - 1] = '\0';
+    g_strlcpy(forecast->timezone, header.timezone, sizeof(forecast->timezone));
+    // Derived, so not stored: the cache layout stays the same
+    resolve_times(forecast);
+    if (location && location_len > 0) {
+        g_strlcpy(location, header.location, location_len);
+    }
+    if (fetched_at) {
+        *fetched_at = header.fetched_at;
+    }
+    if (record_length) {
+        *record_length = cache_size(n);
+    }
+    return TRUE;
+}
+
+ForecastDaily *forecast_daily_new(void) {
+    return g_new0(ForecastDaily, 1);
+}
+
+void forecast_daily_free(ForecastDaily *daily) {
+    if (!daily) {
+        return;
+    }
+    g_free(daily->days);
+    g_free(daily->spare_days);
+    g_free(daily->hours);
+    g_free(daily->temps);
+    g_free(daily->precip);
+    g_free(daily->codes);
+    g_free(daily);
+}
+
+static void daily_reserve(ForecastDaily *daily, guint n) {
+    if (n <= daily->capacity) {
+        return;
+    }
+    guint capacity = daily->capacity ? daily->capacity : 64;
+    while (capacity < n) {
+        capacity *= 2;
+    }
+    // A day spans at least one hour, so n_hours bounds the number of days too
+    daily->days = g_renew(ForecastDay, daily->days, capacity);
+    daily->spare_days = g_renew(ForecastDay, daily->spare_days, capacity);
+    daily->hours = g_renew(gint32, daily->hours, capacity);
+    daily->temps = g_renew(gfloat, daily->temps, capacity);
+    daily->precip = g_renew(gfloat, daily->precip, capacity);
+    daily->codes = g_renew(guint8, daily->codes, capacity);
+    daily->capacity = capacity;
+}
+
+// Byte-wise, so NAN matches NAN: an unchanged null stays unchanged
+static gboolean same_hours(const ForecastDaily *daily, guint old_start, const WeatherForecast *forecast,
+                           guint start, guint span) {
+    return memcmp(daily->hours + old_start, forecast->hours + start, span * sizeof(gint32)) == 0 &&
+           memcmp(daily->temps + old_start, forecast->temps + start, span * sizeof(gfloat)) == 0 &&
+           memcmp(daily->precip + old_start, forecast->precip + start, span * sizeof(gfloat)) == 0 &&
+           memcmp(daily->codes + old_start, forecast->codes + start, span) == 0;
+}
+
+// One pass over the day's slice of each column, all columns in step. NAN fails
+// every comparison, so nulls drop out of the min, max and sum without a
+// separate check.
+static void aggregate_day(ForecastDay *out, const WeatherForecast *forecast, guint start, guint span) {
+    const gint32 *hours = forecast->hours + start;
+    const gfloat *temps = forecast->temps + start;
+    const gfloat *precip = forecast->precip + start;
+    const guint8 *codes = forecast->codes + start;
+    gfloat low = INFINITY;
+    gfloat high = -INFINITY;
+    gfloat rain = 0.0f;
+    guint n_rain = 0;
+    guint n_valid = 0;
+    guint8 code = 0;
+    for (guint i = 0; i < span; i++) {
+        gboolean valid = hours[i] != FORECAST_HOUR_INVALID;
+        gboolean has_rain = valid && precip[i] == precip[i];
+        low = valid && temps[i] < low ? temps[i] : low;
+        high = valid && temps[i] > high ? temps[i] : high;
+        rain += has_rain ? precip[i] : 0.0f;
+        n_rain += has_rain;
+        code = valid && codes[i] > code ? codes[i] : code;
+        n_valid += valid;
+    }
+    out->start = start;
+    out->span = span;
+    out->n_hours = n_valid;
+    out->code = code;
+    out->temp_min = low <= high ? low : NAN;
+    out->temp_max = low <= high ? high : NAN;
+    out->precip = n_rain > 0 ? rain : NAN;
+}
+
+guint forecast_daily_update(ForecastDaily *daily, const WeatherForecast *forecast) {
+    g_return_val_if_fail(daily != NULL, 0);
+
+    guint n = forecast ? forecast->n_hours : 0;
+    daily_reserve(daily, n);
+
+    // Build the new day list in the spare buffer while the old one is matched against
+    const ForecastDay *previous = daily->days;
+    guint n_previous = daily->n_days;
+    ForecastDay *days = daily->spare_days;
+    guint n_days = 0;
+    guint recomputed = 0;
+    guint k = 0;
+
+    guint i = 0;
+    while (i < n && forecast->hours[i] == FORECAST_HOUR_INVALID) {
+        i++;
+    }
+    while (i < n) {
+        // A day runs until the next valid hour of another day; invalid hours ride along
+        gint32 day = forecast_day_of_hours(forecast->hours[i]);
+        guint start = i;
+        for (i++; i < n && (forecast->hours[i] == FORECAST_HOUR_INVALID ||
+                            forecast_day_of_hours(forecast->hours[i]) == day); i++) {
+        }
+        guint span = i - start;
+
+        while (k < n_previous && previous[k].day < day) {
+            k++;
+        }
+        ForecastDay *out = &days[n_days++];
+        if (k < n_previous && previous[k].day == day && previous[k].span == span &&
+            same_hours(daily, previous[k].start, forecast, start, span)) {
+            *out = previous[k];
+            out->start = start;
+        } else {
+            aggregate_day(out, forecast, start, span);
+            out->day = day;
+            recomputed++;
+        }
+    }
+
+    daily->spare_days = daily->days;
+    daily->days = days;
+    daily->n_days = n_days;
+
+    // What the next update compares against
+    if (n > 0) {
+        memcpy(daily->hours, forecast->hours, n * sizeof(gint32));
+        memcpy(daily->temps, forecast->temps, n * sizeof(gfloat));
+        memcpy(daily->precip, forecast->precip, n * sizeof(gfloat));
+        memcpy(daily->codes, forecast->codes, n);
+    }
+    daily->n_hours = n;
+    return recomputed;
+}
+
+guint forecast_daily_find_day(const ForecastDaily *daily, gint32 day) {
+    g_return_val_if_fail(daily != NULL, 0);
+
+    guint lo = 0;
+    guint hi = daily->n_days;
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        if (daily->days[mid].day >= day) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
@@ -0,0 +1,130 @@
+#ifndef WEATHERCLOCK_FORECAST_H
+#define WEATHERCLOCK_FORECAST_H
+
+#include <glib.h>
+
+#define FORECAST_TIMEZONE_MAX 64      // Longest IANA identifier is well under this
+#define FORECAST_ERROR_MAX 512        // Matches the error label buffers used by the UI
+#define FORECAST_HOUR_INVALID G_MININT32  // hours[] value for an unparseable time string
+#define FORECAST_CACHE_VERSION 2      // Bump whenever the binary cache layout changes
+#define FORECAST_CACHE_LOCATION_MAX 48  // "lat,lon" key the cached forecast was fetched for
+
+// Bytes per forecast hour across all columns
+#define FORECAST_HOUR_BYTES (sizeof(gint64) + sizeof(gint32) + 2 * sizeof(gfloat) + sizeof(guint8))
+
+// Flat struct-of-arrays forecast record filled by forecast_parse()
+// Column i of hours/temps/codes describes the same forecast hour. The columns
+// share one allocation (slab), so a forecast is two blocks however long it is.
+typedef struct {
+    guint n_hours;
+    guint capacity;
+    gpointer slab;   // Private: the block the columns below point into
+    gint32 *hours;   // Wall-clock hours since 1970-01-01T00:00 in the forecast location's timezone
+    gint64 *times;   // Unix time each hour starts, resolved once at parse/load time; non-decreasing
+                     // (an invalid hour repeats the previous entry) so it can be binary searched
+    gfloat *temps;   // temperature_2m in °C (NAN when the API sent null)
+    gfloat *precip;  // precipitation over the preceding hour in mm (NAN when null or not requested)
+    guint8 *codes;   // WMO weathercode
+    gint utc_offset_seconds;
+    gboolean has_utc_offset;
+    gchar timezone[FORECAST_TIMEZONE_MAX];  // Empty string if the response had none
+} WeatherForecast;
+
+typedef enum {
+    FORECAST_PARSE_OK,
+    FORECAST_PARSE_RETRY,       // Transient problem (HTML page, truncated or partial data)
+    FORECAST_PARSE_API_ERROR    // API reported an error (e.g., bad location) - don't retry
+} ForecastParseResult;
+
+WeatherForecast *forecast_new(void);
+void forecast_free(WeatherForecast *forecast);
+void forecast_clear(WeatherForecast *forecast);
+
+// Parse an Open-Meteo response of 'length' bytes (need not be NUL-terminated).
+// The forecast's column buffers are reused across calls, so steady-state refreshes
+// don't allocate. On failure a user-facing message is written to error_msg.
+ForecastParseResult forecast_parse(WeatherForecast *forecast, const gchar *json, gsize length,
+                                   gchar *error_msg, gsize error_msg_len);
+
+// Parse a response to a multi-coordinate request (latitude=a,b,...) into one forecast
+// per requested location, in request order. Open-Meteo answers with a root array
+// for two or more locations and a plain object for one. The batch succeeds only
+// if every location parses; an error object for the whole request is reported as
+// for forecast_parse().
+ForecastParseResult forecast_parse_batch(WeatherForecast **forecasts, guint n_forecasts, const gchar *json,
+                                         gsize length, gchar *error_msg, gsize error_msg_len);
+
+// Pack a civil date/hour into the representation used by WeatherForecast.hours
+gint32 forecast_hours_from_civil(gint year, gint month, gint day, gint hour);
+// Civil date of a day number (days since 1970-01-01, i.e. ForecastDay.day)
+void forecast_civil_from_days(gint32 days, gint *year, gint *month, gint *day);
+
+// Binary snapshot of a forecast, used for the on-disk cache. Layout is a fixed
+// header followed by the hours, temps, precip and codes columns, each 4-byte aligned, so a
+// memory-mapped file can be validated and copied column-by-column.
+// The encoding is host-endian; a cache from another byte order is simply rejected.
+GBytes *forecast_cache_encode(const WeatherForecast *forecast, const gchar *location, gint64 fetched_at);
+
+// Validate and load a snapshot produced by forecast_cache_encode(). Returns FALSE
+// (leaving the forecast cleared) on a bad magic, unknown version or truncated data.
+// 'location' receives the key the snapshot was stored with; 'fetched_at' is in
+// seconds since the Unix epoch. Several snapshots may be stored back to back (one
+// per location); 'record_length' receives the size of this one.
+gboolean forecast_cache_decode(WeatherForecast *forecast, const guint8 *data, gsize length,
+                               gchar *location, gsize location_len, gint64 *fetched_at,
+                               gsize *record_length);
+
+// Index of the first hour that hasn't ended at 'now' (Unix seconds), or n_hours
+// if the whole forecast lies in the past. O(log n) over the times column.
+guint forecast_find_hour(const WeatherForecast *forecast, gint64 now);
+
+// Hour of day (0-23) of a packed hour value
+static inline gint forecast_hour_of_day(gint32 hours) {
+    gint h = hours % 24;
+    return h < 0 ? h + 24 : h;
+}
+
+// One local day of a forecast, aggregated from its hours
+typedef struct {
+    gint32 day;        // Days since 1970-01-01 in the forecast location's timezone
+    guint start;       // First column of the day in the forecast it was computed from
+    guint span;        // Columns in the day, invalid hours included
+    guint n_hours;     // Valid hours that went into the aggregates
+    gfloat temp_min;   // °C, NAN if no hour had a temperature
+    gfloat temp_max;
+    gfloat precip;     // Summed precipitation in mm, NAN if none of the hours had a value
+    guint8 code;       // Highest WMO code of the day: the codes grow with severity
+} ForecastDay;
+
+// Daily aggregates kept up to date incrementally. Each update compares the new
+// hourly columns with the ones the current days were computed from, one day at
+// a time, and only aggregates the days whose hours changed.
+typedef struct {
+    guint n_days;
+    ForecastDay *days;
+    // Private: the columns days[] was computed from, and a second day buffer
+    guint capacity;
+    guint n_hours;
+    gint32 *hours;
+    gfloat *temps;
+    gfloat *precip;
+    guint8 *codes;
+    ForecastDay *spare_days;
+} ForecastDaily;
+
+ForecastDaily *forecast_daily_new(void);
+void forecast_daily_free(ForecastDaily *daily);
+
+// Bring the days up to date with forecast (NULL clears them). Returns the number
+// of days that had to be aggregated again.
+guint forecast_daily_update(ForecastDaily *daily, const WeatherForecast *forecast);
+
+// Index of the first day on or after day, or n_days. O(log n).
+guint forecast_daily_find_day(const ForecastDaily *daily, gint32 day);
+
+// Day number of a packed hour value
+static inline gint32 forecast_day_of_hours(gint32 hours) {
+    return hours >= 0 ? hours / 24 : -((-hours + 23) / 24);
+}
+
+#endif // WEATHERCLOCK_FORECAST_H
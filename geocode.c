@@ -0,0 +1,545 @@
+#include "geocode.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jsonscan.h"
+
+#define INDEX_HEADER "weatherclock-places"
+#define SAME_PLACE_DEGREES 0.001  // Results this close, under the same key, are one place
+
+// One way to find a place: under its normalized name, or (alias) under the
+// normalized query the API matched it for by another name
+typedef struct {
+    gchar key[GEOCODE_KEY_MAX];
+    gboolean alias;
+    GeocodePlace place;
+} IndexEntry;
+
+typedef struct {
+    gchar key[GEOCODE_KEY_MAX];
+    gboolean complete;  // Fewer than GEOCODE_MAX_RESULTS places came back for a prefix search
+} IndexQuery;
+
+struct _PlaceIndex {
+    GArray *entries;  // IndexEntry, sorted by key
+    GArray *queries;  // IndexQuery, sorted by key
+};
+
+void geocode_normalize(const gchar *text, gchar *out, gsize out_len) {
+    if (out_len == 0) {
+        return;
+    }
+    gsize o = 0;
+    gboolean space = FALSE;
+    // NFKD splits accents off their letters, so dropping the marks folds them
+    gchar *decomposed = text ? g_utf8_normalize(text, -1, G_NORMALIZE_NFKD) : NULL;
+    for (const gchar *p = decomposed; p && *p; p = g_utf8_next_char(p)) {
+        gunichar c = g_utf8_get_char(p);
+        if (g_unichar_ismark(c)) {
+            continue;
+        }
+        if (!g_unichar_isalnum(c)) {
+            space = o > 0;  // Runs of spaces and punctuation become one space
+            continue;
+        }
+        gchar utf8[6];
+        gsize n = (gsize)g_unichar_to_utf8(g_unichar_tolower(c), utf8);
+        if (o + n + (space ? 1 : 0) + 1 > out_len) {
+            break;
+        }
+        if (space) {
+            out[o++] = ' ';
+            space = FALSE;
+        }
+        memcpy(out + o, utf8, n);
+        o += n;
+    }
+    out[o] = '\0';
+    g_free(decomposed);
+}
+
+// --- Response parsing ---
+
+typedef struct {
+    GeocodePlace *places;
+    guint max_places;
+    guint n_places;
+    GeocodePlace place;      // Result being scanned
+    gboolean has_latitude;
+    gboolean has_longitude;
+    gboolean error;
+    const gchar *reason;
+    gsize reason_len;
+} ParseContext;
+
+static gboolean parse_text(JsonScanner *s, gchar *out, gsize out_len) {
+    if (s->p >= s->end || *s->p != '"') {
+        return json_scan_skip_value(s);  // null for a place without a region
+    }
+    const gchar *str;
+    gsize len;
+    if (!json_scan_string(s, &str, &len)) {
+        return FALSE;
+    }
+    json_decode_string(str, len, out, out_len);
+    return TRUE;
+}
+
+static gboolean parse_number(JsonScanner *s, gdouble *out, gboolean *present) {
+    if (s->p >= s->end || (*s->p != '-' && !g_ascii_isdigit(*s->p))) {
+        return json_scan_skip_value(s);
+    }
+    if (present) {
+        *present = TRUE;
+    }
+    return json_scan_number(s, out, NULL);
+}
+
+static gboolean parse_place_member(JsonScanner *s, const gchar *key, gsize key_len, gpointer user_data) {
+    ParseContext *ctx = (ParseContext *)user_data;
+    GeocodePlace *place = &ctx->place;
+
+    if (json_key_equals(key, key_len, "name")) {
+        return parse_text(s, place->name, sizeof(place->name));
+    }
+    if (json_key_equals(key, key_len, "admin1")) {
+        return parse_text(s, place->admin1, sizeof(place->admin1));
+    }
+    if (json_key_equals(key, key_len, "country")) {
+        return parse_text(s, place->country, sizeof(place->country));
+    }
+    if (json_key_equals(key, key_len, "timezone")) {
+        return parse_text(s, place->timezone, sizeof(place->timezone));
+    }
+    if (json_key_equals(key, key_len, "latitude")) {
+        return parse_number(s, &place->latitude, &ctx->has_latitude);
+    }
+    if (json_key_equals(key, key_len, "longitude")) {
+        return parse_number(s, &place->longitude, &ctx->has_longitude);
+    }
+    if (json_key_equals(key, key_len, "population")) {
+        gdouble population = 0;
+        if (!parse_number(s, &population, NULL)) {
+            return FALSE;
+        }
+        place->population = population > 0 ? (guint32)MIN(population, (gdouble)G_MAXUINT32) : 0;
+        return TRUE;
+    }
+    return json_scan_skip_value(s);
+}
+
+static gboolean parse_results(JsonScanner *s, ParseContext *ctx) {
+    if (!json_scan_expect(s, '[')) {
+        return FALSE;
+    }
+    for (guint i = 0; json_scan_array_next(s, i); i++) {
+        if (*s->p != '{') {
+            if (!json_scan_skip_value(s)) {
+                return FALSE;
+            }
+            continue;
+        }
+        memset(&ctx->place, 0, sizeof(ctx->place));
+        ctx->has_latitude = FALSE;
+        ctx->has_longitude = FALSE;
+        if (!json_scan_object(s, parse_place_member, ctx)) {
+            return FALSE;
+        }
+        gboolean usable = ctx->has_latitude && ctx->has_longitude && ctx->place.name[0] != '\0' &&
+                          fabs(ctx->place.latitude) <= 90 && fabs(ctx->place.longitude) <= 180;
+        if (usable && ctx->n_places < ctx->max_places) {
+            ctx->places[ctx->n_places++] = ctx->place;
+        }
+    }
+    return s->error == NULL;
+}
+
+static gboolean parse_root_member(JsonScanner *s, const gchar *key, gsize key_len, gpointer user_data) {
+    ParseContext *ctx = (ParseContext *)user_data;
+    gchar c = s->p < s->end ? *s->p : '\0';
+
+    if (json_key_equals(key, key_len, "results") && c == '[') {
+        return parse_results(s, ctx);
+    }
+    if (json_key_equals(key, key_len, "error") && c == 't') {
+        ctx->error = TRUE;
+        return json_scan_literal(s, "true");
+    }
+    if (json_key_equals(key, key_len, "reason") && c == '"') {
+        return json_scan_string(s, &ctx->reason, &ctx->reason_len);
+    }
+    return json_scan_skip_value(s);
+}
+
+GeocodeParseResult geocode_parse(const gchar *json, gsize length, GeocodePlace *places, guint max_places,
+                                 guint *n_places, gchar *error_msg, gsize error_msg_len) {
+    g_return_val_if_fail(n_places != NULL, GEOCODE_PARSE_ERROR);
+    g_return_val_if_fail(error_msg != NULL && error_msg_len > 0, GEOCODE_PARSE_ERROR);
+
+    *n_places = 0;
+    error_msg[0] = '\0';
+    ParseContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.places = places;
+    ctx.max_places = places ? max_places : 0;
+
+    JsonScanner scanner = { json, json ? json + length : NULL, NULL };
+    JsonScanner *s = &scanner;
+    json_scan_skip_ws(s);
+    if (!json || s->p >= s->end || *s->p != '{') {
+        snprintf(error_msg, error_msg_len, "Unexpected answer from the place search");
+        return GEOCODE_PARSE_ERROR;
+    }
+    if (json_scan_object(s, parse_root_member, &ctx)) {
+        json_scan_skip_ws(s);
+        if (s->p != s->end) {
+            json_scan_fail(s, "trailing data");
+        }
+    }
+    if (s->error) {
+        g_warning("Geocoding parse error: %s at offset %" G_GSIZE_FORMAT, s->error, (gsize)(s->p - json));
+        snprintf(error_msg, error_msg_len, "Unexpected answer from the place search");
+        return GEOCODE_PARSE_ERROR;
+    }
+    if (ctx.error) {
+        gchar reason[FORECAST_ERROR_MAX] = "unknown";
+        if (ctx.reason) {
+            json_decode_string(ctx.reason, ctx.reason_len, reason, sizeof(reason));
+        }
+        snprintf(error_msg, error_msg_len, "Place search failed: %s", reason);
+        return GEOCODE_PARSE_API_ERROR;
+    }
+    *n_places = ctx.n_places;
+    return GEOCODE_PARSE_OK;
+}
+
+// --- Prefix index ---
+
+PlaceIndex *place_index_new(void) {
+    PlaceIndex *index = g_new0(PlaceIndex, 1);
+    index->entries = g_array_new(FALSE, FALSE, sizeof(IndexEntry));
+    index->queries = g_array_new(FALSE, FALSE, sizeof(IndexQuery));
+    return index;
+}
+
+void place_index_free(PlaceIndex *index) {
+    if (!index) {
+        return;
+    }
+    g_array_unref(index->entries);
+    g_array_unref(index->queries);
+    g_free(index);
+}
+
+guint place_index_get_size(const PlaceIndex *index) {
+    return index->entries->len;
+}
+
+// Both arrays start with the key, so one comparison and one search serve both
+static int compare_keys(const void *a, const void *b) {
+    return strcmp((const gchar *)a, (const gchar *)b);
+}
+
+// First element of array (elements of size element_size, key first) whose key is >= key
+static guint lower_bound(GArray *array, gsize element_size, const gchar *key) {
+    guint lo = 0;
+    guint hi = array->len;
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        if (strcmp(array->data + (gsize)mid * element_size, key) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static gboolean same_place(const GeocodePlace *a, const GeocodePlace *b) {
+    return fabs(a->latitude - b->latitude) < SAME_PLACE_DEGREES &&
+           fabs(a->longitude - b->longitude) < SAME_PLACE_DEGREES;
+}
+
+// Insert results[] ordered by population, keeping the first max_results
+static void add_result(GeocodePlace *results, guint *n_results, guint max_results, const GeocodePlace *place) {
+    for (guint i = 0; i < *n_results; i++) {
+        if (same_place(&results[i], place)) {
+            return;  // Found under its name and as an alias
+        }
+    }
+    guint at = *n_results;
+    while (at > 0 && results[at - 1].population < place->population) {
+        at--;
+    }
+    if (at >= max_results) {
+        return;
+    }
+    guint n = MIN(*n_results + 1, max_results);
+    memmove(&results[at + 1], &results[at], (n - at - 1) * sizeof(GeocodePlace));
+    results[at] = *place;
+    *n_results = n;
+}
+
+guint place_index_lookup(const PlaceIndex *index, const gchar *query, GeocodePlace *results, guint max_results) {
+    g_return_val_if_fail(index != NULL, 0);
+
+    gchar key[GEOCODE_KEY_MAX];
+    geocode_normalize(query, key, sizeof(key));
+    gsize key_len = strlen(key);
+    if (key_len == 0 || max_results == 0) {
+        return 0;
+    }
+
+    guint n_results = 0;
+    const IndexEntry *entries = (const IndexEntry *)index->entries->data;
+    for (guint i = lower_bound(index->entries, sizeof(IndexEntry), key);
+         i < index->entries->len && strncmp(entries[i].key, key, key_len) == 0; i++) {
+        add_result(results, &n_results, max_results, &entries[i].place);
+    }
+
+    // Aliases stored under a shorter search: "munch" matched Munich, so "münche" may too
+    gchar prefix[GEOCODE_KEY_MAX];
+    for (gsize len = GEOCODE_MIN_PREFIX; len < key_len; len++) {
+        memcpy(prefix, key, len);
+        prefix[len] = '\0';
+        for (guint i = lower_bound(index->entries, sizeof(IndexEntry), prefix);
+             i < index->entries->len && strcmp(entries[i].key, prefix) == 0; i++) {
+            if (entries[i].alias) {
+                add_result(results, &n_results, max_results, &entries[i].place);
+            }
+        }
+    }
+    return n_results;
+}
+
+static const IndexQuery *find_query(const PlaceIndex *index, const gchar *key) {
+    guint i = lower_bound(index->queries, sizeof(IndexQuery), key);
+    if (i >= index->queries->len) {
+        return NULL;
+    }
+    const IndexQuery *query = &g_array_index(index->queries, IndexQuery, i);
+    return strcmp(query->key, key) == 0 ? query : NULL;
+}
+
+gboolean place_index_covers(const PlaceIndex *index, const gchar *query) {
+    g_return_val_if_fail(index != NULL, FALSE);
+
+    gchar key[GEOCODE_KEY_MAX];
+    geocode_normalize(query, key, sizeof(key));
+    gsize key_len = strlen(key);
+    if (key_len < GEOCODE_MIN_QUERY) {
+        return FALSE;
+    }
+    const IndexQuery *exact = find_query(index, key);
+    if (exact) {
+        return TRUE;
+    }
+    gchar prefix[GEOCODE_KEY_MAX];
+    for (gsize len = GEOCODE_MIN_PREFIX; len < key_len; len++) {
+        memcpy(prefix, key, len);
+        prefix[len] = '\0';
+        const IndexQuery *answered = find_query(index, prefix);
+        if (answered && answered->complete) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+// Tabs and newlines would break the file's lines
+static void sanitize_text(gchar *text) {
+    for (gchar *p = text; *p; p++) {
+        if (*p == '\t' || *p == '\n' || *p == '\r') {
+            *p = ' ';
+        }
+    }
+}
+
+static gboolean insert_entry(PlaceIndex *index, const gchar *key, gboolean alias, const GeocodePlace *place) {
+    guint i = lower_bound(index->entries, sizeof(IndexEntry), key);
+    for (guint j = i; j < index->entries->len; j++) {
+        IndexEntry *entry = &g_array_index(index->entries, IndexEntry, j);
+        if (strcmp(entry->key, key) != 0) {
+            break;
+        }
+        if (same_place(&entry->place, place)) {
+            if (memcmp(&entry->place, place, sizeof(*place)) == 0 && entry->alias == alias) {
+                return FALSE;
+            }
+            entry->place = *place;  // Newer details (population, zone)
+            entry->alias = entry->alias && alias;
+            return TRUE;
+        }
+    }
+    if (index->entries->len >= GEOCODE_INDEX_MAX_PLACES) {
+        g_debug("Place index full, not adding %s", place->name);
+        return FALSE;
+    }
+    IndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    g_strlcpy(entry.key, key, sizeof(entry.key));
+    entry.alias = alias;
+    entry.place = *place;
+    g_array_insert_val(index->entries, i, entry);
+    return TRUE;
+}
+
+gboolean place_index_add(PlaceIndex *index, const gchar *query, const GeocodePlace *places, guint n_places) {
+    g_return_val_if_fail(index != NULL, FALSE);
+
+    gchar query_key[GEOCODE_KEY_MAX];
+    geocode_normalize(query, query_key, sizeof(query_key));
+    if (strlen(query_key) < GEOCODE_MIN_QUERY) {
+        return FALSE;
+    }
+
+    gboolean changed = FALSE;
+    for (guint i = 0; i < n_places; i++) {
+        GeocodePlace place;
+        memset(&place, 0, sizeof(place));  // Fixed bytes after each string, for the comparison above
+        g_strlcpy(place.name, places[i].name, sizeof(place.name));
+        g_strlcpy(place.admin1, places[i].admin1, sizeof(place.admin1));
+        g_strlcpy(place.country, places[i].country, sizeof(place.country));
+        g_strlcpy(place.timezone, places[i].timezone, sizeof(place.timezone));
+        place.latitude = places[i].latitude;
+        place.longitude = places[i].longitude;
+        place.population = places[i].population;
+        sanitize_text(place.name);
+        sanitize_text(place.admin1);
+        sanitize_text(place.country);
+        sanitize_text(place.timezone);
+
+        gchar name_key[GEOCODE_KEY_MAX];
+        geocode_normalize(place.name, name_key, sizeof(name_key));
+        if (name_key[0] != '\0') {
+            changed |= insert_entry(index, name_key, FALSE, &place);
+        }
+        if (!g_str_has_prefix(name_key, query_key)) {
+            changed |= insert_entry(index, query_key, TRUE, &place);
+        }
+    }
+
+    // A 2-letter search only finds exact names: "pa" coming back short says nothing about Paris
+    gboolean complete = n_places < GEOCODE_MAX_RESULTS && strlen(query_key) >= GEOCODE_MIN_PREFIX;
+    guint i = lower_bound(index->queries, sizeof(IndexQuery), query_key);
+    IndexQuery *existing = i < index->queries->len ? &g_array_index(index->queries, IndexQuery, i) : NULL;
+    if (existing && strcmp(existing->key, query_key) == 0) {
+        if (existing->complete != complete) {
+            existing->complete = complete;
+            changed = TRUE;
+        }
+    } else if (index->queries->len < GEOCODE_INDEX_MAX_QUERIES) {
+        IndexQuery answered;
+        memset(&answered, 0, sizeof(answered));
+        g_strlcpy(answered.key, query_key, sizeof(answered.key));
+        answered.complete = complete;
+        g_array_insert_val(index->queries, i, answered);
+        changed = TRUE;
+    }
+    return changed;
+}
+
+GBytes *place_index_encode(const PlaceIndex *index) {
+    g_return_val_if_fail(index != NULL, NULL);
+
+    GString *out = g_string_new(NULL);
+    g_string_append_printf(out, INDEX_HEADER "\t%d\n", GEOCODE_INDEX_VERSION);
+    for (guint i = 0; i < index->queries->len; i++) {
+        const IndexQuery *query = &g_array_index(index->queries, IndexQuery, i);
+        g_string_append_printf(out, "q\t%s\t%d\n", query->key, query->complete ? 1 : 0);
+    }
+    gchar latitude[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar longitude[G_ASCII_DTOSTR_BUF_SIZE];
+    for (guint i = 0; i < index->entries->len; i++) {
+        const IndexEntry *entry = &g_array_index(index->entries, IndexEntry, i);
+        const GeocodePlace *place = &entry->place;
+        g_ascii_formatd(latitude, sizeof(latitude), "%.5f", place->latitude);
+        g_ascii_formatd(longitude, sizeof(longitude), "%.5f", place->longitude);
+        g_string_append_printf(out, "p\t%s\t%d\t%s\t%s\t%u\t%s\t%s\t%s\t%s\n", entry->key, entry->alias ? 1 : 0,
+                               latitude, longitude, place->population, place->timezone, place->name,
+                               place->admin1, place->country);
+    }
+    return g_string_free_to_bytes(out);
+}
+
+static gboolean is_sorted(GArray *array, gsize element_size) {
+    for (guint i = 1; i < array->len; i++) {
+        if (strcmp(array->data + (gsize)(i - 1) * element_size, array->data + (gsize)i * element_size) > 0) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static gboolean parse_coordinate(const gchar *text, gdouble limit, gdouble *out) {
+    gchar *end = NULL;
+    *out = g_ascii_strtod(text, &end);
+    return end && end != text && *end == '\0' && isfinite(*out) && fabs(*out) <= limit;
+}
+
+gboolean place_index_load(PlaceIndex *index, const gchar *contents, gsize length) {
+    g_return_val_if_fail(index != NULL, FALSE);
+
+    g_array_set_size(index->entries, 0);
+    g_array_set_size(index->queries, 0);
+    if (!contents || length == 0) {
+        return FALSE;  // An empty file (g_mapped_file_get_contents() gives NULL for it)
+    }
+    gchar *text = g_strndup(contents, length);
+    gchar **lines = g_strsplit(text, "\n", -1);
+    g_free(text);
+
+    gchar header[64];
+    g_snprintf(header, sizeof(header), INDEX_HEADER "\t%d", GEOCODE_INDEX_VERSION);
+    gboolean ok = lines[0] && strcmp(lines[0], header) == 0;
+    for (guint i = 1; ok && lines[i]; i++) {
+        if (lines[i][0] == '\0') {
+            continue;
+        }
+        gchar **fields = g_strsplit(lines[i], "\t", -1);
+        guint n_fields = g_strv_length(fields);
+        if (strcmp(fields[0], "q") == 0 && n_fields == 3 && index->queries->len < GEOCODE_INDEX_MAX_QUERIES) {
+            IndexQuery query;
+            memset(&query, 0, sizeof(query));
+            g_strlcpy(query.key, fields[1], sizeof(query.key));
+            query.complete = strcmp(fields[2], "1") == 0 && strlen(query.key) >= GEOCODE_MIN_PREFIX;
+            g_array_append_val(index->queries, query);
+        } else if (strcmp(fields[0], "p") == 0 && n_fields == 10 &&
+                   index->entries->len < GEOCODE_INDEX_MAX_PLACES) {
+            IndexEntry entry;
+            memset(&entry, 0, sizeof(entry));
+            g_strlcpy(entry.key, fields[1], sizeof(entry.key));
+            entry.alias = strcmp(fields[2], "1") == 0;
+            GeocodePlace *place = &entry.place;
+            ok = parse_coordinate(fields[3], 90, &place->latitude) &&
+                 parse_coordinate(fields[4], 180, &place->longitude);
+            place->population = (guint32)g_ascii_strtoull(fields[5], NULL, 10);
+            g_strlcpy(place->timezone, fields[6], sizeof(place->timezone));
+            g_strlcpy(place->name, fields[7], sizeof(place->name));
+            g_strlcpy(place->admin1, fields[8], sizeof(place->admin1));
+            g_strlcpy(place->country, fields[9], sizeof(place->country));
+            g_array_append_val(index->entries, entry);
+        } else if (strcmp(fields[0], "q") != 0 && strcmp(fields[0], "p") != 0) {
+            ok = FALSE;
+        }
+        g_strfreev(fields);
+    }
+    g_strfreev(lines);
+
+    if (!ok) {
+        g_array_set_size(index->entries, 0);
+        g_array_set_size(index->queries, 0);
+        return FALSE;
+    }
+    // Written sorted; edited by hand, perhaps not
+    if (!is_sorted(index->entries, sizeof(IndexEntry))) {
+        g_array_sort(index->entries, (GCompareFunc)compare_keys);
+    }
+    if (!is_sorted(index->queries, sizeof(IndexQuery))) {
+        g_array_sort(index->queries, (GCompareFunc)compare_keys);
+    }
+    return TRUE;
+}
@@ -0,0 +1,76 @@
+#ifndef WEATHERCLOCK_GEOCODE_H
+#define WEATHERCLOCK_GEOCODE_H
+
+#include <glib.h>
+
+#include "forecast.h"
+
+// Place search for the settings window: a parser for Open-Meteo geocoding
+// responses and a prefix index of every place resolved so far, persisted as a
+// sorted text file. Searches the index has already answered completely are
+// served from it, so they are instant and work offline.
+// Pure bookkeeping: the caller does the requests and the file I/O.
+
+#define GEOCODE_MAX_RESULTS 10        // count= of each request, and rows shown
+#define GEOCODE_MIN_QUERY 2           // Shorter searches are not sent (the API needs 2+ letters)
+#define GEOCODE_MIN_PREFIX 3          // The API matches shorter searches exactly, not as prefixes,
+                                      // so their answers say nothing about longer searches
+#define GEOCODE_KEY_MAX 64            // Normalized name or query, in bytes
+#define GEOCODE_TEXT_MAX 64           // Name, region and country, truncated to this
+#define GEOCODE_INDEX_MAX_PLACES 4096 // The index stops growing here
+#define GEOCODE_INDEX_MAX_QUERIES 4096
+#define GEOCODE_INDEX_VERSION 1       // Bump whenever the file layout changes
+
+typedef struct {
+    gchar name[GEOCODE_TEXT_MAX];       // "Zürich"
+    gchar admin1[GEOCODE_TEXT_MAX];     // First-level region ("Zurich"), may be empty
+    gchar country[GEOCODE_TEXT_MAX];    // "Switzerland", may be empty
+    gchar timezone[FORECAST_TIMEZONE_MAX];  // IANA zone, may be empty
+    gdouble latitude;
+    gdouble longitude;
+    guint32 population;                 // Ranks the matches of a prefix; 0 if unknown
+} GeocodePlace;
+
+typedef enum {
+    GEOCODE_PARSE_OK,            // Possibly with no places: nothing matched
+    GEOCODE_PARSE_ERROR,         // Not a geocoding response (HTML page, truncated data)
+    GEOCODE_PARSE_API_ERROR      // The API rejected the search ("reason" in error_msg)
+} GeocodeParseResult;
+
+// Case-, accent- and punctuation-insensitive form of a name or search text:
+// "São  Paulo" and "sao paulo" both give "sao paulo". Truncated to fit out.
+void geocode_normalize(const gchar *text, gchar *out, gsize out_len);
+
+// Parse a /v1/search response into at most max_places places, in the API's
+// order (most relevant first). Places without coordinates are skipped.
+GeocodeParseResult geocode_parse(const gchar *json, gsize length, GeocodePlace *places, guint max_places,
+                                 guint *n_places, gchar *error_msg, gsize error_msg_len);
+
+typedef struct _PlaceIndex PlaceIndex;
+
+PlaceIndex *place_index_new(void);
+void place_index_free(PlaceIndex *index);
+
+// Up to max_results indexed places for a search, most populous first: those
+// whose normalized name starts with the normalized query, and those the API
+// matched on another name (e.g., "münchen" for Munich) for that query or a
+// prefix of it of at least GEOCODE_MIN_PREFIX. O(log n) to find the range.
+guint place_index_lookup(const PlaceIndex *index, const gchar *query, GeocodePlace *results, guint max_results);
+
+// TRUE if a lookup already gives everything the API would: this query was
+// answered before, or a prefix of at least GEOCODE_MIN_PREFIX was answered
+// with fewer than GEOCODE_MAX_RESULTS places (so nothing else can start with it).
+gboolean place_index_covers(const PlaceIndex *index, const gchar *query);
+
+// Record the API's answer to a query. Returns TRUE if the index changed.
+gboolean place_index_add(PlaceIndex *index, const gchar *query, const GeocodePlace *places, guint n_places);
+
+// The file form: a header line, then one line per query and per place, sorted
+// by key so the file itself is the index. Loading replaces the contents and
+// returns FALSE (leaving the index empty) for another version or bad data.
+GBytes *place_index_encode(const PlaceIndex *index);
+gboolean place_index_load(PlaceIndex *index, const gchar *contents, gsize length);
+
+guint place_index_get_size(const PlaceIndex *index);
+
+#endif // WEATHERCLOCK_GEOCODE_H
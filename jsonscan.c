@@ -0,0 +1,278 @@
+#include "jsonscan.h"
+
+gboolean json_scan_fail(JsonScanner *s, const gchar *message) {
+    if (!s->error) {
+        s->error = message;
+    }
+    return FALSE;
+}
+
+gboolean json_scan_expect(JsonScanner *s, gchar c) {
+    json_scan_skip_ws(s);
+    if (s->p >= s->end) {
+        return json_scan_fail(s, "unexpected end of data");
+    }
+    if (*s->p != c) {
+        return json_scan_fail(s, "unexpected character");
+    }
+    s->p++;
+    return TRUE;
+}
+
+// Scan a string token; on success *out/*out_len (if given) cover the raw,
+// still-escaped contents between the quotes.
+gboolean json_scan_string(JsonScanner *s, const gchar **out, gsize *out_len) {
+    if (!json_scan_expect(s, '"')) {
+        return FALSE;
+    }
+    const gchar *start = s->p;
+    while (s->p < s->end) {
+        gchar c = *s->p;
+        if (c == '"') {
+            if (out) *out = start;
+            if (out_len) *out_len = (gsize)(s->p - start);
+            s->p++;
+            return TRUE;
+        }
+        if (c == '\\') {
+            if (s->p + 1 >= s->end) {
+                break;  // A trailing backslash escapes nothing
+            }
+            s->p++;  // Skip the escaped character (\uXXXX digits are plain bytes)
+        }
+        s->p++;
+    }
+    return json_scan_fail(s, "unterminated string");
+}
+
+gboolean json_scan_literal(JsonScanner *s, const gchar *literal) {
+    gsize len = strlen(literal);
+    if ((gsize)(s->end - s->p) < len || memcmp(s->p, literal, len) != 0) {
+        return json_scan_fail(s, "invalid literal");
+    }
+    s->p += len;
+    return TRUE;
+}
+
+// Parse a JSON number without requiring a NUL-terminated buffer.
+// *is_integer reports whether the token had no fraction or exponent.
+gboolean json_scan_number(JsonScanner *s, gdouble *out, gboolean *is_integer) {
+    const gchar *p = s->p;
+    gboolean negative = FALSE;
+    gboolean integer = TRUE;
+    gdouble value = 0.0;
+
+    if (p < s->end && *p == '-') {
+        negative = TRUE;
+        p++;
+    }
+    if (p >= s->end || !g_ascii_isdigit(*p)) {
+        return json_scan_fail(s, "invalid number");
+    }
+    while (p < s->end && g_ascii_isdigit(*p)) {
+        value = value * 10.0 + (*p - '0');
+        p++;
+    }
+    if (p < s->end && *p == '.') {
+        integer = FALSE;
+        p++;
+        if (p >= s->end || !g_ascii_isdigit(*p)) {
+            return json_scan_fail(s, "invalid number");
+        }
+        gdouble scale = 0.1;
+        while (p < s->end && g_ascii_isdigit(*p)) {
+            value += (*p - '0') * scale;
+            scale *= 0.1;
+            p++;
+        }
+    }
+    if (p < s->end && (*p == 'e' || *p == 'E')) {
+        integer = FALSE;
+        p++;
+        gboolean exp_negative = FALSE;
+        if (p < s->end && (*p == '+' || *p == '-')) {
+            exp_negative = (*p == '-');
+            p++;
+        }
+        if (p >= s->end || !g_ascii_isdigit(*p)) {
+            return json_scan_fail(s, "invalid number");
+        }
+        gint exponent = 0;
+        while (p < s->end && g_ascii_isdigit(*p)) {
+            if (exponent < 400) {
+                exponent = exponent * 10 + (*p - '0');
+            }
+            p++;
+        }
+        while (exponent-- > 0) {
+            value = exp_negative ? value / 10.0 : value * 10.0;
+        }
+    }
+
+    s->p = p;
+    if (out) *out = negative ? -value : value;
+    if (is_integer) *is_integer = integer;
+    return TRUE;
+}
+
+// Skip over any value. Containers are skipped by bracket depth without
+// validating their contents - we only care about the members we read.
+gboolean json_scan_skip_value(JsonScanner *s) {
+    json_scan_skip_ws(s);
+    if (s->p >= s->end) {
+        return json_scan_fail(s, "unexpected end of data");
+    }
+    switch (*s->p) {
+        case '"':
+            return json_scan_string(s, NULL, NULL);
+        case 't':
+            return json_scan_literal(s, "true");
+        case 'f':
+            return json_scan_literal(s, "false");
+        case 'n':
+            return json_scan_literal(s, "null");
+        case '{':
+        case '[': {
+            gint depth = 0;
+            while (s->p < s->end) {
+                gchar c = *s->p;
+                if (c == '"') {
+                    if (!json_scan_string(s, NULL, NULL)) {
+                        return FALSE;
+                    }
+                    continue;
+                }
+                s->p++;
+                if (c == '{' || c == '[') {
+                    depth++;
+                } else if (c == '}' || c == ']') {
+                    if (--depth == 0) {
+                        return TRUE;
+                    }
+                }
+            }
+            return json_scan_fail(s, "unexpected end of data");
+        }
+        default:
+            return json_scan_number(s, NULL, NULL);
+    }
+}
+
+gboolean json_scan_object(JsonScanner *s, JsonMemberFunc func, gpointer user_data) {
+    if (!json_scan_expect(s, '{')) {
+        return FALSE;
+    }
+    json_scan_skip_ws(s);
+    if (s->p < s->end && *s->p == '}') {
+        s->p++;
+        return TRUE;
+    }
+    while (TRUE) {
+        const gchar *key;
+        gsize key_len;
+        if (!json_scan_string(s, &key, &key_len) || !json_scan_expect(s, ':')) {
+            return FALSE;
+        }
+        json_scan_skip_ws(s);
+        if (!func(s, key, key_len, user_data)) {
+            return FALSE;
+        }
+        json_scan_skip_ws(s);
+        if (s->p >= s->end) {
+            return json_scan_fail(s, "unexpected end of data");
+        }
+        if (*s->p == ',') {
+            s->p++;
+            continue;
+        }
+        if (*s->p == '}') {
+            s->p++;
+            return TRUE;
+        }
+        return json_scan_fail(s, "expected ',' or '}'");
+    }
+}
+
+// Position the scanner on array element 'index'. Returns FALSE at the closing
+// bracket (consumed) or on error - callers tell the two apart via s->error.
+gboolean json_scan_array_next(JsonScanner *s, guint index) {
+    json_scan_skip_ws(s);
+    if (s->p >= s->end) {
+        return json_scan_fail(s, "unexpected end of data");
+    }
+    if (*s->p == ']') {
+        s->p++;
+        return FALSE;
+    }
+    if (index > 0) {
+        if (*s->p != ',') {
+            return json_scan_fail(s, "expected ',' or ']'");
+        }
+        s->p++;
+        json_scan_skip_ws(s);
+        if (s->p >= s->end) {
+            return json_scan_fail(s, "unexpected end of data");
+        }
+    }
+    return TRUE;
+}
+
+// Decode a raw JSON string into a bounded, NUL-terminated buffer (truncating if needed)
+void json_decode_string(const gchar *raw, gsize len, gchar *out, gsize out_len) {
+    gsize o = 0;
+    const gchar *p = raw;
+    const gchar *end = raw + len;
+
+    if (out_len == 0) {
+        return;
+    }
+    while (p < end && o + 1 < out_len) {
+        if (*p != '\\' || p + 1 >= end) {
+            out[o++] = *p++;
+            continue;
+        }
+        p++;
+        gchar esc = *p++;
+        switch (esc) {
+            case 'b': out[o++] = '\b'; break;
+            case 'f': out[o++] = '\f'; break;
+            case 'n': out[o++] = '\n'; break;
+            case 'r': out[o++] = '\r'; break;
+            case 't': out[o++] = '\t'; break;
+            case 'u': {
+                if (end - p < 4 || !g_ascii_isxdigit(p[0]) || !g_ascii_isxdigit(p[1]) ||
+                    !g_ascii_isxdigit(p[2]) || !g_ascii_isxdigit(p[3])) {
+                    out[o++] = '?';
+                    break;
+                }
+                gunichar ch = (g_ascii_xdigit_value(p[0]) << 12) | (g_ascii_xdigit_value(p[1]) << 8) |
+                              (g_ascii_xdigit_value(p[2]) << 4) | g_ascii_xdigit_value(p[3]);
+                p += 4;
+                // Combine a UTF-16 surrogate pair if one follows
+                if (ch >= 0xD800 && ch <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                    g_ascii_isxdigit(p[2]) && g_ascii_isxdigit(p[3]) &&
+                    g_ascii_isxdigit(p[4]) && g_ascii_isxdigit(p[5])) {
+                    gunichar low = (g_ascii_xdigit_value(p[2]) << 12) | (g_ascii_xdigit_value(p[3]) << 8) |
+                                   (g_ascii_xdigit_value(p[4]) << 4) | g_ascii_xdigit_value(p[5]);
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        ch = 0x10000 + ((ch - 0xD800) << 10) + (low - 0xDC00);
+                        p += 6;
+                    }
+                }
+                gchar utf8[6];
+                gint n = g_unichar_to_utf8(g_unichar_validate(ch) ? ch : 0xFFFD, utf8);
+                if (o + (gsize)n + 1 > out_len) {
+                    p = end;  // No room for the whole character - truncate here
+                    break;
+                }
+                memcpy(out + o, utf8, (gsize)n);
+                o += (gsize)n;
+                break;
+            }
+            default:
+                out[o++] = esc;  // \" \\ \/ and anything unexpected
+                break;
+        }
+    }
+    out[o] = '\0';
+}
@@ -0,0 +1,51 @@
+#ifndef WEATHERCLOCK_JSONSCAN_H
+#define WEATHERCLOCK_JSONSCAN_H
+
+#include <glib.h>
+#include <string.h>
+
+// Minimal pull scanner over a length-bounded buffer, shared by the forecast and
+// geocoding parsers. The first failure is recorded in 'error' and every
+// json_scan_* function returns FALSE afterwards. Strings are returned as raw,
+// still-escaped spans of the input; nothing is allocated.
+typedef struct {
+    const gchar *p;
+    const gchar *end;
+    const gchar *error;
+} JsonScanner;
+
+// Called by json_scan_object() with the scanner on the member's value, which
+// it must consume (json_scan_skip_value() for members it doesn't want)
+typedef gboolean (*JsonMemberFunc)(JsonScanner *s, const gchar *key, gsize key_len, gpointer user_data);
+
+gboolean json_scan_fail(JsonScanner *s, const gchar *message);
+
+static inline void json_scan_skip_ws(JsonScanner *s) {
+    while (s->p < s->end && (*s->p == ' ' || *s->p == '\n' || *s->p == '\r' || *s->p == '\t')) {
+        s->p++;
+    }
+}
+
+gboolean json_scan_expect(JsonScanner *s, gchar c);
+// On success *out/*out_len (if given) cover the contents between the quotes
+gboolean json_scan_string(JsonScanner *s, const gchar **out, gsize *out_len);
+gboolean json_scan_literal(JsonScanner *s, const gchar *literal);
+// *is_integer reports whether the token had no fraction or exponent
+gboolean json_scan_number(JsonScanner *s, gdouble *out, gboolean *is_integer);
+// Containers are skipped by bracket depth without validating their contents
+gboolean json_scan_skip_value(JsonScanner *s);
+gboolean json_scan_object(JsonScanner *s, JsonMemberFunc func, gpointer user_data);
+// Position the scanner on array element 'index' (after the '['). Returns FALSE
+// at the closing bracket (consumed) or on error - tell the two apart via s->error.
+gboolean json_scan_array_next(JsonScanner *s, guint index);
+
+static inline gboolean json_key_equals(const gchar *key, gsize key_len, const gchar *literal) {
+    gsize len = strlen(literal);
+    return key_len == len && memcmp(key, literal, len) == 0;
+}
+
+// Decode a raw JSON string into a bounded, NUL-terminated buffer (truncating
+// on a character boundary if needed)
+void json_decode_string(const gchar *raw, gsize len, gchar *out, gsize out_len);
+
+#endif // WEATHERCLOCK_JSONSCAN_H
@@ -1,85 +1,330 @@
 #include <gtk/gtk.h>
 #include <glib.h>
 #include <glib/gstdio.h>
-#include <json-glib/json-glib.h>
-#include <json-glib/json-gobject.h>
 #include <time.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 #include <libsoup/soup.h>
 #include <libsoup/soup-message-body.h>
 
+#include "broker.h"
+#include "clockface.h"
+#include "forecast.h"
+#include "geocode.h"
+#include "metrics.h"
+#include "quality.h"
+#include "retry.h"
+#include "strip.h"
+#include "tztable.h"
+#include "watchdog.h"
+
 #define WEATHER_API_URL "https://api.open-meteo.com/v1/forecast?latitude=52.52&longitude=13.41&hourly=temperature_2m,weathercode&forecast_days=1"
-#define UPDATE_INTERVAL_SECONDS 3600  // 1 hour in seconds
+#define WEATHER_API_HOST "api.open-meteo.com"  // Every request goes here (see create_soup_session())
+#define DEFAULT_HTTP_TIMEOUT 60              // [Network] timeout_seconds; libsoup's own default
+#define DEFAULT_HTTP_IDLE_TIMEOUT 60         // [Network] idle_timeout_seconds; libsoup's own default
+#define DEFAULT_DNS_CACHE_SECONDS 21600      // [Network] dns_cache_seconds: reuse resolved addresses for 6 h
+#define UPDATE_INTERVAL_SECONDS 3600  // Default refresh interval: 1 hour in seconds
+#define MIN_UPDATE_INTERVAL_SECONDS 600     // [Fetch] interval_minutes is clamped to 10 min..1 day
+#define MAX_UPDATE_INTERVAL_SECONDS 86400
+#define DEFAULT_REFRESH_JITTER_SECONDS 300  // Per-device spread of the refresh time after each slot
 #define CONFIG_FILE_NAME "weatherclock.conf"
-#define MAX_RETRY_ATTEMPTS 5          // Maximum number of retry attempts
-#define INITIAL_RETRY_DELAY 30        // Initial retry delay in seconds (30s)
-#define MAX_RETRY_DELAY 600           // Maximum retry delay in seconds (10 minutes)
+#define CONFIG_SAVE_DELAY_MS 2000     // Settings are written once unchanged for this long
+#define CONFIG_RELOAD_DELAY_MS 500    // Config changes by others are read once the file settles
+#define CACHE_FILE_NAME "weatherclock.cache"  // Last good forecast, stored next to the config
+#define DEFAULT_HOURS_TO_SHOW 6       // [Display] hours_to_show: hour cards per forecast strip
+#define MAX_HOURS_TO_SHOW 168         // A week; fetch_weather() asks for enough forecast days to fill it
+#define MAX_FORECAST_DAYS 16          // Open-Meteo's limit for forecast_days
+#define MIN_EXTENDED_FORECAST_DAYS 7  // [Display] forecast_days: shortest extended view
+#define MAX_LOCATIONS 8               // Locations fetched together in one batch request
+#define CLOCK_TICK_SLACK_MS 2         // Wake just past the boundary so the new second has begun
+#define CSS_RESOURCE_PATH "/com/weatherclock/app/weatherclock.css"  // resources/weatherclock.css
+#define SERVICES_MAX_DELAY_MS 3000    // Network services start by then even if no frame was painted
+#define COMPACT_MALLOC_ARENAS 2       // [Memory] compact: glibc heaps shared by all threads
+#define RENDER_QUALITY_AUTO -1        // [Display] render_quality=auto: adapt to measured frame times
+#define DEFAULT_FRAME_BUDGET_MS 16    // [Display] frame_budget_ms: one frame at 60 Hz
+#define MIN_FRAME_BUDGET_MS 4
+#define MAX_FRAME_BUDGET_MS 1000
+#define GEOCODING_API_HOST "geocoding-api.open-meteo.com"  // Settings place search
+#define PLACES_FILE_NAME "weatherclock.places"  // Places found so far, stored next to the config
+#define GEOCODE_DEBOUNCE_MS 300       // A search is sent once typing pauses for this long
+#define PLACES_SAVE_DELAY_MS 5000     // The place index is written once searches pause this long
+
+// One location's forecast strip. locations[0] is the primary location
+// (latitude/longitude in the config); it also drives the clock's timezone.
+// Strips are created once for all MAX_LOCATIONS and hidden when unused.
+typedef struct {
+    gchar *lat;
+    gchar *lon;
+    WeatherForecast *forecast;  // Last parsed forecast (column buffers reused across refreshes)
+    GtkWidget *strip;           // Title + hours; hidden beyond n_locations
+    GtkWidget *title_label;     // Location name, only shown with several locations
+    GtkWidget *hours_view;      // WeatherStrip drawing up to hours_to_show hours
+    ForecastDaily *daily;       // Day panels of the extended view (NULL unless forecast_days is set)
+} LocationStrip;
+
+// Upstream transfer accounting for the weather fetch, logged after each response
+typedef struct {
+    guint64 requests;             // Responses received (any status)
+    guint64 not_modified;         // 304 responses answered from the current forecast
+    guint64 wire_bytes;           // Response body bytes as received (compressed)
+    guint64 decoded_bytes;        // Response body bytes after content decoding
+    guint64 saved_compression;    // decoded_bytes - wire_bytes over full responses
+    guint64 saved_not_modified;   // Full wire size each 304 avoided downloading again
+    guint64 new_connections;      // Responses that needed a fresh TCP (and TLS) connection
+    guint64 reused_connections;   // Responses served over a kept-alive connection
+    guint64 dns_us;               // Summed phase times in microseconds, over the responses
+    guint64 connect_us;           // that went through each phase
+    guint64 tls_us;
+    guint64 ttfb_us;
+    guint64 body_us;
+} FetchStats;
+
+enum { FETCH_PHASE_DNS, FETCH_PHASE_CONNECT, FETCH_PHASE_TLS, FETCH_PHASE_TTFB, FETCH_PHASE_BODY, FETCH_PHASE_TOTAL,
+       N_FETCH_PHASES };
+static const gchar *const fetch_phase_names[N_FETCH_PHASES] = { "dns", "connect", "tls", "ttfb", "body", "total" };
+
+// Bucket bounds of the histograms below (seconds, or bytes for response_bytes)
+static const gdouble fetch_phase_bounds[] = { 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10 };
+static const gdouble response_bytes_bounds[] = { 1024, 4096, 16384, 65536, 262144, 1048576 };
+static const gdouble main_thread_bounds[] = { 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1 };
+static const gdouble clock_jitter_bounds[] = { 0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.25, 0.5, 1 };
+static const gdouble frame_bounds[] = { 0.001, 0.002, 0.004, 0.008, 0.016, 0.033, 0.066, 0.1, 0.25, 0.5, 1 };
+
+// Distributions for the metrics endpoint; the counters live in FetchStats and RetryEngine
+typedef struct {
+    MetricsHistogram fetch_phase[N_FETCH_PHASES];
+    MetricsHistogram response_bytes;   // Wire size of full (non-304) responses
+    MetricsHistogram parse;            // forecast_parse_batch() on the decode worker
+    MetricsHistogram commit;           // commit_forecast_snapshot(): timezone bookkeeping and widgets
+    MetricsHistogram clock_jitter;     // Distance of each clock tick from its second (or minute) boundary
+    MetricsHistogram frame;            // GdkFrameClock before-paint to after-paint: GTK's CPU time per frame
+} AppHistograms;
+
+// Decoded forecasts for every location, handed from the decode stage to the widgets
+typedef struct _ForecastSnapshot ForecastSnapshot;
+
+// Connection state appended to the data-age badge
+typedef enum {
+    AGE_BADGE_CURRENT,       // Last refresh worked
+    AGE_BADGE_RECONNECTING,  // Failing; the retry engine keeps trying
+    AGE_BADGE_PAUSED         // Circuit breaker open: the service gets a rest
+} AgeBadgeState;
 
 typedef struct {
     GtkWidget *window;
     GtkWidget *settings_window;     // Settings/preferences window
     GtkWidget *clock_label;
     GtkWidget *date_label;
-    GtkWidget *weather_box;
+    GtkWidget *weather_box;          // Holds one strip per location
+    GtkWidget *weather_error_label;  // Overlay on top of the hour cards
+    GtkWidget *age_label;            // "Updated N min ago" badge next to the forecast title
+    gint64 age_badge_minutes;        // Age the badge shows (-1 while hidden)
+    gint age_badge_state;            // AgeBadgeState the badge shows
+    GtkWidget *extra_locations_entry;  // Settings: additional "lat,lon; lat,lon" list
     GtkWidget *lat_entry;
     GtkWidget *lon_entry;
+    GtkWidget *search_entry;         // Settings: place name search
+    GtkWidget *search_results;       // GtkListBox, one row per search_places entry
+    GtkWidget *search_status;        // "Searching...", "No places found" or the last failure
+    GeocodePlace search_places[GEOCODE_MAX_RESULTS];  // Places the result rows show
+    guint n_search_places;
+    PlaceIndex *places;              // Every place found so far (loaded with the settings window)
+    SoupSession *geocode_session;    // Place searches; created on first use
+    GCancellable *geocode_cancellable;  // The search in flight, cancelled when a newer one starts
+    guint geocode_timer_id;          // Debounces searches while typing
+    gboolean places_dirty;           // The index has changes not yet handed to a write
+    guint places_save_timer_id;      // Debounces save_place_index()
+    GBytes *places_writing;          // Contents of the async index write in flight (NULL if none)
+    GCancellable *places_write_cancellable;  // Cancels that write at shutdown
+    gboolean places_save_again;      // The index changed while a write was in flight
     SoupSession *session;
     SoupMessage *pending_message;  // Track pending HTTP request to cancel on exit
+    GCancellable *fetch_cancellable;  // Cancels the pending request and its off-thread decode
+    gchar *validator_url;   // Request URL the validators below belong to
+    gchar *etag;            // ETag of the current forecast's response (NULL if none)
+    gchar *last_modified;   // Last-Modified of the current forecast's response (NULL if none)
+    guint64 last_wire_bytes;  // Compressed size of the last full response
+    FetchStats fetch_stats;
+    AppHistograms histograms;
+    guint metrics_port;          // [Metrics] port on 127.0.0.1; 0 disables the endpoint
+    MetricsServer *metrics_server;
+    guint stall_threshold_ms;    // [Watchdog] stall_ms; 0 disables the main-loop watchdog
+    Watchdog *watchdog;
+    gboolean memory_compact;     // [Memory] compact: fewer malloc arenas, heap trimmed after each refresh
+    guint http_timeout;          // [Network] timeout_seconds
+    guint http_idle_timeout;     // [Network] idle_timeout_seconds
+    gboolean http2;              // [Network] http2; FALSE forces HTTP/1.1
+    guint dns_cache_seconds;     // [Network] dns_cache_seconds; 0 resolves on every refresh
+    gint64 session_created_at;   // Monotonic seconds when data->session (and its DNS cache) was built
+    gboolean session_outdated;   // [Network] settings were reloaded: rebuild before the next request
     GtkCssProvider *css_provider;   // Track CSS provider for cleanup
-    guint clock_timer_id;           // Track clock update timer
+    guint clock_timer_id;           // Track clock update timer (one-shot, re-armed every tick)
+    gboolean clock_low_power;       // Minute-precision clock: "HH:MM" and one wakeup per minute
+    gboolean clock_glyph_cache;     // [Clock] glyph_cache: clock_label is a ClockFace, not a GtkLabel
+                                    // (the minimal render quality uses one regardless)
+    gint64 clock_day;               // Local day number the date label shows (G_MININT64 until set)
+    char clock_text[CLOCK_FACE_MAX_CHARS];  // Text clock_label currently shows
+    GTimeZone *local_tz;            // System zone for the last-resort clock fallback
+    TzTable clock_tz_table;         // Upcoming offsets of the zone the clock shows
+    GTimeZone *clock_tz_table_zone; // Zone clock_tz_table was built from (ref held, NULL if none)
+    gboolean display_suspended;     // Nothing visible: clock ticks and weather polling are paused
+    gboolean screen_blanked;        // Session screensaver reports the screen as blanked
+    GdkSurface *watched_surface;    // Toplevel surface whose state we follow (NULL until realized)
+    GDBusConnection *screensaver_bus;     // Session bus for screensaver ActiveChanged signals
+    guint screensaver_subscriptions[2];  // org.freedesktop / org.gnome ScreenSaver subscriptions
     guint weather_timer_id;         // Track weather update timer
     guint retry_timer_id;           // Track retry timer
-    gchar *location_lat;
-    gchar *location_lon;
+    guint window_timer_id;          // Moves the strips on when the current forecast hour ends
+    guint config_save_timer_id;     // Debounces save_location_to_config()
+    gchar *config_written;          // Config contents last written or loaded (NULL if none)
+    GBytes *config_writing;         // Contents of the async write in flight (NULL if none)
+    GCancellable *config_write_cancellable;  // Cancels that write at shutdown
+    gboolean config_save_again;     // Settings changed while a write was in flight
+    GFileMonitor *config_monitor;   // Reloads the config when something else rewrites it
+    guint config_reload_timer_id;   // Lets a burst of monitor events settle before reading
+    GCancellable *config_read_cancellable;  // Cancels the reload read in flight
+    gint64 startup_started_at;      // Monotonic time main() began, for the startup phase log
+    gint64 startup_phase_at;        // Monotonic time the previous startup phase ended
+    gint64 first_frame_us;          // Launch to first painted frame (0 until painted)
+    GdkFrameClock *first_frame_clock;  // Watched for the first after-paint (NULL once seen)
+    guint services_source_id;       // Pending start_deferred_services() (fallback timeout or idle)
+    gboolean services_started;      // Network and bus services are running
+    LocationStrip locations[MAX_LOCATIONS];
+    guint n_locations;    // Always >= 1; all of them are fetched in a single request
+    guint hours_to_show;  // [Display] hours_to_show, 1..MAX_HOURS_TO_SHOW
+    guint forecast_days;  // [Display] forecast_days: day panels in the extended view, 0 for none
+    gint render_quality;       // [Display] render_quality: a RenderQuality, or RENDER_QUALITY_AUTO
+    guint frame_budget_ms;     // [Display] frame_budget_ms: frames slower than this cost quality
+    QualityGovernor quality;   // Render quality in use, and the frame statistics behind it
+    gint64 frame_started_at;   // Monotonic time of the current frame's before-paint, 0 between frames
     gchar *timezone;  // IANA timezone (e.g., "America/Toronto")
     GTimeZone *tz;    // GTimeZone object for time conversion
+    gint64 forecast_fetched_at;  // Unix time the current forecast was downloaded (0 if none)
+    gboolean shared_fetch;     // Share one upstream fetch with other local instances over D-Bus
+    ForecastBroker *broker;    // Shared-fetch role election (NULL unless shared_fetch)
+    ForecastSnapshot *spare_snapshot;  // Buffers of the forecasts shown before the current ones
     gint utc_offset_seconds;  // UTC offset in seconds (fallback if timezone creation fails)
-    gint retry_count;          // Current retry attempt count
-    gint retry_delay;          // Current retry delay in seconds
-    gboolean is_retrying;      // Flag to indicate if we're in retry mode
+    RetryEngine retry;         // Backoff, error classes and circuit breaker for the weather fetch
+    guint last_http_status;    // Status of the response currently being decoded
+    guint refresh_interval;    // Seconds between scheduled refreshes ([Fetch] interval_minutes)
+    guint refresh_jitter_max;  // Upper bound of the per-device offset ([Fetch] jitter_seconds)
+    guint refresh_offset;      // This device's offset into each refresh slot, from the machine ID
+    gint64 fresh_until;        // Unix time the server said the forecast stays fresh (Cache-Control)
+    gint retry_after;          // Server-requested minimum retry delay in seconds (Retry-After), 0 if none
 } AppData;
 
-// Weather code to description mapping
-static const char* get_weather_description(int code) {
-    if (code == 0) return "Clear";
-    if (code <= 3) return "Cloudy";
-    if (code <= 49) return "Foggy";
-    if (code <= 59) return "Drizzle";
-    if (code <= 69) return "Rain";
-    if (code <= 79) return "Snow";
-    if (code <= 84) return "Rain Shower";
-    if (code <= 86) return "Snow Shower";
-    if (code <= 99) return "Thunderstorm";
-    return "Unknown";
-}
-
-// Weather code to emoji/icon
-static const char* get_weather_icon(int code) {
-    if (code == 0) return "☀️";
-    if (code <= 3) return "⛅";
-    if (code <= 49) return "🌫️";
-    if (code <= 59) return "🌦️";
-    if (code <= 69) return "🌧️";
-    if (code <= 79) return "❄️";
-    if (code <= 84) return "🌦️";
-    if (code <= 86) return "❄️";
-    if (code <= 99) return "⛈️";
-    return "❓";
+// Offset of the displayed zone from UTC at `now`. The IANA zone comes first, so
+// the clock follows DST transitions without waiting for the next fetch; then
+// the API's utc_offset_seconds (works without a tz database, e.g. on Windows,
+// but only changes when a refresh brings a new one); then the system zone.
+// Zone offsets come from a precomputed transition table: a tick does no
+// GTimeZone lookups and no allocations.
+static gint clock_utc_offset(AppData *data, gint64 now) {
+    GTimeZone *tz = data->tz;
+    
+    // g_time_zone_new() hands back UTC for identifiers it can't load. A real UTC
+    // zone can't disagree with a non-zero API offset, so trust the offset then.
+    if (tz && data->utc_offset_seconds != 0 && g_strcmp0(g_time_zone_get_identifier(tz), "UTC") == 0) {
+        tz = NULL;
+    }
+    if (!tz) {
+        if (data->utc_offset_seconds != 0) {
+            return data->utc_offset_seconds;
+        }
+        if (!data->local_tz) {
+            data->local_tz = g_time_zone_new_local();
+        }
+        tz = data->local_tz;
+    }
+    
+    // Rebuilt about once a year, on a zone change, or when the clock steps back
+    if (tz != data->clock_tz_table_zone || !tz_table_covers(&data->clock_tz_table, now)) {
+        tz_table_build(&data->clock_tz_table, tz, now);
+        if (tz != data->clock_tz_table_zone) {
+            if (data->clock_tz_table_zone) {
+                g_time_zone_unref(data->clock_tz_table_zone);
+            }
+            data->clock_tz_table_zone = g_time_zone_ref(tz);
+        }
+        g_debug("Clock: offset table for %s rebuilt, %u transition(s) in the next %" G_GINT64_FORMAT " days",
+                g_time_zone_get_identifier(tz), data->clock_tz_table.n_transitions,
+                (data->clock_tz_table.valid_until - now) / 86400);
+    }
+    return tz_table_lookup(&data->clock_tz_table, now);
+}
+
+// "Updated N min ago", plus the connection state while refreshes fail. Only
+// formats and touches the label when the shown age or state changed, so the
+// clock tick can call it for free.
+static void update_age_badge(AppData *data) {
+    if (!data->age_label) {
+        return;
+    }
+    if (data->forecast_fetched_at <= 0) {
+        if (gtk_widget_get_visible(data->age_label)) {
+            gtk_widget_set_visible(data->age_label, FALSE);
+        }
+        data->age_badge_minutes = -1;
+        return;
+    }
+    
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    gint64 minutes = MAX(now - data->forecast_fetched_at, 0) / 60;
+    AgeBadgeState state = AGE_BADGE_CURRENT;
+    if (data->retry.circuit == RETRY_CIRCUIT_OPEN) {
+        state = AGE_BADGE_PAUSED;
+    } else if (data->retry.consecutive_failures > 0) {
+        state = AGE_BADGE_RECONNECTING;
+    }
+    if (minutes == data->age_badge_minutes && (gint)state == data->age_badge_state) {
+        return;
+    }
+    data->age_badge_minutes = minutes;
+    data->age_badge_state = (gint)state;
+    
+    char text[96];
+    gint length;
+    if (minutes < 1) {
+        length = snprintf(text, sizeof(text), "Updated just now");
+    } else if (minutes < 120) {
+        length = snprintf(text, sizeof(text), "Updated %" G_GINT64_FORMAT " min ago", minutes);
+    } else if (minutes < 48 * 60) {
+        length = snprintf(text, sizeof(text), "Updated %" G_GINT64_FORMAT " h ago", minutes / 60);
+    } else {
+        length = snprintf(text, sizeof(text), "Updated %" G_GINT64_FORMAT " days ago", minutes / (24 * 60));
+    }
+    if (state != AGE_BADGE_CURRENT && length > 0 && (gsize)length < sizeof(text)) {
+        g_strlcat(text, state == AGE_BADGE_PAUSED ? " · service unavailable" : " · reconnecting", sizeof(text));
+    }
+    gtk_label_set_text(GTK_LABEL(data->age_label), text);
+    if (state == AGE_BADGE_CURRENT) {
+        gtk_widget_remove_css_class(data->age_label, "weather-age-stale");
+    } else {
+        gtk_widget_add_css_class(data->age_label, "weather-age-stale");
+    }
+    if (!gtk_widget_get_visible(data->age_label)) {
+        gtk_widget_set_visible(data->age_label, TRUE);
+    }
 }
 
+// Per tick this only formats into data->clock_text and touches the clock label
+// when its text changed; the date label is formatted once per local day.
 static void update_clock(AppData *data) {
     if (!data || !data->clock_label || !data->date_label) {
         return;
     }
     
-    // Verify widgets are valid GTK objects and actually labels before casting
+    // Verify widgets are valid GTK objects of the expected kind before casting
     if (!GTK_IS_WIDGET(data->clock_label) || !GTK_IS_WIDGET(data->date_label)) {
         return;
     }
-    if (!GTK_IS_LABEL(data->clock_label) || !GTK_IS_LABEL(data->date_label)) {
+    gboolean clock_is_face = CLOCK_IS_FACE(data->clock_label);
+    if ((!clock_is_face && !GTK_IS_LABEL(data->clock_label)) || !GTK_IS_LABEL(data->date_label)) {
         return;
     }
     
@@ -88,191 +333,462 @@ static void update_clock(AppData *data) {
         return;
     }
     
-    time_t now = time(NULL);
-    if (now == (time_t)-1) {
-        return; // time() failed
-    }
-    
-    GDateTime *dt = NULL;
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    gint64 local = now + clock_utc_offset(data, now);
+    gint64 day = local >= 0 ? local / 86400 : (local - 86399) / 86400;
+    gint64 second_of_day = local - day * 86400;
     
-    // PRIORITY 1: Use UTC offset (most reliable on Windows deployments)
-    // The utc_offset_seconds comes directly from the weather API and doesn't
-    // depend on having timezone database files installed
-    if (data->utc_offset_seconds != 0) {
-        // Convert UTC time to local by adding the offset
-        // For GMT-5: offset = -18000 seconds, so we subtract 5 hours from UTC
-        time_t adjusted_time = now + data->utc_offset_seconds;
-        dt = g_date_time_new_from_unix_utc(adjusted_time);
+    char time_str[sizeof(data->clock_text)];
+    int hour = (int)(second_of_day / 3600);
+    int minute = (int)(second_of_day / 60 % 60);
+    if (data->clock_low_power) {
+        snprintf(time_str, sizeof(time_str), "%02d:%02d", hour, minute);
+    } else {
+        snprintf(time_str, sizeof(time_str), "%02d:%02d:%02d", hour, minute, (int)(second_of_day % 60));
+    }
+    if (strcmp(time_str, data->clock_text) != 0) {
+        memcpy(data->clock_text, time_str, sizeof(data->clock_text));
+        if (clock_is_face) {
+            clock_face_set_text(CLOCK_FACE(data->clock_label), data->clock_text);
+        } else {
+            gtk_label_set_text(GTK_LABEL(data->clock_label), data->clock_text);
+        }
     }
-    // PRIORITY 2: Try GTimeZone object (may not work on Windows without tz database)
-    else if (data->tz) {
-        dt = g_date_time_new_from_unix_utc(now);
+    
+    if (day != data->clock_day) {
+        // Local wall time expressed as UTC, so formatting needs no zone lookup
+        GDateTime *dt = g_date_time_new_from_unix_utc(local);
+        gchar *date_str = dt ? g_date_time_format(dt, "%A, %B %d, %Y") : NULL;
+        if (date_str) {
+            gtk_label_set_text(GTK_LABEL(data->date_label), date_str);
+            data->clock_day = day;
+        }
+        g_free(date_str);
         if (dt) {
-            GDateTime *dt_tz = g_date_time_to_timezone(dt, data->tz);
             g_date_time_unref(dt);
-            dt = dt_tz;
         }
     }
-    // PRIORITY 3: Fallback to system local time
-    else {
-        dt = g_date_time_new_from_unix_local(now);
-    }
     
-    if (!dt) {
+    update_age_badge(data);
+}
+
+// Milliseconds until just after the next wall-clock second (or minute in
+// low-power mode). Recomputed every tick, so coalescing, clock steps and
+// suspend never accumulate drift.
+static guint clock_tick_delay_ms(AppData *data) {
+    gint64 period = (data->clock_low_power ? 60 : 1) * G_USEC_PER_SEC;
+    gint64 now = g_get_real_time();
+    gint64 remaining = period - ((now % period) + period) % period;
+    return (guint)(remaining / 1000) + CLOCK_TICK_SLACK_MS;
+}
+
+// Forward declarations
+static void save_location_to_config(AppData *data);
+static void forecast_refreshed(AppData *data);
+static void start_forecast_broker(AppData *data);
+static void create_settings_window(AppData *data);
+static gboolean update_clock_callback(gpointer user_data);
+
+// TRUE when g_debug() output actually goes somewhere (G_MESSAGES_DEBUG is set).
+// Used to skip building debug-only strings on the hot path.
+static gboolean debug_logging_enabled(void) {
+    return !g_log_writer_default_would_drop(G_LOG_LEVEL_DEBUG, G_LOG_DOMAIN);
+}
+
+static WeatherStripStyle strip_style(AppData *data) {
+    switch (data->quality.quality) {
+    case RENDER_QUALITY_FLAT:
+        return WEATHER_STRIP_STYLE_FLAT;
+    case RENDER_QUALITY_MINIMAL:
+        return WEATHER_STRIP_STYLE_BARE;
+    default:
+        return WEATHER_STRIP_STYLE_ROUNDED;
+    }
+}
+
+// Build the strip pool inside data->weather_box: MAX_LOCATIONS strips, each a
+// title label above a WeatherStrip that draws the hour cards
+static void create_location_strips(AppData *data) {
+    for (guint i = 0; i < MAX_LOCATIONS; i++) {
+        LocationStrip *location = &data->locations[i];
+        
+        location->strip = gtk_box_new(GTK_ORIENTATION_VERTICAL, 2);
+        
+        location->title_label = gtk_label_new("");
+        gtk_widget_add_css_class(location->title_label, "weather-location");
+        gtk_widget_set_halign(location->title_label, GTK_ALIGN_START);
+        gtk_widget_set_visible(location->title_label, FALSE);
+        gtk_box_append(GTK_BOX(location->strip), location->title_label);
+        
+        location->hours_view = weather_strip_new(data->hours_to_show, data->forecast_days);
+        gtk_widget_add_css_class(location->hours_view, "weather-container");
+        gtk_widget_set_halign(location->hours_view, GTK_ALIGN_CENTER);
+        weather_strip_set_style(WEATHER_STRIP(location->hours_view), strip_style(data));
+        if (data->hours_to_show > DEFAULT_HOURS_TO_SHOW || data->forecast_days > 0) {
+            // Longer strips than the window is wide scroll sideways
+            GtkWidget *scroller = gtk_scrolled_window_new();
+            gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scroller), GTK_POLICY_AUTOMATIC, GTK_POLICY_NEVER);
+            gtk_scrolled_window_set_propagate_natural_height(GTK_SCROLLED_WINDOW(scroller), TRUE);
+            gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scroller), location->hours_view);
+            gtk_box_append(GTK_BOX(location->strip), scroller);
+        } else {
+            gtk_box_append(GTK_BOX(location->strip), location->hours_view);
+        }
+        
+        gtk_widget_set_visible(location->strip, FALSE);
+        gtk_box_append(GTK_BOX(data->weather_box), location->strip);
+    }
+}
+
+// Error state is an overlay on top of the retained cards rather than a rebuild;
+// whatever was shown underneath is dimmed, not destroyed.
+static void show_weather_overlay(AppData *data, const gchar *message) {
+    if (!data->weather_error_label) {
         return;
     }
-    
-    gchar *time_str = g_date_time_format(dt, "%H:%M:%S");
-    gchar *date_str = g_date_time_format(dt, "%A, %B %d, %Y");
-    
-    if (time_str) {
-        gtk_label_set_text(GTK_LABEL(data->clock_label), time_str);
-        g_free(time_str);
+    gtk_label_set_text(GTK_LABEL(data->weather_error_label), message);
+    if (!gtk_widget_get_visible(data->weather_error_label)) {
+        gtk_widget_set_visible(data->weather_error_label, TRUE);
+        gtk_widget_add_css_class(data->weather_box, "weather-dimmed");
     }
-    if (date_str) {
-        gtk_label_set_text(GTK_LABEL(data->date_label), date_str);
-        g_free(date_str);
+}
+
+static void hide_weather_overlay(AppData *data) {
+    if (data->weather_error_label && gtk_widget_get_visible(data->weather_error_label)) {
+        gtk_widget_set_visible(data->weather_error_label, FALSE);
+        gtk_widget_remove_css_class(data->weather_box, "weather-dimmed");
     }
-    
-    g_date_time_unref(dt);
 }
 
-// Forward declarations
-static void save_location_to_config(AppData *data);
+// Immutable result of the off-thread decode stage. Built by decode_forecast_thread()
+// and only read on the main thread after GTask hands it over.
+// One forecast per location of the batch, in request order.
+struct _ForecastSnapshot {
+    WeatherForecast *forecasts[MAX_LOCATIONS];
+    guint n_forecasts;
+    ForecastParseResult result;
+    gint64 parse_us;                   // Time forecast_parse_batch() took, 0 for cached snapshots
+    guint start_index[MAX_LOCATIONS];  // First hour >= the current local hour at decode time
+    gchar error_msg[FORECAST_ERROR_MAX];
+};
 
-// Returns TRUE on success, FALSE on failure (caller should retry)
-static gboolean parse_weather_json(const char *json_data_str, AppData *data) {
-    if (!data || !data->weather_box) {
-        return FALSE;
+static ForecastSnapshot* forecast_snapshot_new(guint n_forecasts) {
+    ForecastSnapshot *snapshot = g_new0(ForecastSnapshot, 1);
+    snapshot->n_forecasts = MIN(n_forecasts, MAX_LOCATIONS);
+    for (guint i = 0; i < snapshot->n_forecasts; i++) {
+        snapshot->forecasts[i] = forecast_new();
     }
-    
-    // Verify weather_box is a valid box widget
-    if (!GTK_IS_BOX(data->weather_box)) {
-        return FALSE;
+    return snapshot;
+}
+
+static void forecast_snapshot_free(gpointer user_data) {
+    ForecastSnapshot *snapshot = (ForecastSnapshot *)user_data;
+    if (!snapshot) {
+        return;
     }
-    
-    // Clear existing weather widgets
-    GtkWidget *child;
-    while ((child = gtk_widget_get_first_child(data->weather_box))) {
-        gtk_box_remove(GTK_BOX(data->weather_box), child);
-        // Widget is automatically unparented and will be destroyed when last reference drops
-        // GTK widgets use reference counting, so explicit unref is usually not needed
-        // but we can add it for extra safety if needed
+    for (guint i = 0; i < MAX_LOCATIONS; i++) {
+        forecast_free(snapshot->forecasts[i]);
     }
-    
-    if (!json_data_str || strlen(json_data_str) == 0) {
-        GtkWidget *error_label = gtk_label_new("Empty weather data received");
-        gtk_widget_add_css_class(error_label, "error-text");
-        gtk_box_append(GTK_BOX(data->weather_box), error_label);
-        return FALSE;  // Should retry
+    g_free(snapshot);
+}
+
+// Snapshots are double-buffered. Committing one swaps its forecasts with the
+// ones on screen, so it comes back holding the previous forecasts, and it is
+// kept as data->spare_snapshot. The next decode writes into those buffers:
+// once they have grown to the forecast's size, a refresh allocates and frees
+// no forecast memory, and the long-lived blocks stay where they are.
+static ForecastSnapshot* take_snapshot(AppData *data, guint n_forecasts) {
+    ForecastSnapshot *snapshot = data->spare_snapshot;
+    if (!snapshot) {
+        return forecast_snapshot_new(n_forecasts);
     }
-    
-    // Check if response looks like HTML (API returned error page instead of JSON)
-    if (json_data_str[0] == '<') {
-        g_warning("API returned HTML instead of JSON (likely server error)");
-        GtkWidget *error_label = gtk_label_new("Server returned error page - retrying...");
-        gtk_widget_add_css_class(error_label, "error-text");
-        gtk_box_append(GTK_BOX(data->weather_box), error_label);
-        return FALSE;  // Should retry
+    data->spare_snapshot = NULL;
+    
+    snapshot->n_forecasts = MIN(n_forecasts, MAX_LOCATIONS);
+    snapshot->result = FORECAST_PARSE_OK;
+    snapshot->parse_us = 0;
+    snapshot->error_msg[0] = '\0';
+    memset(snapshot->start_index, 0, sizeof(snapshot->start_index));
+    for (guint i = 0; i < snapshot->n_forecasts; i++) {
+        if (snapshot->forecasts[i]) {
+            forecast_clear(snapshot->forecasts[i]);
+        } else {
+            snapshot->forecasts[i] = forecast_new();
+        }
     }
-    
-    // Debug: show first part of response
-    g_debug("JSON response length: %zu", strlen(json_data_str));
-    if (strlen(json_data_str) < 500) {
-        g_debug("Full JSON: %s", json_data_str);
+    return snapshot;
+}
+
+// Done with a snapshot on the main thread: keep its buffers for the next one
+static void release_snapshot(AppData *data, ForecastSnapshot *snapshot) {
+    if (!snapshot) {
+        return;
+    }
+    if (data->spare_snapshot || !data->session) {
+        forecast_snapshot_free(snapshot);
     } else {
-        gchar *preview = g_strndup(json_data_str, 500);
-        if (preview) {
-            g_debug("JSON preview: %s...", preview);
-            g_free(preview);
+        data->spare_snapshot = snapshot;
+    }
+}
+
+// What the decode worker needs: the shared response body, the batch size and
+// the snapshot to decode into (handed back through the task)
+typedef struct {
+    GBytes *body;
+    guint n_locations;
+    ForecastSnapshot *snapshot;
+} DecodeRequest;
+
+static void decode_request_free(gpointer user_data) {
+    DecodeRequest *request = (DecodeRequest *)user_data;
+    g_bytes_unref(request->body);
+    forecast_snapshot_free(request->snapshot);
+    g_free(request);
+}
+
+// Find the hour in progress at the forecast location (or the next one), so the
+// current hour shows even if it's partially passed. Binary search over the
+// epoch times resolved at parse time; safe on the decode worker thread.
+static guint find_start_index(const WeatherForecast *forecast) {
+    guint index = forecast_find_hour(forecast, g_get_real_time() / G_USEC_PER_SEC);
+    return index < forecast->n_hours ? index : 0;
+}
+
+// Worker thread: decode and normalize the response body into a snapshot.
+// Must not touch AppData or any widget.
+static void decode_forecast_thread(GTask *task, gpointer source_object, gpointer task_data,
+                                   GCancellable *cancellable) {
+    (void)source_object;
+    (void)cancellable;
+    DecodeRequest *request = (DecodeRequest *)task_data;
+    
+    gsize length = 0;
+    const gchar *json_data = g_bytes_get_data(request->body, &length);
+    
+    ForecastSnapshot *snapshot = request->snapshot;
+    request->snapshot = NULL;
+    gint64 parse_start = g_get_monotonic_time();
+    snapshot->result = forecast_parse_batch(snapshot->forecasts, snapshot->n_forecasts, json_data, length,
+                                            snapshot->error_msg, sizeof(snapshot->error_msg));
+    snapshot->parse_us = g_get_monotonic_time() - parse_start;
+    if (snapshot->result == FORECAST_PARSE_OK) {
+        for (guint i = 0; i < snapshot->n_forecasts; i++) {
+            snapshot->start_index[i] = find_start_index(snapshot->forecasts[i]);
         }
     }
     
-    JsonParser *parser = json_parser_new();
-    GError *error = NULL;
-    
-    if (!json_parser_load_from_data(parser, json_data_str, -1, &error)) {
-        char error_msg[512];
-        snprintf(error_msg, sizeof(error_msg), "Parse error: %s - retrying...", error ? error->message : "Unknown");
-        g_warning("JSON parse error: %s", error ? error->message : "Unknown");
-        GtkWidget *error_label = gtk_label_new(error_msg);
-        gtk_widget_add_css_class(error_label, "error-text");
-        gtk_box_append(GTK_BOX(data->weather_box), error_label);
-        if (error) g_error_free(error);
-        g_object_unref(parser);
-        return FALSE;  // Should retry - likely server returned invalid data
+    g_task_return_pointer(task, snapshot, forecast_snapshot_free);
+}
+
+// Show a location's forecast from start_index on, even if we need to go into
+// the next day, and its day panels from the day of that hour on. The strip
+// redraws only when what it shows changed.
+static void render_location(LocationStrip *location, guint start_index) {
+    if (!location->forecast || !location->hours_view) {
+        return;
+    }
+    weather_strip_set_forecast(WEATHER_STRIP(location->hours_view), location->forecast, start_index);
+    if (location->daily && start_index < location->forecast->n_hours) {
+        gint32 today = forecast_day_of_hours(location->forecast->hours[start_index]);
+        guint first = forecast_daily_find_day(location->daily, today);
+        weather_strip_set_days(WEATHER_STRIP(location->hours_view), location->daily->days + first,
+                               location->daily->n_days - first);
+    }
+}
+
+// Bring a location's day panels up to date with its forecast. Days whose hours
+// are unchanged (e.g. the ones a 304 or a cached reload brings back) keep
+// their aggregates.
+static void update_daily_aggregates(AppData *data, LocationStrip *location) {
+    if (data->forecast_days == 0 || !location->forecast) {
+        return;
+    }
+    if (!location->daily) {
+        location->daily = forecast_daily_new();
+    }
+    guint recomputed = forecast_daily_update(location->daily, location->forecast);
+    g_debug("Daily aggregates: %u of %u day(s) recomputed", recomputed, location->daily->n_days);
+}
+
+// TRUE once every configured location has a forecast to show
+static gboolean have_all_forecasts(AppData *data) {
+    for (guint i = 0; i < data->n_locations; i++) {
+        if (!data->locations[i].forecast) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// TRUE when every location has a forecast that still covers the hour in
+// progress, i.e. there is something worth showing while refreshes fail
+static gboolean have_current_forecasts(AppData *data) {
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    for (guint i = 0; i < data->n_locations; i++) {
+        const WeatherForecast *forecast = data->locations[i].forecast;
+        if (!forecast || forecast_find_hour(forecast, now) >= forecast->n_hours) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// Seconds until the hour in progress ends at any location (zones differ by
+// half and quarter hours), 0 if no forecast has an hour left to move on to
+static guint seconds_until_window_advance(AppData *data) {
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    gint64 next = G_MAXINT64;
+    for (guint i = 0; i < data->n_locations; i++) {
+        const WeatherForecast *forecast = data->locations[i].forecast;
+        if (!forecast) {
+            continue;
+        }
+        guint index = forecast_find_hour(forecast, now);
+        if (index < forecast->n_hours) {
+            next = MIN(next, forecast->times[index] + 3600);
+        }
+    }
+    if (next == G_MAXINT64) {
+        return 0;
+    }
+    return (guint)CLAMP(next - now, 1, 3600) + 1;  // Just past the boundary
+}
+
+static gboolean advance_window_callback(gpointer user_data);
+
+// (Re)arm the one-shot that advances the strips at the next hour boundary.
+// The forecast already covers the coming hours, so moving the window on is a
+// local re-render; fetches are only for fresher data.
+static void schedule_window_advance(AppData *data) {
+    if (data->window_timer_id != 0) {
+        g_source_remove(data->window_timer_id);
+        data->window_timer_id = 0;
+    }
+    if (data->display_suspended) {
+        return;  // Resuming re-renders and re-arms
+    }
+    guint delay = seconds_until_window_advance(data);
+    if (delay > 0) {
+        data->window_timer_id = g_timeout_add_seconds(delay, advance_window_callback, data);
+    }
+}
+
+// Re-render every strip from its current forecast, starting at the current hour
+static void render_all_locations(AppData *data) {
+    for (guint i = 0; i < data->n_locations; i++) {
+        if (data->locations[i].forecast) {
+            render_location(&data->locations[i], find_start_index(data->locations[i].forecast));
+        }
+    }
+    schedule_window_advance(data);
+}
+
+static gboolean advance_window_callback(gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    if (!data || !data->session) {
+        return G_SOURCE_REMOVE;
     }
     
-    JsonNode *root = json_parser_get_root(parser);
-    if (!root) {
-        GtkWidget *error_label = gtk_label_new("Invalid JSON: no root node - retrying...");
-        gtk_widget_add_css_class(error_label, "error-text");
-        gtk_box_append(GTK_BOX(data->weather_box), error_label);
-        g_object_unref(parser);
-        return FALSE;  // Should retry
+    // This one-shot timer is done; render_all_locations() arms the next one
+    data->window_timer_id = 0;
+    const gchar *previous_activity = watchdog_begin("window advance");
+    render_all_locations(data);
+    watchdog_end(previous_activity);
+    return G_SOURCE_REMOVE;
+}
+
+// Show the strips in use, hide the rest, and label each one when there are
+// several. Forecasts of locations that are no longer configured are dropped.
+static void sync_location_strips(AppData *data) {
+    gboolean titled = data->n_locations > 1;
+    for (guint i = 0; i < MAX_LOCATIONS; i++) {
+        LocationStrip *location = &data->locations[i];
+        if (!location->strip) {
+            continue;
+        }
+        gboolean used = i < data->n_locations;
+        if (!used && location->forecast) {
+            forecast_free(location->forecast);
+            location->forecast = NULL;
+        }
+        if (gtk_widget_get_visible(location->strip) != used) {
+            gtk_widget_set_visible(location->strip, used);
+        }
+        if (!used) {
+            continue;
+        }
+        
+        // The forecast's IANA zone reads better than coordinates: "America/New_York" -> "New York"
+        gchar *title = NULL;
+        const gchar *tz_name = location->forecast ? location->forecast->timezone : "";
+        const gchar *city = strrchr(tz_name, '/');
+        if (city && city[1] != '\0') {
+            title = g_strdup(city + 1);
+            g_strdelimit(title, "_", ' ');
+        } else {
+            title = g_strdup_printf("%s, %s", location->lat ? location->lat : "?", location->lon ? location->lon : "?");
+        }
+        // Refreshes mostly bring the same titles back; leave the label alone then
+        if (strcmp(gtk_label_get_text(GTK_LABEL(location->title_label)), title) != 0) {
+            gtk_label_set_text(GTK_LABEL(location->title_label), title);
+        }
+        g_free(title);
+        gtk_widget_set_visible(location->title_label, titled);
+    }
+}
+
+// Main-thread commit of a decoded snapshot: timezone bookkeeping and widgets only.
+// Returns TRUE on success, FALSE on failure (caller should retry)
+static gboolean commit_forecast_snapshot(AppData *data, ForecastSnapshot *snapshot) {
+    if (!data || !data->weather_box || !snapshot || snapshot->n_forecasts == 0) {
+        return FALSE;
     }
     
-    JsonObject *root_obj = json_node_get_object(root);
-    if (!root_obj) {
-        GtkWidget *error_label = gtk_label_new("Invalid weather data format - retrying...");
-        gtk_widget_add_css_class(error_label, "error-text");
-        gtk_box_append(GTK_BOX(data->weather_box), error_label);
-        g_object_unref(parser);
-        return FALSE;  // Should retry
+    // A batch for a different set of locations (changed while it was in flight) is stale
+    if (snapshot->n_forecasts != data->n_locations) {
+        return FALSE;
     }
+    gint64 commit_start = g_get_monotonic_time();
+    const gchar *previous_activity = watchdog_begin("forecast commit");
+    
+    // The primary location's timezone is the clock's timezone
+    WeatherForecast *forecast = snapshot->forecasts[0];
     
     // Extract timezone from API response
-    if (json_object_has_member(root_obj, "timezone")) {
-        JsonNode *tz_node = json_object_get_member(root_obj, "timezone");
-        const gchar *tz_str = json_node_get_string(tz_node);
-        if (tz_str && strlen(tz_str) > 0) {
-            // Update timezone
-            if (data->tz) {
-                g_time_zone_unref(data->tz);
-                data->tz = NULL;
-            }
-            g_free(data->timezone);
-            data->timezone = g_strdup(tz_str);
-            data->tz = g_time_zone_new_identifier(tz_str);
+    if (forecast->timezone[0] != '\0') {
+        const gchar *tz_str = forecast->timezone;
+        // Update timezone
+        if (data->tz) {
+            g_time_zone_unref(data->tz);
+            data->tz = NULL;
+        }
+        g_free(data->timezone);
+        data->timezone = g_strdup(tz_str);
+        data->tz = g_time_zone_new_identifier(tz_str);
+        if (!data->tz) {
+            // Fallback: try the deprecated function (might work on some systems)
+            // Suppress deprecation warning since this is an intentional fallback
+            G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+            data->tz = g_time_zone_new(tz_str);
+            G_GNUC_END_IGNORE_DEPRECATIONS
             if (!data->tz) {
-                // Fallback: try the deprecated function (might work on some systems)
-                // Suppress deprecation warning since this is an intentional fallback
-                G_GNUC_BEGIN_IGNORE_DEPRECATIONS
-                data->tz = g_time_zone_new(tz_str);
-                G_GNUC_END_IGNORE_DEPRECATIONS
-                if (!data->tz) {
-                    // This is expected on Windows - IANA timezone database is not available
-                    // The UTC offset fallback will be used instead (which is equally accurate)
-                    g_debug("Timezone '%s' not available (normal on Windows), using UTC offset", tz_str);
-                } else {
-                    g_info("Using timezone: %s", tz_str);
-                    save_location_to_config(data);
-                }
+                // This is expected on Windows - IANA timezone database is not available
+                // The UTC offset fallback will be used instead (which is equally accurate)
+                g_debug("Timezone '%s' not available (normal on Windows), using UTC offset", tz_str);
             } else {
                 g_info("Using timezone: %s", tz_str);
-                // Save timezone to config
                 save_location_to_config(data);
             }
+        } else {
+            g_info("Using timezone: %s", tz_str);
+            // Save timezone to config
+            save_location_to_config(data);
         }
     }
     
     // Extract UTC offset as fallback (in seconds)
-    if (json_object_has_member(root_obj, "utc_offset_seconds")) {
-        JsonNode *offset_node = json_object_get_member(root_obj, "utc_offset_seconds");
-        GType offset_type = json_node_get_value_type(offset_node);
-        
-        gint new_offset = 0;
-        // Handle different numeric types the API might return
-        if (offset_type == G_TYPE_INT64) {
-            gint64 offset = json_node_get_int(offset_node);
-            new_offset = (gint)offset;
-        } else if (offset_type == G_TYPE_DOUBLE) {
-            gdouble offset = json_node_get_double(offset_node);
-            new_offset = (gint)offset;
-        } else if (JSON_NODE_HOLDS_VALUE(offset_node)) {
-            // Try to get as int anyway
-            new_offset = (gint)json_node_get_int(offset_node);
-        }
+    if (forecast->has_utc_offset) {
+        gint new_offset = forecast->utc_offset_seconds;
         
         // Only log and save if the offset changed (e.g., DST transition)
         if (new_offset != data->utc_offset_seconds) {
@@ -294,362 +810,320 @@ static gboolean parse_weather_json(const char *json_data_str, AppData *data) {
         }
     }
     
-    // Check for API errors first - Open-Meteo returns "error" as boolean or "reason" as string
-    if (json_object_has_member(root_obj, "error")) {
-        JsonNode *error_node = json_object_get_member(root_obj, "error");
-        const gchar *error_msg = NULL;
-        
-        // Show all available keys for debugging first
-        GList *members_list = json_object_get_members(root_obj);
-        GString *keys_str = g_string_new("");
-        GList *iter;
-        for (iter = members_list; iter != NULL; iter = iter->next) {
-            if (keys_str->len > 0) {
-                g_string_append(keys_str, ", ");
-            }
-            g_string_append(keys_str, (const gchar *)iter->data);
-        }
-        
-        // Check if error is true/false boolean
-        GType error_type = json_node_get_value_type(error_node);
-        if (error_type == G_TYPE_BOOLEAN) {
-            gboolean error_bool = json_node_get_boolean(error_node);
-            if (error_bool) {
-                // Error is true, check for reason field
-                if (json_object_has_member(root_obj, "reason")) {
-                    JsonNode *reason_node = json_object_get_member(root_obj, "reason");
-                    error_msg = json_node_get_string(reason_node);
-                } else {
-                    error_msg = "API returned error=true but no reason field";
-                }
-            } else {
-                error_msg = "API returned error=false (should not happen)";
-            }
-        } else if (error_type == G_TYPE_STRING) {
-            // Error is a string
-            error_msg = json_node_get_string(error_node);
-        } else {
-            // Unknown error type - set to NULL, we'll format it directly below
-            error_msg = NULL;
-        }
-        
-        char error_text[512];
-        if (error_msg) {
-            snprintf(error_text, sizeof(error_text), "API Error: %s (Keys: %s)", error_msg, keys_str->str);
-        } else if (error_type != G_TYPE_BOOLEAN && error_type != G_TYPE_STRING) {
-            // Format unknown error type directly into error_text
-            snprintf(error_text, sizeof(error_text), "API Error: Error type: %s (Keys: %s)", 
-                     g_type_name(error_type), keys_str->str);
-        } else {
-            snprintf(error_text, sizeof(error_text), "API Error: Unknown (Keys: %s)", keys_str->str);
-        }
-        
-        GtkWidget *error_label = gtk_label_new(error_text);
-        gtk_widget_add_css_class(error_label, "error-text");
-        gtk_box_append(GTK_BOX(data->weather_box), error_label);
-        
-        g_string_free(keys_str, TRUE);
-        g_list_free(members_list);
-        g_object_unref(parser);
-        return TRUE;  // API error (e.g., bad location) - don't retry, user needs to fix
-    }
-    
-    if (!json_object_has_member(root_obj, "hourly")) {
-        // Debug: print all keys in root object
-        GList *members_list = json_object_get_members(root_obj);
-        GString *members_str = g_string_new("");
-        GList *iter;
-        for (iter = members_list; iter != NULL; iter = iter->next) {
-            if (members_str->len > 0) {
-                g_string_append(members_str, ", ");
-            }
-            g_string_append(members_str, (const gchar *)iter->data);
-        }
-        g_warning("No 'hourly' key found. Available keys: %s", members_str->str);
-        
-        char error_msg[512];
-        snprintf(error_msg, sizeof(error_msg), "No hourly data - retrying... Keys: %s", members_str->str);
-        GtkWidget *error_label = gtk_label_new(error_msg);
-        gtk_widget_add_css_class(error_label, "error-text");
-        gtk_box_append(GTK_BOX(data->weather_box), error_label);
-        
-        g_string_free(members_str, TRUE);
-        g_list_free(members_list);
-        g_object_unref(parser);
-        return FALSE;  // Should retry - server may have returned partial data
-    }
-    
-    JsonObject *hourly = json_object_get_object_member(root_obj, "hourly");
-    if (!hourly) {
-        GtkWidget *error_label = gtk_label_new("No hourly data available - retrying...");
-        gtk_widget_add_css_class(error_label, "error-text");
-        gtk_box_append(GTK_BOX(data->weather_box), error_label);
-        g_object_unref(parser);
-        return FALSE;  // Should retry
-    }
-    
-    JsonArray *time_array = json_object_get_array_member(hourly, "time");
-    JsonArray *temp_array = json_object_get_array_member(hourly, "temperature_2m");
-    JsonArray *code_array = json_object_get_array_member(hourly, "weathercode");
-    
-    if (!time_array || !temp_array || !code_array) {
-        GtkWidget *error_label = gtk_label_new("Incomplete weather data - retrying...");
-        gtk_widget_add_css_class(error_label, "error-text");
-        gtk_box_append(GTK_BOX(data->weather_box), error_label);
-        g_object_unref(parser);
-        return FALSE;  // Should retry
-    }
-    
-    guint array_length = json_array_get_length(time_array);
-    const guint hours_to_show = 6;  // Always show 6 hours
-    
-    // Get current time to find the starting hour
-    int start_index = 0;
-    time_t now = time(NULL);
-    if (now != (time_t)-1) {
-        struct tm *tm_info = localtime(&now);
-        if (tm_info) {
-            int current_year = tm_info->tm_year + 1900;
-            int current_month = tm_info->tm_mon + 1;
-            int current_day = tm_info->tm_mday;
-            int current_hour = tm_info->tm_hour;
-            
-            // Find the first hour >= current hour (same day or next day)
-            for (guint i = 0; i < array_length; i++) {
-                JsonNode *time_node = json_array_get_element(time_array, i);
-                if (!time_node) {
-                    continue;
-                }
-                
-                const gchar *time_str = json_node_get_string(time_node);
-                
-                if (time_str && strlen(time_str) >= 16) {
-                    // Parse date and time: "YYYY-MM-DDTHH:MM" format
-                    int year = atoi(time_str);
-                    int month = atoi(time_str + 5);
-                    int day = atoi(time_str + 8);
-                    int hour = atoi(time_str + 11);
-                    
-                    // Find the current hour (or next hour if we've passed it)
-                    // We want to start from the current hour and show 6 hours total
-                    gboolean is_current_or_future = FALSE;
-                    
-                    if (year > current_year) {
-                        is_current_or_future = TRUE;
-                    } else if (year == current_year && month > current_month) {
-                        is_current_or_future = TRUE;
-                    } else if (year == current_year && month == current_month && day > current_day) {
-                        is_current_or_future = TRUE;
-                    } else if (year == current_year && month == current_month && day == current_day) {
-                        // Same day: start from current hour (hour >= current_hour)
-                        // This ensures we show the current hour even if it's partially passed
-                        if (hour >= current_hour) {
-                            is_current_or_future = TRUE;
-                        }
-                    }
-                    
-                    if (is_current_or_future) {
-                        start_index = i;
-                        break;
-                    }
-                }
-            }
-        }
+    if (snapshot->result != FORECAST_PARSE_OK) {
+        show_weather_overlay(data, snapshot->error_msg);
+        watchdog_end(previous_activity);
+        // API error (e.g., bad location) - don't retry, user needs to fix
+        return snapshot->result == FORECAST_PARSE_API_ERROR;
     }
     
-    // Create weather display widgets for next 6 hours
-    // Always show exactly 6 hours, even if we need to go into the next day
-    for (guint i = 0; i < hours_to_show && (start_index + i) < array_length; i++) {
-        guint idx = start_index + i;
-        
-        // Bounds check (defensive programming)
-        if (idx >= array_length) {
-            break;
-        }
-        
-        JsonNode *time_node = json_array_get_element(time_array, idx);
-        JsonNode *temp_node = json_array_get_element(temp_array, idx);
-        JsonNode *code_node = json_array_get_element(code_array, idx);
-        
-        if (!time_node || !temp_node || !code_node) continue;
-        
-        const gchar *time_str = json_node_get_string(time_node);
-        if (!time_str) {
-            continue; // Skip invalid time
-        }
-        
-        gdouble temp = 0.0;
-        if (json_node_get_value_type(temp_node) == G_TYPE_DOUBLE) {
-            temp = json_node_get_double(temp_node);
-        } else if (json_node_get_value_type(temp_node) == G_TYPE_INT64) {
-            temp = (gdouble)json_node_get_int(temp_node);
-        }
-        
-        gint64 code = 0;
-        if (json_node_get_value_type(code_node) == G_TYPE_INT64) {
-            code = json_node_get_int(code_node);
-        } else if (json_node_get_value_type(code_node) == G_TYPE_DOUBLE) {
-            code = (gint64)json_node_get_double(code_node);
-        }
-        
-        GtkWidget *hour_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
-        gtk_widget_add_css_class(hour_box, "weather-hour");
-        
-        // Time label (extract hour from ISO time string)
-        char hour_str[8];
-        if (time_str && strlen(time_str) >= 13) {
-            snprintf(hour_str, sizeof(hour_str), "%.2s:00", time_str + 11);
-            hour_str[7] = '\0'; // Ensure null termination
-        } else {
-            strncpy(hour_str, "N/A", sizeof(hour_str) - 1);
-            hour_str[sizeof(hour_str) - 1] = '\0';
-        }
-        
-        GtkWidget *time_label = gtk_label_new(hour_str);
-        gtk_widget_add_css_class(time_label, "weather-time");
-        gtk_box_append(GTK_BOX(hour_box), time_label);
-        
-        // Weather icon
-        GtkWidget *icon_label = gtk_label_new(get_weather_icon((int)code));
-        gtk_widget_add_css_class(icon_label, "weather-icon");
-        gtk_label_set_xalign(GTK_LABEL(icon_label), 0.5); // Center horizontally
-        gtk_box_append(GTK_BOX(hour_box), icon_label);
-        
-        // Temperature
-        char temp_str[32];
-        int temp_len = snprintf(temp_str, sizeof(temp_str), "%.1f°C", temp);
-        if (temp_len < 0 || temp_len >= (int)sizeof(temp_str)) {
-            strncpy(temp_str, "N/A", sizeof(temp_str) - 1);
-            temp_str[sizeof(temp_str) - 1] = '\0';
-        }
-        GtkWidget *temp_label = gtk_label_new(temp_str);
-        gtk_widget_add_css_class(temp_label, "weather-temp");
-        gtk_box_append(GTK_BOX(hour_box), temp_label);
-        
-        // Description
-        GtkWidget *desc_label = gtk_label_new(get_weather_description((int)code));
-        gtk_widget_add_css_class(desc_label, "weather-desc");
-        gtk_box_append(GTK_BOX(hour_box), desc_label);
-        
-        gtk_box_append(GTK_BOX(data->weather_box), hour_box);
+    // The snapshot's forecasts become the app's current forecasts, and the
+    // snapshot takes the previous ones back for reuse
+    for (guint i = 0; i < snapshot->n_forecasts; i++) {
+        LocationStrip *location = &data->locations[i];
+        WeatherForecast *previous = location->forecast;
+        location->forecast = snapshot->forecasts[i];
+        snapshot->forecasts[i] = previous;
+        update_daily_aggregates(data, location);
+    }
+    // Titles come from the new forecasts
+    sync_location_strips(data);
+    for (guint i = 0; i < snapshot->n_forecasts; i++) {
+        render_location(&data->locations[i], snapshot->start_index[i]);
     }
+    schedule_window_advance(data);
     
-    g_object_unref(parser);
+    hide_weather_overlay(data);
+    metrics_histogram_observe(&data->histograms.commit, (gdouble)(g_get_monotonic_time() - commit_start) / G_USEC_PER_SEC);
+    watchdog_end(previous_activity);
     return TRUE;  // Success!
 }
 
-typedef struct {
-    AppData *data;
-    gchar *json_data;
-} WeatherParseData;
+static void clear_validators(AppData *data) {
+    g_clear_pointer(&data->validator_url, g_free);
+    g_clear_pointer(&data->etag, g_free);
+    g_clear_pointer(&data->last_modified, g_free);
+}
 
 // Forward declaration for retry function
 static gboolean retry_fetch_weather(gpointer user_data);
 
-static gboolean parse_weather_idle(gpointer user_data) {
-    WeatherParseData *parse_data = (WeatherParseData *)user_data;
-    if (!parse_data) {
-        return G_SOURCE_REMOVE;
+// Overlay text for the retry engine's current state. While the last good
+// forecast still covers the current hour it stays on screen undimmed
+// (stale-while-revalidate); only the age badge says refreshes are failing.
+static void show_retry_state(AppData *data) {
+    if (have_current_forecasts(data)) {
+        hide_weather_overlay(data);
+        update_age_badge(data);
+        return;
     }
     
-    AppData *data = parse_data->data;
-    
-    // Safety check: ensure data and session are still valid
-    if (data && data->session) {
-        gboolean success = parse_weather_json(parse_data->json_data, data);
-        
-        // If parsing failed (server error, bad response), trigger retry
-        if (!success && data->retry_count < MAX_RETRY_ATTEMPTS) {
-            g_warning("JSON parsing failed, scheduling retry (attempt %d/%d)", 
-                      data->retry_count + 1, MAX_RETRY_ATTEMPTS);
-            
-            // Calculate exponential backoff delay
-            data->retry_delay = INITIAL_RETRY_DELAY * (1 << data->retry_count);
-            if (data->retry_delay > MAX_RETRY_DELAY) {
-                data->retry_delay = MAX_RETRY_DELAY;
-            }
-            
-            data->is_retrying = TRUE;
-            
-            // Schedule retry
-            if (data->retry_timer_id != 0) {
-                g_source_remove(data->retry_timer_id);
-            }
-            data->retry_timer_id = g_timeout_add_seconds(data->retry_delay, retry_fetch_weather, data);
-            data->retry_count++;
-        } else if (!success) {
-            // Max retries exceeded
-            g_warning("JSON parsing failed after max retries");
-            data->is_retrying = FALSE;
-            data->retry_count = 0;
-            data->retry_delay = 0;
-        } else {
-            // Success - reset retry state
-            if (data->retry_count > 0) {
-                g_info("Weather data parsed successfully after %d retry attempt(s)", data->retry_count);
-            }
-            data->is_retrying = FALSE;
-            data->retry_count = 0;
-            data->retry_delay = 0;
-            if (data->retry_timer_id != 0) {
-                g_source_remove(data->retry_timer_id);
-                data->retry_timer_id = 0;
-            }
+    const RetryEngine *retry = &data->retry;
+    const gchar *cause = fetch_error_class_describe(retry->last_error);
+    gchar *message;
+    if (retry->circuit == RETRY_CIRCUIT_OPEN) {
+        // Wall time in the clock's zone, so it matches what is on screen
+        GDateTime *until = g_date_time_new_from_unix_utc(retry->open_until +
+                                                         clock_utc_offset(data, retry->open_until));
+        gchar *until_str = until ? g_date_time_format(until, "%H:%M") : NULL;
+        message = g_strdup_printf("Weather service unavailable (%s) - pausing requests until %s",
+                                  cause, until_str ? until_str : "later");
+        g_free(until_str);
+        if (until) {
+            g_date_time_unref(until);
         }
+    } else if (retry->retrying) {
+        message = g_strdup_printf("Connection issue (%s) - retrying in %u seconds... (attempt %u/%d)",
+                                  cause, retry->delay, retry->attempt, RETRY_MAX_ATTEMPTS);
+    } else {
+        message = g_strdup_printf("Failed to fetch weather (%s) - will retry at next scheduled update", cause);
     }
     
-    g_free(parse_data->json_data);
-    g_free(parse_data);
-    return G_SOURCE_REMOVE;
+    show_weather_overlay(data, message);
+    g_free(message);
 }
 
-static gboolean show_weather_error(gpointer user_data) {
-    WeatherParseData *error_data = (WeatherParseData *)user_data;
-    if (!error_data) {
-        return G_SOURCE_REMOVE;
-    }
-    
-    AppData *data = error_data->data;
-    if (!data || !data->weather_box || !data->session) {
-        g_free(error_data);
-        return G_SOURCE_REMOVE;
-    }
-    
-    // Additional safety: verify weather_box is still a valid box widget
-    if (!GTK_IS_BOX(data->weather_box)) {
-        g_free(error_data);
-        return G_SOURCE_REMOVE;
-    }
-    
-    // Clear existing widgets
-    GtkWidget *child;
-    while ((child = gtk_widget_get_first_child(data->weather_box))) {
-        gtk_box_remove(GTK_BOX(data->weather_box), child);
-        // Widget is automatically unparented and will be destroyed when last reference drops
+// The single failure path of the weather fetch: the retry engine classifies and
+// paces, this arms the timer and tells the user. With the circuit open the
+// timer is the probe at the end of the cooldown.
+static void handle_fetch_failure(AppData *data, FetchErrorClass error_class, const gchar *detail) {
+    RetryEngine *retry = &data->retry;
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    
+    g_warning("Weather fetch failed (%s): %s", fetch_error_class_name(error_class), detail);
+    if (data->retry_timer_id != 0) {
+        g_source_remove(data->retry_timer_id);
+        data->retry_timer_id = 0;
     }
     
-    // Show different message based on retry state
-    gchar *error_msg;
-    if (data->is_retrying) {
-        error_msg = g_strdup_printf("Connection issue - retrying in %d seconds... (attempt %d/%d)", 
-                                    data->retry_delay, data->retry_count + 1, MAX_RETRY_ATTEMPTS);
+    guint delay = retry_engine_failure(retry, error_class, (guint)MAX(data->retry_after, 0), now);
+    if (delay > 0) {
+        g_info("Scheduling retry %u/%d in %u seconds...", retry->attempt, RETRY_MAX_ATTEMPTS, delay);
+        data->retry_timer_id = g_timeout_add_seconds(delay, retry_fetch_weather, data);
+    } else if (retry->circuit == RETRY_CIRCUIT_OPEN) {
+        data->retry_timer_id = g_timeout_add_seconds((guint)MAX(retry->open_until - now, 1),
+                                                     retry_fetch_weather, data);
     } else {
-        error_msg = g_strdup("Failed to fetch weather - will retry at next scheduled update");
+        g_warning("Giving up until the next scheduled update");
     }
     
-    GtkWidget *error_label = gtk_label_new(error_msg);
-    gtk_widget_add_css_class(error_label, "error-text");
-    gtk_box_append(GTK_BOX(data->weather_box), error_label);
-    
-    g_free(error_msg);
-    g_free(error_data);
-    return G_SOURCE_REMOVE;
+    g_debug("Retry state: circuit %s, %u consecutive failures, %" G_GUINT64_FORMAT " retries, "
+            "%" G_GUINT64_FORMAT " trips, %" G_GUINT64_FORMAT " requests suppressed",
+            retry_circuit_state_name(retry->circuit), retry->consecutive_failures,
+            retry->retries_scheduled, retry->circuit_trips, retry->requests_suppressed);
+    show_retry_state(data);
 }
 
-// Forward declaration
-static void fetch_weather(AppData *data);
-
-static void on_weather_response(GObject *source_object, GAsyncResult *res, gpointer user_data) {
+static void handle_fetch_success(AppData *data) {
+    if (data->retry.attempt > 0) {
+        g_info("Weather fetch succeeded after %u retry attempt(s)", data->retry.attempt);
+    }
+    retry_engine_success(&data->retry);
+    if (data->retry_timer_id != 0) {
+        g_source_remove(data->retry_timer_id);
+        data->retry_timer_id = 0;
+    }
+    update_age_badge(data);
+}
+
+// Completion of decode_forecast_thread(), back on the main thread
+static void on_forecast_decoded(GObject *source_object, GAsyncResult *res, gpointer user_data) {
+    (void)source_object;
+    AppData *data = (AppData *)user_data;
+    GError *error = NULL;
+    
+    // A superseded request's cancellable makes GTask drop the snapshot for us
+    ForecastSnapshot *snapshot = g_task_propagate_pointer(G_TASK(res), &error);
+    if (!snapshot) {
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            g_warning("Forecast decode failed: %s", error ? error->message : "Unknown");
+        }
+        g_clear_error(&error);
+        return;
+    }
+    
+    // Safety check: ensure data and session are still valid
+    if (data && data->session) {
+        metrics_histogram_observe(&data->histograms.parse, (gdouble)snapshot->parse_us / G_USEC_PER_SEC);
+        if (commit_forecast_snapshot(data, snapshot)) {
+            handle_fetch_success(data);
+            
+            // Only fresh data is worth persisting; an API error leaves the cache alone
+            if (snapshot->result == FORECAST_PARSE_OK && have_all_forecasts(data)) {
+                forecast_refreshed(data);
+            }
+        } else {
+            // Validators of a response we couldn't use must not turn the retry into a 304
+            clear_validators(data);
+            FetchErrorClass error_class = retry_classify_status(data->last_http_status);
+            handle_fetch_failure(data, error_class != FETCH_ERROR_NONE ? error_class : FETCH_ERROR_PARSE,
+                                 snapshot->error_msg[0] != '\0' ? snapshot->error_msg : "unusable response");
+        }
+    }
+    
+    release_snapshot(data, snapshot);
+}
+
+// Forward declaration
+static void fetch_weather(AppData *data);
+
+// Remember the cache validators of a full response so the next refresh of the
+// same URL can be answered with 304 Not Modified
+static void store_validators(AppData *data, SoupMessage *msg) {
+    SoupMessageHeaders *headers = soup_message_get_response_headers(msg);
+    const char *etag = soup_message_headers_get_one(headers, "ETag");
+    const char *last_modified = soup_message_headers_get_one(headers, "Last-Modified");
+    
+    clear_validators(data);
+    if (etag || last_modified) {
+        data->validator_url = g_strdup((const gchar *)g_object_get_data(G_OBJECT(msg), "request-url"));
+        data->etag = g_strdup(etag);
+        data->last_modified = g_strdup(last_modified);
+    }
+}
+
+// Duration of one metrics phase in microseconds, -1 if it didn't happen
+// (libsoup reports 0 for phases skipped, e.g. connect on a reused connection)
+static gint64 metrics_phase_us(guint64 start, guint64 end) {
+    return start != 0 && end >= start ? (gint64)(end - start) : -1;
+}
+
+static void add_phase(guint64 *total, gint64 phase_us) {
+    if (phase_us >= 0) {
+        *total += (guint64)phase_us;
+    }
+}
+
+static void format_phase(gchar *buffer, gsize size, gint64 phase_us) {
+    if (phase_us < 0) {
+        g_strlcpy(buffer, "-", size);
+    } else {
+        snprintf(buffer, size, "%.1f ms", phase_us / 1000.0);
+    }
+}
+
+// Per-refresh phase breakdown: DNS, TCP connect, TLS handshake, time to first
+// byte and body transfer
+static void record_fetch_timing(AppData *data, SoupMessage *msg, SoupMessageMetrics *metrics) {
+    FetchStats *stats = &data->fetch_stats;
+    guint64 tls_start = soup_message_metrics_get_tls_start(metrics);
+    guint64 connect_start = soup_message_metrics_get_connect_start(metrics);
+    guint64 connect_end = soup_message_metrics_get_connect_end(metrics);
+    
+    gint64 dns = metrics_phase_us(soup_message_metrics_get_dns_start(metrics), soup_message_metrics_get_dns_end(metrics));
+    gint64 connect = metrics_phase_us(connect_start, tls_start != 0 ? tls_start : connect_end);
+    gint64 tls = metrics_phase_us(tls_start, connect_end);
+    gint64 ttfb = metrics_phase_us(soup_message_metrics_get_request_start(metrics),
+                                   soup_message_metrics_get_response_start(metrics));
+    gint64 body = metrics_phase_us(soup_message_metrics_get_response_start(metrics),
+                                   soup_message_metrics_get_response_end(metrics));
+    gint64 total = metrics_phase_us(soup_message_metrics_get_fetch_start(metrics),
+                                    soup_message_metrics_get_response_end(metrics));
+    
+    gboolean reused = connect_start == 0;
+    if (reused) {
+        stats->reused_connections++;
+    } else {
+        stats->new_connections++;
+    }
+    add_phase(&stats->dns_us, dns);
+    add_phase(&stats->connect_us, connect);
+    add_phase(&stats->tls_us, tls);
+    add_phase(&stats->ttfb_us, ttfb);
+    add_phase(&stats->body_us, body);
+    
+    gint64 phases[N_FETCH_PHASES] = { dns, connect, tls, ttfb, body, total };
+    for (guint i = 0; i < N_FETCH_PHASES; i++) {
+        if (phases[i] >= 0) {
+            metrics_histogram_observe(&data->histograms.fetch_phase[i], (gdouble)phases[i] / G_USEC_PER_SEC);
+        }
+    }
+    
+    char dns_str[24], connect_str[24], tls_str[24], ttfb_str[24], body_str[24], total_str[24];
+    format_phase(dns_str, sizeof(dns_str), dns);
+    format_phase(connect_str, sizeof(connect_str), connect);
+    format_phase(tls_str, sizeof(tls_str), tls);
+    format_phase(ttfb_str, sizeof(ttfb_str), ttfb);
+    format_phase(body_str, sizeof(body_str), body);
+    format_phase(total_str, sizeof(total_str), total);
+    g_info("Fetch timing (%s, %s connection): dns %s, connect %s, tls %s, ttfb %s, body %s, total %s",
+           soup_message_get_http_version(msg) == SOUP_HTTP_2_0 ? "HTTP/2" : "HTTP/1.1",
+           reused ? "reused" : "new", dns_str, connect_str, tls_str, ttfb_str, body_str, total_str);
+}
+
+static void record_fetch_stats(AppData *data, guint status, SoupMessageMetrics *metrics) {
+    FetchStats *stats = &data->fetch_stats;
+    guint64 wire = soup_message_metrics_get_response_body_bytes_received(metrics);
+    guint64 decoded = soup_message_metrics_get_response_body_size(metrics);
+    
+    stats->requests++;
+    stats->wire_bytes += wire;
+    stats->decoded_bytes += decoded;
+    if (status == SOUP_STATUS_NOT_MODIFIED) {
+        stats->not_modified++;
+        stats->saved_not_modified += data->last_wire_bytes;
+    } else if (SOUP_STATUS_IS_SUCCESSFUL(status)) {
+        if (decoded > wire) {
+            stats->saved_compression += decoded - wire;
+        }
+        data->last_wire_bytes = wire;
+        metrics_histogram_observe(&data->histograms.response_bytes, (gdouble)wire);
+    }
+    
+    g_debug("Fetch %u: %" G_GUINT64_FORMAT " B on the wire (%" G_GUINT64_FORMAT " B decoded); "
+            "totals: %" G_GUINT64_FORMAT " requests, %" G_GUINT64_FORMAT " not modified, "
+            "%" G_GUINT64_FORMAT " B saved by compression, %" G_GUINT64_FORMAT " B saved by 304",
+            status, wire, decoded, stats->requests, stats->not_modified,
+            stats->saved_compression, stats->saved_not_modified);
+}
+
+// Seconds from a Retry-After header (delta-seconds or HTTP-date), 0 if absent
+static gint parse_retry_after(const char *value, gint64 now) {
+    if (!value) {
+        return 0;
+    }
+    
+    gint64 seconds = 0;
+    if (g_ascii_isdigit(value[0])) {
+        seconds = (gint64)g_ascii_strtoull(value, NULL, 10);
+    } else {
+        GDateTime *date = soup_date_time_new_from_http_string(value);
+        if (date) {
+            seconds = g_date_time_to_unix(date) - now;
+            g_date_time_unref(date);
+        }
+    }
+    return (gint)CLAMP(seconds, 0, MAX_UPDATE_INTERVAL_SECONDS);
+}
+
+// Pick up the server's pacing hints: Cache-Control max-age on usable responses,
+// Retry-After on 429/503. Both only ever delay requests, never hasten them.
+static void store_server_hints(AppData *data, SoupMessage *msg, guint status) {
+    SoupMessageHeaders *headers = soup_message_get_response_headers(msg);
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    
+    data->retry_after = 0;
+    if (status == SOUP_STATUS_TOO_MANY_REQUESTS || status == SOUP_STATUS_SERVICE_UNAVAILABLE) {
+        data->retry_after = parse_retry_after(soup_message_headers_get_one(headers, "Retry-After"), now);
+        if (data->retry_after > 0) {
+            g_info("Server asked to retry after %d s (HTTP %u)", data->retry_after, status);
+        }
+        return;
+    }
+    
+    data->fresh_until = 0;
+    const char *cache_control = soup_message_headers_get_list(headers, "Cache-Control");
+    if (cache_control && (SOUP_STATUS_IS_SUCCESSFUL(status) || status == SOUP_STATUS_NOT_MODIFIED)) {
+        GHashTable *directives = soup_header_parse_param_list(cache_control);
+        const char *max_age = g_hash_table_lookup(directives, "max-age");
+        if (max_age && !g_hash_table_contains(directives, "no-cache")) {
+            data->fresh_until = now + (gint64)MIN(g_ascii_strtoull(max_age, NULL, 10), MAX_UPDATE_INTERVAL_SECONDS);
+        }
+        soup_header_free_param_list(directives);
+    }
+}
+
+static void on_weather_response(GObject *source_object, GAsyncResult *res, gpointer user_data) {
     SoupMessage *msg = SOUP_MESSAGE(user_data);
     if (!msg) {
         g_warning("Invalid message in weather response callback");
@@ -659,8 +1133,10 @@ static void on_weather_response(GObject *source_object, GAsyncResult *res, gpoin
     AppData *data = (AppData *)g_object_get_data(G_OBJECT(msg), "app-data");
     
     // Clear pending message reference
+    gboolean superseded = TRUE;
     if (data && data->pending_message == msg) {
         data->pending_message = NULL;
+        superseded = FALSE;
     }
     
     if (!data || !data->session) {
@@ -672,94 +1148,63 @@ static void on_weather_response(GObject *source_object, GAsyncResult *res, gpoin
     GError *error = NULL;
     GBytes *body_bytes = soup_session_send_and_read_finish(SOUP_SESSION(source_object), res, &error);
     
+    // A newer fetch replaced this one: drop whatever arrived without touching retry state
+    if (superseded || g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_clear_error(&error);
+        if (body_bytes) {
+            g_bytes_unref(body_bytes);
+        }
+        g_object_unref(msg);
+        return;
+    }
+    
     if (error) {
-        // Error occurred - determine if it's retryable
-        g_warning("Weather fetch error: %s (attempt %d/%d)", error->message, data->retry_count + 1, MAX_RETRY_ATTEMPTS);
+        handle_fetch_failure(data, retry_classify_error(error), error->message);
+        g_error_free(error);
+        g_object_unref(msg);
+        return;
+    }
+    
+    guint status = soup_message_get_status(msg);
+    SoupMessageMetrics *metrics = soup_message_get_metrics(msg);
+    if (metrics) {
+        record_fetch_stats(data, status, metrics);
+        record_fetch_timing(data, msg, metrics);
+    }
+    store_server_hints(data, msg, status);
+    
+    // 304 fast path: the forecast we already have is still current, so skip the
+    // decode entirely and just move the strip along to the current hour
+    if (status == SOUP_STATUS_NOT_MODIFIED && have_all_forecasts(data)) {
+        g_debug("Forecast not modified since last fetch, keeping current snapshot");
+        handle_fetch_success(data);
         
-        // Check if this is a transient error that should be retried
-        gboolean should_retry = (data->retry_count < MAX_RETRY_ATTEMPTS);
+        render_all_locations(data);
+        forecast_refreshed(data);
         
-        if (should_retry) {
-            // Calculate exponential backoff delay: 30s, 60s, 120s, 240s, 480s
-            data->retry_delay = INITIAL_RETRY_DELAY * (1 << data->retry_count);  // 30 * 2^retry_count
-            if (data->retry_delay > MAX_RETRY_DELAY) {
-                data->retry_delay = MAX_RETRY_DELAY;
-            }
-            
-            data->is_retrying = TRUE;
-            
-            // Show error message with retry info
-            WeatherParseData *error_data = g_new0(WeatherParseData, 1);
-            if (error_data) {
-                error_data->data = data;
-                error_data->json_data = NULL;
-                g_idle_add(show_weather_error, error_data);
-            }
-            
-            // Schedule retry
-            g_info("Scheduling retry in %d seconds...", data->retry_delay);
-            if (data->retry_timer_id != 0) {
-                g_source_remove(data->retry_timer_id);
-            }
-            data->retry_timer_id = g_timeout_add_seconds(data->retry_delay, retry_fetch_weather, data);
-            
-            data->retry_count++;
-        } else {
-            // Max retries exceeded
-            g_warning("Max retry attempts (%d) exceeded. Will retry at next scheduled update.", MAX_RETRY_ATTEMPTS);
-            data->is_retrying = FALSE;
-            data->retry_count = 0;
-            data->retry_delay = 0;
-            
-            WeatherParseData *error_data = g_new0(WeatherParseData, 1);
-            if (error_data) {
-                error_data->data = data;
-                error_data->json_data = NULL;
-                g_idle_add(show_weather_error, error_data);
-            }
+        if (body_bytes) {
+            g_bytes_unref(body_bytes);
         }
-        
-        g_error_free(error);
         g_object_unref(msg);
         return;
     }
     
-    if (!body_bytes) {
-        g_warning("No body bytes received (attempt %d/%d)", data->retry_count + 1, MAX_RETRY_ATTEMPTS);
-        
-        // Retry logic for empty response
-        if (data->retry_count < MAX_RETRY_ATTEMPTS) {
-            data->retry_delay = INITIAL_RETRY_DELAY * (1 << data->retry_count);
-            if (data->retry_delay > MAX_RETRY_DELAY) {
-                data->retry_delay = MAX_RETRY_DELAY;
-            }
-            
-            data->is_retrying = TRUE;
-            WeatherParseData *error_data = g_new0(WeatherParseData, 1);
-            if (error_data) {
-                error_data->data = data;
-                error_data->json_data = NULL;
-                g_idle_add(show_weather_error, error_data);
-            }
-            
-            if (data->retry_timer_id != 0) {
-                g_source_remove(data->retry_timer_id);
-            }
-            data->retry_timer_id = g_timeout_add_seconds(data->retry_delay, retry_fetch_weather, data);
-            data->retry_count++;
-        } else {
-            data->is_retrying = FALSE;
-            data->retry_count = 0;
-            data->retry_delay = 0;
-            
-            WeatherParseData *error_data = g_new0(WeatherParseData, 1);
-            if (error_data) {
-                error_data->data = data;
-                error_data->json_data = NULL;
-                g_idle_add(show_weather_error, error_data);
-            }
+    // Upstream trouble: no point decoding an error page, let the engine pace the retry.
+    // Other 4xx responses are decoded, since Open-Meteo explains them in the body.
+    FetchErrorClass status_class = retry_classify_status(status);
+    if (status_class == FETCH_ERROR_HTTP_5XX || status_class == FETCH_ERROR_RATE_LIMITED) {
+        gchar *detail = g_strdup_printf("HTTP %u", status);
+        handle_fetch_failure(data, status_class, detail);
+        g_free(detail);
+        if (body_bytes) {
+            g_bytes_unref(body_bytes);
         }
-        
+        g_object_unref(msg);
+        return;
+    }
+    
+    if (!body_bytes) {
+        handle_fetch_failure(data, FETCH_ERROR_EMPTY, "no body received");
         g_object_unref(msg);
         return;
     }
@@ -768,71 +1213,30 @@ static void on_weather_response(GObject *source_object, GAsyncResult *res, gpoin
     gsize length;
     const gchar *response_body = (const gchar *)g_bytes_get_data(body_bytes, &length);
     if (response_body && length > 0) {
-        // Success! Reset retry counters
-        if (data->retry_count > 0) {
-            g_info("Weather fetch succeeded after %d retry attempt(s)", data->retry_count);
-        }
-        data->retry_count = 0;
-        data->retry_delay = 0;
-        data->is_retrying = FALSE;
-        if (data->retry_timer_id != 0) {
-            g_source_remove(data->retry_timer_id);
-            data->retry_timer_id = 0;
-        }
+        // Retry state is settled once the decode tells whether the body was usable
+        data->last_http_status = status;
         
-        // Debug: print first 500 chars of response
-        gchar *preview = g_strndup(response_body, length > 500 ? 500 : length);
-        if (preview) {
-            g_debug("Weather API response (first 500 chars): %s", preview);
-            g_free(preview);
+        if (SOUP_STATUS_IS_SUCCESSFUL(status)) {
+            store_validators(data, msg);
         }
         
-        WeatherParseData *parse_data = g_new0(WeatherParseData, 1);
-        parse_data->data = data;
-        parse_data->json_data = g_strndup(response_body, length);
-        
-        // Check if allocation succeeded
-        if (!parse_data->json_data) {
-            g_warning("Failed to allocate memory for JSON data");
-            g_free(parse_data);
-        } else {
-            g_idle_add(parse_weather_idle, parse_data);
+        // Debug: print first 500 chars of response (only when debug output is enabled)
+        if (debug_logging_enabled()) {
+            g_debug("Weather API response (first 500 chars): %.*s", (int)MIN(length, 500), response_body);
         }
-    } else {
-        g_warning("Empty response body (attempt %d/%d)", data->retry_count + 1, MAX_RETRY_ATTEMPTS);
         
-        // Retry logic for empty body
-        if (data->retry_count < MAX_RETRY_ATTEMPTS) {
-            data->retry_delay = INITIAL_RETRY_DELAY * (1 << data->retry_count);
-            if (data->retry_delay > MAX_RETRY_DELAY) {
-                data->retry_delay = MAX_RETRY_DELAY;
-            }
-            
-            data->is_retrying = TRUE;
-            WeatherParseData *error_data = g_new0(WeatherParseData, 1);
-            if (error_data) {
-                error_data->data = data;
-                error_data->json_data = NULL;
-                g_idle_add(show_weather_error, error_data);
-            }
-            
-            if (data->retry_timer_id != 0) {
-                g_source_remove(data->retry_timer_id);
-            }
-            data->retry_timer_id = g_timeout_add_seconds(data->retry_delay, retry_fetch_weather, data);
-            data->retry_count++;
-        } else {
-            data->is_retrying = FALSE;
-            data->retry_count = 0;
-            data->retry_delay = 0;
-            
-            WeatherParseData *error_data = g_new0(WeatherParseData, 1);
-            if (error_data) {
-                error_data->data = data;
-                error_data->json_data = NULL;
-                g_idle_add(show_weather_error, error_data);
-            }
-        }
+        // Decode on a worker thread; the body is shared with the task, not copied.
+        // The fetch's cancellable discards the result if a newer fetch starts meanwhile.
+        DecodeRequest *request = g_new0(DecodeRequest, 1);
+        request->body = g_bytes_ref(body_bytes);
+        request->n_locations = data->n_locations;
+        request->snapshot = take_snapshot(data, data->n_locations);
+        GTask *task = g_task_new(NULL, data->fetch_cancellable, on_forecast_decoded, data);
+        g_task_set_task_data(task, request, decode_request_free);
+        g_task_run_in_thread(task, decode_forecast_thread);
+        g_object_unref(task);
+    } else {
+        handle_fetch_failure(data, FETCH_ERROR_EMPTY, "empty response body");
     }
     
     g_bytes_unref(body_bytes);
@@ -848,19 +1252,104 @@ static gchar* get_config_file_path(void) {
     return g_strdup(CONFIG_FILE_NAME);
 }
 
-static void save_location_to_config(AppData *data) {
-    if (!data || !data->location_lat || !data->location_lon) {
-        return;
+// A latitude (limit 90) or longitude (limit 180) as typed; the 20-character cap
+// matches what fetch_weather() accepts in the URL
+static gboolean is_valid_coordinate(const gchar *text, gdouble limit) {
+    if (!text || text[0] == '\0' || strlen(text) > 20) {
+        return FALSE;
     }
-    
-    gchar *config_path = get_config_file_path();
-    if (!config_path) {
-        return;
+    gchar *end = NULL;
+    gdouble value = g_ascii_strtod(text, &end);
+    return end && *end == '\0' && isfinite(value) && fabs(value) <= limit;
+}
+
+// Parse "lat,lon; lat,lon; ..." into at most max_pairs newly allocated strings.
+// Malformed entries are logged and skipped. Returns the number of pairs stored.
+static guint parse_location_list(const gchar *text, gchar **lats, gchar **lons, guint max_pairs) {
+    guint n_pairs = 0;
+    gchar **entries = g_strsplit(text ? text : "", ";", -1);
+    for (guint i = 0; entries[i]; i++) {
+        gchar *entry = g_strstrip(entries[i]);
+        if (entry[0] == '\0') {
+            continue;
+        }
+        
+        gchar **coords = g_strsplit(entry, ",", 3);
+        gboolean valid = coords[0] && coords[1] && !coords[2];
+        if (valid) {
+            g_strstrip(coords[0]);
+            g_strstrip(coords[1]);
+            valid = is_valid_coordinate(coords[0], 90.0) && is_valid_coordinate(coords[1], 180.0);
+        }
+        if (!valid) {
+            g_warning("Ignoring invalid location \"%s\" (expected lat,lon)", entry);
+        } else if (n_pairs == max_pairs) {
+            g_warning("Ignoring location \"%s\": at most %d locations are shown", entry, MAX_LOCATIONS);
+        } else {
+            lats[n_pairs] = g_strdup(coords[0]);
+            lons[n_pairs] = g_strdup(coords[1]);
+            n_pairs++;
+        }
+        g_strfreev(coords);
+    }
+    g_strfreev(entries);
+    return n_pairs;
+}
+
+// Replace locations[1..] with the given pairs (ownership of the strings moves to
+// data). A strip whose coordinates change drops its forecast, since it belongs
+// to the old place.
+static void set_additional_locations(AppData *data, gchar **lats, gchar **lons, guint n_pairs) {
+    for (guint i = 1; i < MAX_LOCATIONS; i++) {
+        LocationStrip *location = &data->locations[i];
+        gchar *lat = i <= n_pairs ? lats[i - 1] : NULL;
+        gchar *lon = i <= n_pairs ? lons[i - 1] : NULL;
+        if (location->forecast && (g_strcmp0(location->lat, lat) != 0 || g_strcmp0(location->lon, lon) != 0)) {
+            forecast_free(location->forecast);
+            location->forecast = NULL;
+        }
+        g_free(location->lat);
+        g_free(location->lon);
+        location->lat = lat;
+        location->lon = lon;
+    }
+    data->n_locations = n_pairs + 1;
+}
+
+// Replace one of the primary location's coordinates (taking ownership of value).
+// Its forecast, and the validators of the request that fetched it, belong to
+// the old place: dropped as set_additional_locations() does for the other
+// strips, so a failed refresh can't keep them on screen as the current forecast.
+static void set_primary_coordinate(AppData *data, gchar **coordinate, gchar *value) {
+    if (g_strcmp0(*coordinate, value) != 0) {
+        if (data->locations[0].forecast) {
+            forecast_free(data->locations[0].forecast);
+            data->locations[0].forecast = NULL;
+        }
+        clear_validators(data);
+    }
+    g_free(*coordinate);
+    *coordinate = value;
+}
+
+// The additional locations in parse_location_list() syntax, for the settings entry
+static gchar* format_additional_locations(AppData *data) {
+    GString *text = g_string_new(NULL);
+    for (guint i = 1; i < data->n_locations; i++) {
+        g_string_append_printf(text, "%s%s,%s", i > 1 ? "; " : "", data->locations[i].lat, data->locations[i].lon);
+    }
+    return g_string_free(text, FALSE);
+}
+
+// The config file contents for the current settings (NULL without a location)
+static gchar* build_config_data(AppData *data) {
+    if (!data || !data->locations[0].lat || !data->locations[0].lon) {
+        return NULL;
     }
     
     GKeyFile *key_file = g_key_file_new();
-    g_key_file_set_string(key_file, "Location", "latitude", data->location_lat);
-    g_key_file_set_string(key_file, "Location", "longitude", data->location_lon);
+    g_key_file_set_string(key_file, "Location", "latitude", data->locations[0].lat);
+    g_key_file_set_string(key_file, "Location", "longitude", data->locations[0].lon);
     if (data->timezone) {
         g_key_file_set_string(key_file, "Location", "timezone", data->timezone);
     }
@@ -868,18 +1357,187 @@ static void save_location_to_config(AppData *data) {
     // Save UTC offset as fallback (important for deployments without timezone database)
     g_key_file_set_integer(key_file, "Location", "utc_offset_seconds", data->utc_offset_seconds);
     
-    GError *error = NULL;
-    if (!g_key_file_save_to_file(key_file, config_path, &error)) {
-        g_warning("Failed to save config: %s", error ? error->message : "Unknown error");
-        if (error) {
-            g_error_free(error);
+    // Extra forecast strips below the primary location, as "lat,lon" entries
+    if (data->n_locations > 1) {
+        const gchar *additional[MAX_LOCATIONS];
+        gchar *pairs[MAX_LOCATIONS];
+        guint n_pairs = 0;
+        for (guint i = 1; i < data->n_locations; i++) {
+            pairs[n_pairs] = g_strdup_printf("%s,%s", data->locations[i].lat, data->locations[i].lon);
+            additional[n_pairs] = pairs[n_pairs];
+            n_pairs++;
+        }
+        g_key_file_set_string_list(key_file, "Location", "additional", additional, n_pairs);
+        for (guint i = 0; i < n_pairs; i++) {
+            g_free(pairs[i]);
         }
     }
     
+    // Only written when enabled, so default configs stay unchanged
+    if (data->shared_fetch) {
+        g_key_file_set_boolean(key_file, "Fetch", "shared", TRUE);
+    }
+    if (data->clock_low_power) {
+        g_key_file_set_boolean(key_file, "Clock", "low_power", TRUE);
+    }
+    if (!data->clock_glyph_cache) {
+        g_key_file_set_boolean(key_file, "Clock", "glyph_cache", FALSE);
+    }
+    if (data->hours_to_show != DEFAULT_HOURS_TO_SHOW) {
+        g_key_file_set_integer(key_file, "Display", "hours_to_show", (gint)data->hours_to_show);
+    }
+    if (data->forecast_days != 0) {
+        g_key_file_set_integer(key_file, "Display", "forecast_days", (gint)data->forecast_days);
+    }
+    if (data->render_quality != RENDER_QUALITY_AUTO) {
+        g_key_file_set_string(key_file, "Display", "render_quality",
+                              render_quality_name((RenderQuality)data->render_quality));
+    }
+    if (data->frame_budget_ms != DEFAULT_FRAME_BUDGET_MS) {
+        g_key_file_set_integer(key_file, "Display", "frame_budget_ms", (gint)data->frame_budget_ms);
+    }
+    if (data->refresh_interval != UPDATE_INTERVAL_SECONDS) {
+        g_key_file_set_integer(key_file, "Fetch", "interval_minutes", (gint)(data->refresh_interval / 60));
+    }
+    if (data->refresh_jitter_max != DEFAULT_REFRESH_JITTER_SECONDS) {
+        g_key_file_set_integer(key_file, "Fetch", "jitter_seconds", (gint)data->refresh_jitter_max);
+    }
+    if (data->http_timeout != DEFAULT_HTTP_TIMEOUT) {
+        g_key_file_set_integer(key_file, "Network", "timeout_seconds", (gint)data->http_timeout);
+    }
+    if (data->http_idle_timeout != DEFAULT_HTTP_IDLE_TIMEOUT) {
+        g_key_file_set_integer(key_file, "Network", "idle_timeout_seconds", (gint)data->http_idle_timeout);
+    }
+    if (!data->http2) {
+        g_key_file_set_boolean(key_file, "Network", "http2", FALSE);
+    }
+    if (data->dns_cache_seconds != DEFAULT_DNS_CACHE_SECONDS) {
+        g_key_file_set_integer(key_file, "Network", "dns_cache_seconds", (gint)data->dns_cache_seconds);
+    }
+    if (data->metrics_port != 0) {
+        g_key_file_set_integer(key_file, "Metrics", "port", (gint)data->metrics_port);
+    }
+    if (data->stall_threshold_ms != 0) {
+        g_key_file_set_integer(key_file, "Watchdog", "stall_ms", (gint)data->stall_threshold_ms);
+    }
+    if (data->memory_compact) {
+        g_key_file_set_boolean(key_file, "Memory", "compact", TRUE);
+    }
+    
+    gchar *contents = g_key_file_to_data(key_file, NULL, NULL);
     g_key_file_unref(key_file);
+    return contents;
+}
+
+static void start_config_write(AppData *data);
+
+static void config_write_done(GObject *source, GAsyncResult *result, gpointer user_data) {
+    GError *error = NULL;
+    gboolean ok = g_file_replace_contents_finish(G_FILE(source), result, NULL, &error);
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_error_free(error);
+        return; // Shutting down; flush_config() took over
+    }
+    
+    AppData *data = (AppData *)user_data;
+    if (ok) {
+        gsize length = 0;
+        const gchar *contents = g_bytes_get_data(data->config_writing, &length);
+        g_free(data->config_written);
+        data->config_written = g_strndup(contents, length);
+    } else {
+        // config_written is left alone, so the next save tries again
+        g_warning("Failed to save config: %s", error ? error->message : "Unknown error");
+        g_clear_error(&error);
+    }
+    g_clear_pointer(&data->config_writing, g_bytes_unref);
+    g_clear_object(&data->config_write_cancellable);
+    
+    if (data->config_save_again) {
+        data->config_save_again = FALSE;
+        start_config_write(data);
+    }
+}
+
+// Write the config in the background unless it matches what is on disk.
+// g_file_replace_contents() writes a temp file and renames it over the old one,
+// so a crash or power cut mid-write never leaves a truncated config.
+static void start_config_write(AppData *data) {
+    gchar *contents = build_config_data(data);
+    if (!contents || g_strcmp0(contents, data->config_written) == 0) {
+        g_free(contents);
+        return;
+    }
+    
+    gchar *config_path = get_config_file_path();
+    if (!config_path) {
+        g_free(contents);
+        return;
+    }
+    
+    GFile *file = g_file_new_for_path(config_path);
+    data->config_writing = g_bytes_new_take(contents, strlen(contents));
+    data->config_write_cancellable = g_cancellable_new();
+    g_file_replace_contents_bytes_async(file, data->config_writing, NULL, FALSE, G_FILE_CREATE_NONE,
+                                        data->config_write_cancellable, config_write_done, data);
+    g_object_unref(file);
+    g_free(config_path);
+}
+
+static gboolean config_save_callback(gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    data->config_save_timer_id = 0;
+    
+    if (data->config_writing) {
+        data->config_save_again = TRUE; // Rewritten once the current write finishes
+    } else {
+        const gchar *previous_activity = watchdog_begin("config save");
+        start_config_write(data);
+        watchdog_end(previous_activity);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+// Settings changed: write them out once they have been quiet for
+// CONFIG_SAVE_DELAY_MS, so a burst of changes costs one write
+static void save_location_to_config(AppData *data) {
+    if (!data) {
+        return;
+    }
+    
+    if (data->config_save_timer_id != 0) {
+        g_source_remove(data->config_save_timer_id);
+    }
+    data->config_save_timer_id = g_timeout_add(CONFIG_SAVE_DELAY_MS, config_save_callback, data);
+}
+
+// Shutdown: write any pending change synchronously, as the main loop is gone
+static void flush_config(AppData *data) {
+    if (data->config_save_timer_id != 0) {
+        g_source_remove(data->config_save_timer_id);
+        data->config_save_timer_id = 0;
+    }
+    if (data->config_write_cancellable) {
+        g_cancellable_cancel(data->config_write_cancellable);
+        g_clear_object(&data->config_write_cancellable);
+    }
+    g_clear_pointer(&data->config_writing, g_bytes_unref);
+    
+    gchar *contents = build_config_data(data);
+    gchar *config_path = get_config_file_path();
+    if (contents && config_path && g_strcmp0(contents, data->config_written) != 0) {
+        GError *error = NULL;
+        if (!g_file_set_contents(config_path, contents, -1, &error)) {
+            g_warning("Failed to save config: %s", error ? error->message : "Unknown error");
+            g_clear_error(&error);
+        }
+    }
+    g_free(contents);
     g_free(config_path);
 }
 
+static void apply_config(AppData *data, GKeyFile *key_file);
+
 static void load_location_from_config(AppData *data) {
     if (!data) {
         return;
@@ -909,10 +1567,44 @@ static void load_location_from_config(AppData *data) {
         return;
     }
     
+    apply_config(data, key_file);
+    
+    // What is on disk now, so saving the same settings back is skipped
+    g_free(data->config_written);
+    data->config_written = build_config_data(data);
+    
+    g_key_file_unref(key_file);
+    g_free(config_path);
+}
+
+// Settings as they are with no config file. Keys other than [Location] are only
+// written when they differ from these, so a missing key means the default.
+static void set_default_settings(AppData *data) {
+    data->shared_fetch = FALSE;
+    data->http_timeout = DEFAULT_HTTP_TIMEOUT;
+    data->http_idle_timeout = DEFAULT_HTTP_IDLE_TIMEOUT;
+    data->http2 = TRUE;
+    data->dns_cache_seconds = DEFAULT_DNS_CACHE_SECONDS;
+    data->refresh_interval = UPDATE_INTERVAL_SECONDS;
+    data->refresh_jitter_max = DEFAULT_REFRESH_JITTER_SECONDS;
+    data->hours_to_show = DEFAULT_HOURS_TO_SHOW;
+    data->forecast_days = 0;
+    data->render_quality = RENDER_QUALITY_AUTO;
+    data->frame_budget_ms = DEFAULT_FRAME_BUDGET_MS;
+    data->clock_low_power = FALSE;
+    data->clock_glyph_cache = TRUE;
+    data->metrics_port = 0;
+    data->stall_threshold_ms = 0;
+    data->memory_compact = FALSE;
+}
+
+// Copy the settings present in key_file into data
+static void apply_config(AppData *data, GKeyFile *key_file) {
+    GError *error = NULL;
+    
     gchar *lat = g_key_file_get_string(key_file, "Location", "latitude", &error);
     if (lat && strlen(lat) > 0) {
-        g_free(data->location_lat);
-        data->location_lat = lat;
+        set_primary_coordinate(data, &data->locations[0].lat, lat);
     } else {
         g_free(lat);
     }
@@ -924,8 +1616,7 @@ static void load_location_from_config(AppData *data) {
     
     gchar *lon = g_key_file_get_string(key_file, "Location", "longitude", &error);
     if (lon && strlen(lon) > 0) {
-        g_free(data->location_lon);
-        data->location_lon = lon;
+        set_primary_coordinate(data, &data->locations[0].lon, lon);
     } else {
         g_free(lon);
     }
@@ -937,7 +1628,7 @@ static void load_location_from_config(AppData *data) {
     
     // Load timezone if available
     gchar *tz = g_key_file_get_string(key_file, "Location", "timezone", &error);
-    if (tz && strlen(tz) > 0) {
+    if (tz && strlen(tz) > 0 && g_strcmp0(tz, data->timezone) != 0) {
         if (data->tz) {
             g_time_zone_unref(data->tz);
         }
@@ -970,42 +1661,217 @@ static void load_location_from_config(AppData *data) {
     }
     if (error) {
         g_error_free(error);
+        error = NULL;
     }
     
-    g_key_file_unref(key_file);
-    g_free(config_path);
-}
-
-static void update_location_from_entries(AppData *data) {
-    if (!data) {
-        return;
+    // Additional locations, each shown as its own strip
+    gchar **additional = g_key_file_get_string_list(key_file, "Location", "additional", NULL, &error);
+    if (additional) {
+        gchar *text = g_strjoinv(";", additional);
+        gchar *lats[MAX_LOCATIONS - 1];
+        gchar *lons[MAX_LOCATIONS - 1];
+        guint n_pairs = parse_location_list(text, lats, lons, MAX_LOCATIONS - 1);
+        set_additional_locations(data, lats, lons, n_pairs);
+        g_free(text);
+        g_strfreev(additional);
+    } else {
+        set_additional_locations(data, NULL, NULL, 0);
     }
-    
-    if (!data->lat_entry || !data->lon_entry) {
-        return;
+    if (error) {
+        g_error_free(error);
+        error = NULL;
     }
     
-    // Safety: verify widgets are valid before casting
-    if (!GTK_IS_EDITABLE(data->lat_entry) || !GTK_IS_EDITABLE(data->lon_entry)) {
-        return;
+    // Optional shared-fetch mode (one instance fetches for all on this session bus)
+    gboolean shared = g_key_file_get_boolean(key_file, "Fetch", "shared", &error);
+    if (!error) {
+        data->shared_fetch = shared;
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    
+    // Refresh schedule: slot length and how far each device may spread into it
+    gint interval_minutes = g_key_file_get_integer(key_file, "Fetch", "interval_minutes", &error);
+    if (!error) {
+        data->refresh_interval = CLAMP((guint)MAX(interval_minutes, 0) * 60,
+                                       MIN_UPDATE_INTERVAL_SECONDS, MAX_UPDATE_INTERVAL_SECONDS);
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    gint jitter_seconds = g_key_file_get_integer(key_file, "Fetch", "jitter_seconds", &error);
+    if (!error) {
+        data->refresh_jitter_max = (guint)MAX(jitter_seconds, 0);
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    
+    // HTTP session tuning (0 disables a timeout, as in libsoup)
+    gint timeout = g_key_file_get_integer(key_file, "Network", "timeout_seconds", &error);
+    if (!error) {
+        data->http_timeout = (guint)MAX(timeout, 0);
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    gint idle_timeout = g_key_file_get_integer(key_file, "Network", "idle_timeout_seconds", &error);
+    if (!error) {
+        data->http_idle_timeout = (guint)MAX(idle_timeout, 0);
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    gboolean http2 = g_key_file_get_boolean(key_file, "Network", "http2", &error);
+    if (!error) {
+        data->http2 = http2;
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    gint dns_cache_seconds = g_key_file_get_integer(key_file, "Network", "dns_cache_seconds", &error);
+    if (!error) {
+        data->dns_cache_seconds = (guint)MAX(dns_cache_seconds, 0);
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    
+    // Local Prometheus endpoint; off unless a port is given
+    gint metrics_port = g_key_file_get_integer(key_file, "Metrics", "port", &error);
+    if (!error) {
+        data->metrics_port = (guint)CLAMP(metrics_port, 0, G_MAXUINT16);
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    
+    // Main-loop stall profiler; off unless a threshold is given
+    gint stall_ms = g_key_file_get_integer(key_file, "Watchdog", "stall_ms", &error);
+    if (!error) {
+        data->stall_threshold_ms = stall_ms > 0
+                                   ? (guint)CLAMP(stall_ms, WATCHDOG_MIN_THRESHOLD_MS, WATCHDOG_MAX_THRESHOLD_MS) : 0;
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    
+    // Small devices: trade a little allocator speed for a flat RSS over weeks of uptime
+    gboolean compact = g_key_file_get_boolean(key_file, "Memory", "compact", &error);
+    if (!error) {
+        data->memory_compact = compact;
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    
+    // Optional minute-precision clock for battery or passively cooled devices
+    gboolean low_power = g_key_file_get_boolean(key_file, "Clock", "low_power", &error);
+    if (!error) {
+        data->clock_low_power = low_power;
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    gboolean glyph_cache = g_key_file_get_boolean(key_file, "Clock", "glyph_cache", &error);
+    if (!error) {
+        data->clock_glyph_cache = glyph_cache;
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    
+    // Longer strips for wall panels: 48 h or a whole week
+    gint hours_to_show = g_key_file_get_integer(key_file, "Display", "hours_to_show", &error);
+    if (!error) {
+        data->hours_to_show = (guint)CLAMP(hours_to_show, 1, MAX_HOURS_TO_SHOW);
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    
+    // Extended view: a panel per day with its high, low and rain, up to 16 days
+    gint forecast_days = g_key_file_get_integer(key_file, "Display", "forecast_days", &error);
+    if (!error) {
+        data->forecast_days = forecast_days > 0
+                              ? (guint)CLAMP(forecast_days, MIN_EXTENDED_FORECAST_DAYS, MAX_FORECAST_DAYS) : 0;
+    }
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    
+    // Slow GPUs and software rendering: "auto" trades looks for frame time
+    gchar *render_quality = g_key_file_get_string(key_file, "Display", "render_quality", &error);
+    if (!error && render_quality) {
+        RenderQuality quality;
+        if (g_ascii_strcasecmp(render_quality, "auto") == 0) {
+            data->render_quality = RENDER_QUALITY_AUTO;
+        } else if (render_quality_from_name(render_quality, &quality)) {
+            data->render_quality = (gint)quality;
+        } else {
+            g_warning("Unknown [Display] render_quality \"%s\", using auto", render_quality);
+        }
+    }
+    g_free(render_quality);
+    if (error) {
+        g_error_free(error);
+        error = NULL;
+    }
+    gint frame_budget_ms = g_key_file_get_integer(key_file, "Display", "frame_budget_ms", &error);
+    if (!error) {
+        data->frame_budget_ms = (guint)CLAMP(frame_budget_ms, MIN_FRAME_BUDGET_MS, MAX_FRAME_BUDGET_MS);
+    }
+    if (error) {
+        g_error_free(error);
+    }
+}
+
+static void update_location_from_entries(AppData *data) {
+    if (!data) {
+        return;
+    }
+    
+    if (!data->lat_entry || !data->lon_entry) {
+        return;
+    }
+    
+    // Safety: verify widgets are valid before casting
+    if (!GTK_IS_EDITABLE(data->lat_entry) || !GTK_IS_EDITABLE(data->lon_entry)) {
+        return;
     }
     
     const gchar *lat_text = gtk_editable_get_text(GTK_EDITABLE(data->lat_entry));
     const gchar *lon_text = gtk_editable_get_text(GTK_EDITABLE(data->lon_entry));
     
     if (lat_text && strlen(lat_text) > 0) {
-        gchar *new_lat = g_strdup(lat_text);
-        if (new_lat) {
-            g_free(data->location_lat);
-            data->location_lat = new_lat;
-        }
+        set_primary_coordinate(data, &data->locations[0].lat, g_strdup(lat_text));
     }
     if (lon_text && strlen(lon_text) > 0) {
-        gchar *new_lon = g_strdup(lon_text);
-        if (new_lon) {
-            g_free(data->location_lon);
-            data->location_lon = new_lon;
-        }
+        set_primary_coordinate(data, &data->locations[0].lon, g_strdup(lon_text));
+    }
+    
+    if (data->extra_locations_entry && GTK_IS_EDITABLE(data->extra_locations_entry)) {
+        const gchar *extra_text = gtk_editable_get_text(GTK_EDITABLE(data->extra_locations_entry));
+        gchar *lats[MAX_LOCATIONS - 1];
+        gchar *lons[MAX_LOCATIONS - 1];
+        guint n_pairs = parse_location_list(extra_text, lats, lons, MAX_LOCATIONS - 1);
+        set_additional_locations(data, lats, lons, n_pairs);
+        sync_location_strips(data);
     }
     
     // Save to config file
@@ -1020,16 +1886,19 @@ static void on_location_update(GtkWidget *widget, gpointer user_data) {
     }
     
     // Reset retry counters when manually updating location
-    data->retry_count = 0;
-    data->retry_delay = 0;
-    data->is_retrying = FALSE;
+    retry_engine_reset(&data->retry);
     if (data->retry_timer_id != 0) {
         g_source_remove(data->retry_timer_id);
         data->retry_timer_id = 0;
     }
     
     update_location_from_entries(data);
-    fetch_weather(data);
+    if (data->broker) {
+        // New location, new sharing group; the role callback fetches if we own it
+        start_forecast_broker(data);
+    } else {
+        fetch_weather(data);
+    }
 }
 
 static void on_exit_clicked(GtkWidget *widget, gpointer user_data) {
@@ -1053,10 +1922,15 @@ static gboolean on_settings_window_close_request(GtkWindow *window, gpointer use
 static void on_settings_toggle(GtkWidget *widget, gpointer user_data) {
     (void)widget; // Suppress unused parameter warning
     AppData *data = (AppData *)user_data;
-    if (!data || !data->settings_window) {
+    if (!data) {
         return;
     }
     
+    // Built on first use: most boards never open it, so it stays off the startup path
+    if (!data->settings_window) {
+        create_settings_window(data);
+    }
+    
     if (gtk_widget_get_visible(data->settings_window)) {
         gtk_widget_set_visible(data->settings_window, FALSE);
     } else {
@@ -1065,6 +1939,371 @@ static void on_settings_toggle(GtkWidget *widget, gpointer user_data) {
     }
 }
 
+// --- Place search (settings window) ---
+
+static gchar* get_places_file_path(void) {
+    const gchar *home_dir = g_get_home_dir();
+    if (home_dir) {
+        return g_build_filename(home_dir, PLACES_FILE_NAME, NULL);
+    }
+    return g_strdup(PLACES_FILE_NAME);
+}
+
+static PlaceIndex* load_place_index(void) {
+    PlaceIndex *index = place_index_new();
+    gchar *path = get_places_file_path();
+    GError *error = NULL;
+    GMappedFile *mapped = g_mapped_file_new(path, FALSE, &error);
+    if (!mapped) {
+        if (!g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+            g_warning("Failed to open place index: %s", error ? error->message : "Unknown error");
+        }
+        g_clear_error(&error);
+        g_free(path);
+        return index;
+    }
+    
+    if (place_index_load(index, g_mapped_file_get_contents(mapped), g_mapped_file_get_length(mapped))) {
+        g_debug("Place index: %u place(s) from %s", place_index_get_size(index), path);
+    } else {
+        g_warning("Ignoring place index %s: other version or damaged", path);
+    }
+    g_mapped_file_unref(mapped);
+    g_free(path);
+    return index;
+}
+
+static void start_places_write(AppData *data);
+
+static void places_write_done(GObject *source, GAsyncResult *result, gpointer user_data) {
+    GError *error = NULL;
+    gboolean ok = g_file_replace_contents_finish(G_FILE(source), result, NULL, &error);
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_error_free(error);
+        return; // Shutting down; flush_place_index() took over
+    }
+    
+    AppData *data = (AppData *)user_data;
+    if (!ok) {
+        // Tried again with the next change, or at shutdown
+        g_warning("Failed to save place index: %s", error ? error->message : "Unknown error");
+        g_clear_error(&error);
+        data->places_dirty = TRUE;
+    }
+    g_clear_pointer(&data->places_writing, g_bytes_unref);
+    g_clear_object(&data->places_write_cancellable);
+    
+    if (data->places_save_again) {
+        data->places_save_again = FALSE;
+        start_places_write(data);
+    }
+}
+
+// Write the index in the background, like the config (see start_config_write())
+static void start_places_write(AppData *data) {
+    if (!data->places_dirty || !data->places) {
+        return;
+    }
+    data->places_dirty = FALSE;
+    
+    gchar *path = get_places_file_path();
+    GFile *file = g_file_new_for_path(path);
+    data->places_writing = place_index_encode(data->places);
+    data->places_write_cancellable = g_cancellable_new();
+    g_file_replace_contents_bytes_async(file, data->places_writing, NULL, FALSE, G_FILE_CREATE_NONE,
+                                        data->places_write_cancellable, places_write_done, data);
+    g_object_unref(file);
+    g_free(path);
+}
+
+static gboolean places_save_callback(gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    data->places_save_timer_id = 0;
+    
+    if (data->places_writing) {
+        data->places_save_again = TRUE; // Rewritten once the current write finishes
+    } else {
+        const gchar *previous_activity = watchdog_begin("place index save");
+        start_places_write(data);
+        watchdog_end(previous_activity);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+// A search found something new. The index (a few hundred KB at most) is
+// written once searches have paused for PLACES_SAVE_DELAY_MS, so typing out
+// a name costs one write.
+static void save_place_index(AppData *data) {
+    data->places_dirty = TRUE;
+    if (data->places_save_timer_id != 0) {
+        g_source_remove(data->places_save_timer_id);
+    }
+    data->places_save_timer_id = g_timeout_add(PLACES_SAVE_DELAY_MS, places_save_callback, data);
+}
+
+// Shutdown: write any pending change synchronously, as the main loop is gone
+static void flush_place_index(AppData *data) {
+    if (data->places_save_timer_id != 0) {
+        g_source_remove(data->places_save_timer_id);
+        data->places_save_timer_id = 0;
+    }
+    if (data->places_write_cancellable) {
+        g_cancellable_cancel(data->places_write_cancellable);
+        g_clear_object(&data->places_write_cancellable);
+        data->places_dirty = TRUE;  // The cancelled write may not have landed
+    }
+    g_clear_pointer(&data->places_writing, g_bytes_unref);
+    if (!data->places_dirty || !data->places) {
+        return;
+    }
+    
+    GBytes *bytes = place_index_encode(data->places);
+    gsize length = 0;
+    const gchar *contents = g_bytes_get_data(bytes, &length);
+    gchar *path = get_places_file_path();
+    GError *error = NULL;
+    if (!g_file_set_contents(path, contents, (gssize)length, &error)) {
+        g_warning("Failed to save place index: %s", error ? error->message : "Unknown error");
+        g_clear_error(&error);
+    }
+    data->places_dirty = FALSE;
+    g_free(path);
+    g_bytes_unref(bytes);
+}
+
+static void format_place(const GeocodePlace *place, gchar *out, gsize out_len) {
+    g_strlcpy(out, place->name, out_len);
+    // "Springfield, Illinois, United States"; the region is left out when it repeats the name
+    if (place->admin1[0] != '\0' && strcmp(place->admin1, place->name) != 0) {
+        g_strlcat(out, ", ", out_len);
+        g_strlcat(out, place->admin1, out_len);
+    }
+    if (place->country[0] != '\0') {
+        g_strlcat(out, ", ", out_len);
+        g_strlcat(out, place->country, out_len);
+    }
+}
+
+// Show what the index knows for the current search text. Runs on every
+// keystroke, so the rows are only rebuilt when the places actually change.
+// failure (may be NULL) is shown instead of "No places found".
+static void update_search_results(AppData *data, const gchar *failure) {
+    if (!data->search_entry || !data->search_results || !data->places) {
+        return;
+    }
+    
+    const gchar *text = gtk_editable_get_text(GTK_EDITABLE(data->search_entry));
+    gchar key[GEOCODE_KEY_MAX];
+    geocode_normalize(text, key, sizeof(key));
+    GeocodePlace places[GEOCODE_MAX_RESULTS];
+    guint n_places = place_index_lookup(data->places, text, places, GEOCODE_MAX_RESULTS);
+    
+    if (n_places != data->n_search_places ||
+        memcmp(places, data->search_places, n_places * sizeof(GeocodePlace)) != 0) {
+        GtkWidget *row;
+        while ((row = gtk_widget_get_first_child(data->search_results)) != NULL) {
+            gtk_list_box_remove(GTK_LIST_BOX(data->search_results), row);
+        }
+        for (guint i = 0; i < n_places; i++) {
+            gchar label_text[3 * GEOCODE_TEXT_MAX + 8];
+            format_place(&places[i], label_text, sizeof(label_text));
+            GtkWidget *label = gtk_label_new(label_text);
+            gtk_widget_set_halign(label, GTK_ALIGN_START);
+            gtk_list_box_append(GTK_LIST_BOX(data->search_results), label);
+        }
+        memcpy(data->search_places, places, n_places * sizeof(GeocodePlace));
+        data->n_search_places = n_places;
+        gtk_widget_set_visible(gtk_widget_get_parent(data->search_results), n_places > 0);
+    }
+    
+    const gchar *status = "";
+    if (n_places == 0 && strlen(key) >= GEOCODE_MIN_QUERY) {
+        gboolean pending = data->geocode_timer_id != 0 || data->geocode_cancellable != NULL;
+        status = pending ? "Searching..." : failure ? failure : "No places found";
+    }
+    gtk_label_set_text(GTK_LABEL(data->search_status), status);
+}
+
+static void on_geocode_response(GObject *source_object, GAsyncResult *res, gpointer user_data) {
+    SoupMessage *msg = SOUP_MESSAGE(user_data);
+    AppData *data = (AppData *)g_object_get_data(G_OBJECT(msg), "app-data");
+    GError *error = NULL;
+    GBytes *body_bytes = soup_session_send_and_read_finish(SOUP_SESSION(source_object), res, &error);
+    
+    // Superseded by a newer search, or shutting down
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) || !data || !data->session) {
+        g_clear_error(&error);
+        if (body_bytes) {
+            g_bytes_unref(body_bytes);
+        }
+        g_object_unref(msg);
+        return;
+    }
+    g_clear_object(&data->geocode_cancellable);
+    
+    const gchar *query = (const gchar *)g_object_get_data(G_OBJECT(msg), "query");
+    gchar failure[FORECAST_ERROR_MAX] = "";
+    if (error) {
+        g_warning("Place search for \"%s\" failed: %s", query, error->message);
+        g_snprintf(failure, sizeof(failure), "Place search failed: %s", error->message);
+        g_error_free(error);
+    } else {
+        // Failures are parsed too: Open-Meteo explains a rejected search in JSON
+        gsize length = 0;
+        const gchar *body = body_bytes ? (const gchar *)g_bytes_get_data(body_bytes, &length) : NULL;
+        GeocodePlace places[GEOCODE_MAX_RESULTS];
+        guint n_places = 0;
+        const gchar *previous_activity = watchdog_begin("place search");
+        GeocodeParseResult result = geocode_parse(body, length, places, GEOCODE_MAX_RESULTS, &n_places,
+                                                  failure, sizeof(failure));
+        if (result == GEOCODE_PARSE_OK) {
+            g_debug("Place search for \"%s\": %u place(s)", query, n_places);
+            if (place_index_add(data->places, query, places, n_places)) {
+                save_place_index(data);
+            }
+        } else {
+            g_warning("Place search for \"%s\" failed (HTTP %u): %s", query, soup_message_get_status(msg),
+                      failure);
+        }
+        watchdog_end(previous_activity);
+    }
+    
+    // Typing may have moved on meanwhile; the index now holds this answer either way
+    update_search_results(data, failure[0] != '\0' ? failure : NULL);
+    if (body_bytes) {
+        g_bytes_unref(body_bytes);
+    }
+    g_object_unref(msg);
+}
+
+// Place searches have their own session: the forecast session only ever
+// connects to WEATHER_API_HOST
+static SoupSession* create_geocode_session(AppData *data) {
+    GSocketConnectable *address = g_network_address_new(GEOCODING_API_HOST, 443);
+    SoupSession *session = soup_session_new_with_options("timeout", data->http_timeout,
+                                                         "idle-timeout", data->http_idle_timeout,
+                                                         "remote-connectable", address,
+                                                         NULL);
+    g_object_unref(address);
+    return session;
+}
+
+static gboolean geocode_search_callback(gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    data->geocode_timer_id = 0;
+    if (!data->session || !data->search_entry) {
+        return G_SOURCE_REMOVE;
+    }
+    
+    const gchar *query = gtk_editable_get_text(GTK_EDITABLE(data->search_entry));
+    
+    // The search that is still running was for older text
+    if (data->geocode_cancellable) {
+        g_cancellable_cancel(data->geocode_cancellable);
+        g_clear_object(&data->geocode_cancellable);
+    }
+    if (!data->geocode_session) {
+        data->geocode_session = create_geocode_session(data);
+    }
+    
+    gchar *escaped = g_uri_escape_string(query, NULL, FALSE);
+    gchar *url = g_strdup_printf("https://" GEOCODING_API_HOST "/v1/search?name=%s&count=%d&language=en&format=json",
+                                 escaped, GEOCODE_MAX_RESULTS);
+    g_free(escaped);
+    SoupMessage *msg = data->geocode_session ? soup_message_new("GET", url) : NULL;
+    g_free(url);
+    if (!msg) {
+        g_warning("Failed to create place search request");
+        update_search_results(data, "Place search unavailable");
+        return G_SOURCE_REMOVE;
+    }
+    if (!data->http2) {
+        soup_message_set_force_http1(msg, TRUE);
+    }
+    
+    g_debug("Searching places for \"%s\"", query);
+    g_object_set_data(G_OBJECT(msg), "app-data", data);
+    g_object_set_data_full(G_OBJECT(msg), "query", g_strdup(query), g_free);
+    data->geocode_cancellable = g_cancellable_new();
+    soup_session_send_and_read_async(data->geocode_session, msg, G_PRIORITY_DEFAULT, data->geocode_cancellable,
+                                     on_geocode_response, msg);
+    return G_SOURCE_REMOVE;
+}
+
+// Answered from the index right away; the API is only asked, once typing
+// pauses, for text the index has never fully answered
+static void on_search_changed(GtkEditable *editable, gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    if (!data || !data->places) {
+        return;
+    }
+    
+    if (data->geocode_timer_id != 0) {
+        g_source_remove(data->geocode_timer_id);
+        data->geocode_timer_id = 0;
+    }
+    const gchar *text = gtk_editable_get_text(editable);
+    gchar key[GEOCODE_KEY_MAX];
+    geocode_normalize(text, key, sizeof(key));
+    if (strlen(key) >= GEOCODE_MIN_QUERY && !place_index_covers(data->places, text)) {
+        data->geocode_timer_id = g_timeout_add(GEOCODE_DEBOUNCE_MS, geocode_search_callback, data);
+    }
+    update_search_results(data, NULL);
+}
+
+// Switch the clock to a place's zone now rather than when its forecast arrives
+static void set_clock_timezone(AppData *data, const gchar *identifier) {
+    if (identifier[0] == '\0' || g_strcmp0(identifier, data->timezone) == 0) {
+        return;
+    }
+    GTimeZone *tz = g_time_zone_new_identifier(identifier);
+    if (!tz) {
+        g_debug("Timezone '%s' not available, waiting for the forecast's UTC offset", identifier);
+        return;
+    }
+    
+    if (data->tz) {
+        g_time_zone_unref(data->tz);
+    }
+    data->tz = tz;
+    g_free(data->timezone);
+    data->timezone = g_strdup(identifier);
+    // The old location's offset would be wrong as a fallback until the next fetch
+    GDateTime *now = g_date_time_new_now(tz);
+    data->utc_offset_seconds = (gint)(g_date_time_get_utc_offset(now) / G_USEC_PER_SEC);
+    g_date_time_unref(now);
+    g_info("Using timezone: %s", identifier);
+    
+    data->clock_day = G_MININT64;  // The date may differ in the new zone
+    update_clock(data);
+    if (data->clock_timer_id != 0) {
+        g_source_remove(data->clock_timer_id);
+        data->clock_timer_id = g_timeout_add(clock_tick_delay_ms(data), update_clock_callback, data);
+    }
+}
+
+static void on_search_result_activated(GtkListBox *box, GtkListBoxRow *row, gpointer user_data) {
+    (void)box;
+    AppData *data = (AppData *)user_data;
+    gint index = gtk_list_box_row_get_index(row);
+    if (!data || !data->lat_entry || !data->lon_entry || index < 0 || (guint)index >= data->n_search_places) {
+        return;
+    }
+    
+    const GeocodePlace *place = &data->search_places[index];
+    gchar lat[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar lon[G_ASCII_DTOSTR_BUF_SIZE];
+    g_ascii_formatd(lat, sizeof(lat), "%.4f", place->latitude);
+    g_ascii_formatd(lon, sizeof(lon), "%.4f", place->longitude);
+    gtk_editable_set_text(GTK_EDITABLE(data->lat_entry), lat);
+    gtk_editable_set_text(GTK_EDITABLE(data->lon_entry), lon);
+    g_info("Location set to %s (%s, %s)", place->name, lat, lon);
+    
+    set_clock_timezone(data, place->timezone);
+    // Saves the coordinates and zone, then fetches as if "Update Location" was clicked
+    on_location_update(NULL, data);
+}
+
 // Create settings window with location inputs
 static void create_settings_window(AppData *data) {
     if (!data) {
@@ -1097,6 +2336,40 @@ static void create_settings_window(AppData *data) {
     gtk_widget_set_halign(title_label, GTK_ALIGN_START);
     gtk_box_append(GTK_BOX(main_box), title_label);
     
+    // Place search: picking a result fills in the coordinates below and the clock's zone
+    if (!data->places) {
+        data->places = load_place_index();
+    }
+    GtkWidget *search_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+    gtk_widget_add_css_class(search_box, "location-box");
+    
+    GtkWidget *search_label = gtk_label_new("Search:");
+    data->search_entry = gtk_search_entry_new();
+    g_object_set(data->search_entry, "placeholder-text", "City or town", NULL);
+    gtk_widget_set_hexpand(data->search_entry, TRUE);
+    g_signal_connect(data->search_entry, "changed", G_CALLBACK(on_search_changed), data);
+    data->search_status = gtk_label_new("");
+    gtk_widget_add_css_class(data->search_status, "search-status");
+    
+    gtk_box_append(GTK_BOX(search_box), search_label);
+    gtk_box_append(GTK_BOX(search_box), data->search_entry);
+    gtk_box_append(GTK_BOX(search_box), data->search_status);
+    gtk_box_append(GTK_BOX(main_box), search_box);
+    
+    data->search_results = gtk_list_box_new();
+    gtk_list_box_set_selection_mode(GTK_LIST_BOX(data->search_results), GTK_SELECTION_NONE);
+    gtk_widget_add_css_class(data->search_results, "search-results");
+    g_signal_connect(data->search_results, "row-activated", G_CALLBACK(on_search_result_activated), data);
+    data->n_search_places = 0;
+    
+    GtkWidget *results_scroller = gtk_scrolled_window_new();
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(results_scroller), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_scrolled_window_set_propagate_natural_height(GTK_SCROLLED_WINDOW(results_scroller), TRUE);
+    gtk_scrolled_window_set_max_content_height(GTK_SCROLLED_WINDOW(results_scroller), 240);
+    gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(results_scroller), data->search_results);
+    gtk_widget_set_visible(results_scroller, FALSE);  // Shown while there are results
+    gtk_box_append(GTK_BOX(main_box), results_scroller);
+    
     // Location input section
     GtkWidget *location_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
     gtk_widget_set_halign(location_box, GTK_ALIGN_CENTER);
@@ -1105,12 +2378,12 @@ static void create_settings_window(AppData *data) {
     GtkWidget *lat_label = gtk_label_new("Latitude:");
     data->lat_entry = gtk_entry_new();
     gtk_entry_set_placeholder_text(GTK_ENTRY(data->lat_entry), "52.52");
-    gtk_editable_set_text(GTK_EDITABLE(data->lat_entry), data->location_lat ? data->location_lat : "");
+    gtk_editable_set_text(GTK_EDITABLE(data->lat_entry), data->locations[0].lat ? data->locations[0].lat : "");
     
     GtkWidget *lon_label = gtk_label_new("Longitude:");
     data->lon_entry = gtk_entry_new();
     gtk_entry_set_placeholder_text(GTK_ENTRY(data->lon_entry), "13.41");
-    gtk_editable_set_text(GTK_EDITABLE(data->lon_entry), data->location_lon ? data->location_lon : "");
+    gtk_editable_set_text(GTK_EDITABLE(data->lon_entry), data->locations[0].lon ? data->locations[0].lon : "");
     
     GtkWidget *update_btn = gtk_button_new_with_label("Update Location");
     g_signal_connect(update_btn, "clicked", G_CALLBACK(on_location_update), data);
@@ -1123,6 +2396,22 @@ static void create_settings_window(AppData *data) {
     
     gtk_box_append(GTK_BOX(main_box), location_box);
     
+    // Further locations, each shown as its own strip below the primary one
+    GtkWidget *extra_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+    gtk_widget_add_css_class(extra_box, "location-box");
+    
+    GtkWidget *extra_label = gtk_label_new("Additional locations:");
+    data->extra_locations_entry = gtk_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(data->extra_locations_entry), "40.71,-74.01; 51.51,-0.13");
+    gchar *extra_text = format_additional_locations(data);
+    gtk_editable_set_text(GTK_EDITABLE(data->extra_locations_entry), extra_text);
+    g_free(extra_text);
+    gtk_widget_set_hexpand(data->extra_locations_entry, TRUE);
+    
+    gtk_box_append(GTK_BOX(extra_box), extra_label);
+    gtk_box_append(GTK_BOX(extra_box), data->extra_locations_entry);
+    gtk_box_append(GTK_BOX(main_box), extra_box);
+    
     // Close button
     GtkWidget *close_btn = gtk_button_new_with_label("Close");
     gtk_widget_set_halign(close_btn, GTK_ALIGN_END);
@@ -1130,177 +2419,1245 @@ static void create_settings_window(AppData *data) {
     g_signal_connect(close_btn, "clicked", G_CALLBACK(on_settings_toggle), data);
     gtk_box_append(GTK_BOX(main_box), close_btn);
     
-    // Initially hide the window
-    gtk_widget_set_visible(data->settings_window, FALSE);
+    // Initially hide the window
+    gtk_widget_set_visible(data->settings_window, FALSE);
+}
+
+// Retry callback for failed weather fetches
+static gboolean retry_fetch_weather(gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    if (!data) {
+        return G_SOURCE_REMOVE;
+    }
+    
+    // Safety check: ensure session is still valid (indicates app is still running)
+    if (!data->session) {
+        return G_SOURCE_REMOVE;
+    }
+    
+    // Timer has fired, clear the ID before calling fetch
+    data->retry_timer_id = 0;
+    
+    // A failure that landed after the display went away; resuming refetches instead
+    if (data->display_suspended) {
+        return G_SOURCE_REMOVE;
+    }
+    
+    if (data->retry.retrying) {
+        g_info("Retrying weather fetch (attempt %u/%d)...", data->retry.attempt, RETRY_MAX_ATTEMPTS);
+    }
+    fetch_weather(data);
+    
+    return G_SOURCE_REMOVE;
+}
+
+// Every request goes to WEATHER_API_HOST, so one GNetworkAddress shared by the
+// whole session doubles as the DNS cache: new connections (keep-alive won't
+// survive an hourly interval) reuse its resolved addresses, and GIO re-resolves
+// when the system resolver configuration changes. TLS session tickets are kept
+// per process by the TLS backend, so reconnects resume instead of doing a full
+// handshake, across session renewals too.
+static SoupSession* create_soup_session(AppData *data) {
+    GSocketConnectable *api_address = g_network_address_new(WEATHER_API_HOST, 443);
+    SoupSession *session = soup_session_new_with_options("timeout", data->http_timeout,
+                                                         "idle-timeout", data->http_idle_timeout,
+                                                         "remote-connectable", api_address,
+                                                         NULL);
+    g_object_unref(api_address);
+    if (!session) {
+        return NULL;
+    }
+    
+    // Negotiate gzip/deflate (and brotli when libsoup was built with it);
+    // libsoup 3 normally installs the decoder already, older builds may not
+    if (!soup_session_has_feature(session, SOUP_TYPE_CONTENT_DECODER)) {
+        soup_session_add_feature_by_type(session, SOUP_TYPE_CONTENT_DECODER);
+    }
+    
+    data->session_created_at = g_get_monotonic_time() / G_USEC_PER_SEC;
+    return session;
+}
+
+// The cached addresses never expire on their own; rebuild the session once they
+// are dns_cache_seconds old, or right away when the last failure suggests the
+// address is wrong. Called just before sending, after the previous request was
+// cancelled, so nothing is left in flight on the old session.
+static void renew_soup_session_if_stale(AppData *data) {
+    gint64 age = g_get_monotonic_time() / G_USEC_PER_SEC - data->session_created_at;
+    FetchErrorClass last_error = data->retry.last_error;
+    gboolean address_suspect = last_error == FETCH_ERROR_DNS || last_error == FETCH_ERROR_CONNECT ||
+                               last_error == FETCH_ERROR_TIMEOUT;
+    if (age < (gint64)data->dns_cache_seconds && !address_suspect && !data->session_outdated) {
+        return;
+    }
+    
+    SoupSession *session = create_soup_session(data);
+    if (!session) {
+        return;  // Keep using the old one
+    }
+    g_debug("Renewed HTTP session (%s)", address_suspect ? "after connection failure" :
+            data->session_outdated ? "network settings changed" : "DNS cache expired");
+    data->session_outdated = FALSE;
+    g_object_unref(data->session);
+    data->session = session;
+}
+
+static void fetch_weather(AppData *data) {
+    if (!data || !data->session) {
+        return;
+    }
+    
+    // Shared-fetch subscribers never hit the network; the owner's snapshots keep
+    // them current, so a scheduled refresh only moves the strip to the current hour.
+    // While the role is still pending, the broker's role callback starts the fetch.
+    if (forecast_broker_get_role(data->broker) != FORECAST_BROKER_OWNER) {
+        render_all_locations(data);
+        return;
+    }
+    
+    // While the circuit breaker is open, the upstream gets a rest; the retry timer
+    // probes it when the cooldown ends
+    if (!retry_engine_allow_request(&data->retry, g_get_real_time() / G_USEC_PER_SEC)) {
+        g_debug("Circuit open, skipping weather fetch");
+        render_all_locations(data);
+        show_retry_state(data);
+        return;
+    }
+    
+    // Cancel any pending request (and its in-flight decode) before starting a new one
+    if (data->fetch_cancellable) {
+        g_cancellable_cancel(data->fetch_cancellable);
+        g_object_unref(data->fetch_cancellable);
+        data->fetch_cancellable = NULL;
+    }
+    if (data->pending_message) {
+        g_object_unref(data->pending_message);
+        data->pending_message = NULL;
+    }
+    
+    // Only reset retry state if this is a FRESH fetch, not a retry
+    // (the engine marks itself retrying when handle_fetch_failure() schedules one)
+    if (!data->retry.retrying) {
+        // Cancel any pending retry timer to avoid duplicate fetches
+        if (data->retry_timer_id != 0) {
+            g_source_remove(data->retry_timer_id);
+            data->retry_timer_id = 0;
+        }
+        
+        // Reset retry state for fresh fetches
+        retry_engine_reset(&data->retry);
+    }
+    
+    // Get location from entries if available, otherwise use stored values
+    const gchar *lat = data->locations[0].lat ? data->locations[0].lat : "52.52";
+    const gchar *lon = data->locations[0].lon ? data->locations[0].lon : "13.41";
+    
+    if (data->lat_entry && GTK_IS_EDITABLE(data->lat_entry)) {
+        const gchar *lat_text = gtk_editable_get_text(GTK_EDITABLE(data->lat_entry));
+        if (lat_text && strlen(lat_text) > 0) {
+            lat = lat_text;
+        }
+    }
+    if (data->lon_entry && GTK_IS_EDITABLE(data->lon_entry)) {
+        const gchar *lon_text = gtk_editable_get_text(GTK_EDITABLE(data->lon_entry));
+        if (lon_text && strlen(lon_text) > 0) {
+            lon = lon_text;
+        }
+    }
+    
+    // Validate lat/lon are reasonable (prevent buffer overflow in URL)
+    if (strlen(lat) > 20 || strlen(lon) > 20) {
+        g_warning("Latitude or longitude too long, using defaults");
+        lat = "52.52";
+        lon = "13.41";
+    }
+    
+    // All locations go into one request as comma-separated coordinate lists;
+    // Open-Meteo answers with one forecast object per coordinate pair, in order.
+    // Additional locations were length-checked when they were parsed.
+    char lat_list[MAX_LOCATIONS * 22];
+    char lon_list[MAX_LOCATIONS * 22];
+    g_strlcpy(lat_list, lat, sizeof(lat_list));
+    g_strlcpy(lon_list, lon, sizeof(lon_list));
+    for (guint i = 1; i < data->n_locations; i++) {
+        g_strlcat(lat_list, ",", sizeof(lat_list));
+        g_strlcat(lat_list, data->locations[i].lat, sizeof(lat_list));
+        g_strlcat(lon_list, ",", sizeof(lon_list));
+        g_strlcat(lon_list, data->locations[i].lon, sizeof(lon_list));
+    }
+    
+    char url[512];
+    // Days start at local midnight, so one more than the strip spans: late in the
+    // day (e.g. 19:00-23:00) the default 6 hours already reach into tomorrow.
+    // The day panels are aggregated from the hours, so they only add days and
+    // the precipitation column, not a second (daily) request.
+    guint forecast_days = MIN((data->hours_to_show + 23) / 24 + 1, MAX_FORECAST_DAYS);
+    forecast_days = MAX(forecast_days, data->forecast_days);
+    int url_len = snprintf(url, sizeof(url), 
+             "https://" WEATHER_API_HOST "/v1/forecast?latitude=%s&longitude=%s&hourly=temperature_2m,weathercode%s&forecast_days=%u&timezone=auto",
+             lat_list, lon_list, data->forecast_days > 0 ? ",precipitation" : "", forecast_days);
+    
+    if (url_len < 0 || url_len >= (int)sizeof(url)) {
+        g_warning("URL construction failed or truncated");
+        return;
+    }
+    
+    g_debug("Fetching weather from: %s", url);
+    
+    SoupMessage *msg = soup_message_new("GET", url);
+    if (!msg) {
+        g_warning("Failed to create SoupMessage");
+        return;
+    }
+    
+    // Conditional request: only valid while we still hold the forecast they describe
+    if (have_all_forecasts(data) && data->validator_url && strcmp(data->validator_url, url) == 0) {
+        SoupMessageHeaders *headers = soup_message_get_request_headers(msg);
+        if (data->etag) {
+            soup_message_headers_replace(headers, "If-None-Match", data->etag);
+        }
+        if (data->last_modified) {
+            soup_message_headers_replace(headers, "If-Modified-Since", data->last_modified);
+        }
+    }
+    
+    // Wire vs. decoded body sizes for the bytes-saved counters, and phase timings
+    soup_message_add_flags(msg, SOUP_MESSAGE_COLLECT_METRICS);
+    
+    // libsoup negotiates HTTP/2 over ALPN by default; some middleboxes mangle it
+    if (!data->http2) {
+        soup_message_set_force_http1(msg, TRUE);
+    }
+    
+    renew_soup_session_if_stale(data);
+    
+    // Store data pointer in message user_data for callback
+    g_object_set_data(G_OBJECT(msg), "app-data", data);
+    g_object_set_data_full(G_OBJECT(msg), "request-url", g_strdup(url), g_free);
+    data->pending_message = msg;  // Track pending message
+    data->fetch_cancellable = g_cancellable_new();  // Covers both the request and its decode
+    g_object_ref(msg);  // Keep a reference until callback completes
+    soup_session_send_and_read_async(data->session, msg, G_PRIORITY_DEFAULT, data->fetch_cancellable,
+                                     on_weather_response, msg);
+}
+
+static gboolean update_clock_callback(gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    if (!data) {
+        return G_SOURCE_REMOVE;
+    }
+    
+    // This one-shot source is finished either way
+    data->clock_timer_id = 0;
+    
+    // Safety check: ensure session is still valid (indicates app is still running)
+    if (!data->session) {
+        return G_SOURCE_REMOVE;
+    }
+    
+    // Suspended while nothing is visible; resuming re-arms the tick
+    if (data->display_suspended) {
+        return G_SOURCE_REMOVE;
+    }
+    
+    // The tick was aimed CLOCK_TICK_SLACK_MS past a boundary; early or late, how far off it is
+    gint64 period = (data->clock_low_power ? 60 : 1) * G_USEC_PER_SEC;
+    gint64 off = g_get_real_time() % period - CLOCK_TICK_SLACK_MS * 1000;
+    if (off > period / 2) {
+        off -= period;
+    }
+    metrics_histogram_observe(&data->histograms.clock_jitter, (gdouble)ABS(off) / G_USEC_PER_SEC);
+    
+    const gchar *previous_activity = watchdog_begin("clock tick");
+    update_clock(data);
+    watchdog_end(previous_activity);
+    data->clock_timer_id = g_timeout_add(clock_tick_delay_ms(data), update_clock_callback, data);
+    return G_SOURCE_REMOVE;
+}
+
+// Stable per-device offset in [0, refresh_jitter_max) so a fleet of clocks
+// spreads its refreshes over the slot instead of all firing at :00. Seeded from
+// the machine ID (host name where there is none, e.g. on Windows).
+static guint compute_refresh_offset(AppData *data) {
+    if (data->refresh_jitter_max == 0) {
+        return 0;
+    }
+    
+    static const gchar *machine_id_paths[] = { "/etc/machine-id", "/var/lib/dbus/machine-id" };
+    gchar *seed = NULL;
+    for (gsize i = 0; i < G_N_ELEMENTS(machine_id_paths) && !seed; i++) {
+        if (g_file_get_contents(machine_id_paths[i], &seed, NULL, NULL)) {
+            g_strstrip(seed);
+            if (seed[0] == '\0') {
+                g_clear_pointer(&seed, g_free);
+            }
+        }
+    }
+    if (!seed) {
+        seed = g_strdup(g_get_host_name());
+    }
+    
+    guint offset = g_str_hash(seed) % data->refresh_jitter_max;
+    g_free(seed);
+    return offset;
+}
+
+// Seconds until this device's next refresh: slots start at multiples of
+// refresh_interval (the top of the hour by default), each shifted by the
+// device's offset. Always at least 1.
+static guint seconds_until_next_refresh(AppData *data) {
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    gint64 next = now - now % data->refresh_interval + data->refresh_offset;
+    while (next <= now) {
+        next += data->refresh_interval;
+    }
+    return (guint)(next - now);
+}
+
+static gboolean update_weather_callback(gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    if (!data) {
+        return G_SOURCE_REMOVE;
+    }
+    
+    // Safety check: ensure session is still valid (indicates app is still running)
+    if (!data->session) {
+        return G_SOURCE_REMOVE;
+    }
+    
+    // This one-shot timer is done; the next one is scheduled below
+    data->weather_timer_id = 0;
+    
+    // Nobody is looking; resuming fetches if the forecast went stale meanwhile
+    if (data->display_suspended) {
+        return G_SOURCE_REMOVE;
+    }
+    
+    // Cache-Control said the current forecast is still fresh: don't ask again yet
+    if (have_all_forecasts(data) && g_get_real_time() / G_USEC_PER_SEC < data->fresh_until) {
+        g_debug("Forecast fresh per Cache-Control, skipping this refresh");
+        render_all_locations(data);
+    } else {
+        fetch_weather(data);
+    }
+    
+    // Re-derived from the clock each time, so the schedule never drifts
+    data->weather_timer_id = g_timeout_add_seconds(seconds_until_next_refresh(data), update_weather_callback, data);
+    
+    return G_SOURCE_REMOVE; // Remove the one-time timer
+}
+
+static gchar* get_cache_file_path(void) {
+    const gchar *home_dir = g_get_home_dir();
+    if (home_dir) {
+        return g_build_filename(home_dir, CACHE_FILE_NAME, NULL);
+    }
+    return g_strdup(CACHE_FILE_NAME);
+}
+
+// Key identifying which location a cached forecast belongs to
+static gchar* get_location_key(const LocationStrip *location) {
+    return g_strdup_printf("%s,%s", location->lat ? location->lat : "", location->lon ? location->lon : "");
+}
+
+// Key for the whole batch ("lat,lon;lat,lon;..."); instances only share fetches
+// with others showing exactly the same locations
+static gchar* get_batch_location_key(AppData *data) {
+    GString *key = g_string_new(NULL);
+    for (guint i = 0; i < data->n_locations; i++) {
+        gchar *location_key = get_location_key(&data->locations[i]);
+        if (i > 0) {
+            g_string_append_c(key, ';');
+        }
+        g_string_append(key, location_key);
+        g_free(location_key);
+    }
+    return g_string_free(key, FALSE);
+}
+
+// The current forecasts in the on-disk cache format, one record per location,
+// which is also what shared-fetch mode sends over D-Bus
+static GBytes* encode_current_forecasts(AppData *data) {
+    GByteArray *buffer = g_byte_array_new();
+    for (guint i = 0; i < data->n_locations; i++) {
+        LocationStrip *location = &data->locations[i];
+        if (!location->forecast) {
+            continue;
+        }
+        gchar *location_key = get_location_key(location);
+        GBytes *record = forecast_cache_encode(location->forecast, location_key, data->forecast_fetched_at);
+        g_byte_array_append(buffer, g_bytes_get_data(record, NULL), (guint)g_bytes_get_size(record));
+        g_bytes_unref(record);
+        g_free(location_key);
+    }
+    return g_byte_array_free_to_bytes(buffer);
+}
+
+// Decode records written by encode_current_forecasts() (from the cache file or a
+// shared-fetch snapshot). Returns NULL, with the reason logged, unless they cover
+// exactly the configured locations in order.
+static ForecastSnapshot* decode_stored_forecasts(AppData *data, const guint8 *contents, gsize length,
+                                                 const gchar *source, gint64 *fetched_at) {
+    if (!contents || length == 0) {
+        g_info("Ignoring empty %s", source);
+        return NULL;
+    }
+    
+    ForecastSnapshot *snapshot = take_snapshot(data, data->n_locations);
+    gsize offset = 0;
+    for (guint i = 0; i < snapshot->n_forecasts; i++) {
+        gchar location[FORECAST_CACHE_LOCATION_MAX];
+        gsize record_length = 0;
+        if (!forecast_cache_decode(snapshot->forecasts[i], contents + offset, length - offset,
+                                   location, sizeof(location), fetched_at, &record_length)) {
+            g_info("Ignoring unreadable or outdated %s", source);
+            release_snapshot(data, snapshot);
+            return NULL;
+        }
+        
+        gchar *location_key = get_location_key(&data->locations[i]);
+        gboolean matches = strcmp(location, location_key) == 0;
+        if (!matches) {
+            g_info("Ignoring %s for %s (location %u is %s)", source, location, i + 1, location_key);
+        }
+        g_free(location_key);
+        if (!matches) {
+            release_snapshot(data, snapshot);
+            return NULL;
+        }
+        
+        snapshot->start_index[i] = find_start_index(snapshot->forecasts[i]);
+        offset += record_length;
+    }
+    if (offset != length) {
+        g_info("Ignoring %s for a different number of locations", source);
+        release_snapshot(data, snapshot);
+        return NULL;
+    }
+    
+    snapshot->result = FORECAST_PARSE_OK;
+    return snapshot;
+}
+
+static void save_forecast_cache(GBytes *bytes) {
+    gchar *cache_path = get_cache_file_path();
+    gsize length = 0;
+    const gchar *contents = g_bytes_get_data(bytes, &length);
+    GError *error = NULL;
+    // g_file_set_contents() writes a temp file and renames it, so a reader
+    // (or a crash mid-write) never sees a half-written cache
+    if (!g_file_set_contents(cache_path, contents, (gssize)length, &error)) {
+        g_warning("Failed to save forecast cache: %s", error ? error->message : "Unknown error");
+        g_clear_error(&error);
+    }
+    
+    g_free(cache_path);
+}
+
+// [Memory] compact, once per refresh: the response body, the decode and the
+// cache record are all freed by now, so give the free pages back to the system
+static void trim_heap(AppData *data) {
+#ifdef __GLIBC__
+    if (data->memory_compact) {
+        const gchar *previous_activity = watchdog_begin("heap trim");
+        malloc_trim(0);
+        watchdog_end(previous_activity);
+    }
+#else
+    (void)data;
+#endif
+}
+
+// A forecast was just downloaded or revalidated: persist it and hand it to
+// any shared-fetch subscribers
+static void forecast_refreshed(AppData *data) {
+    if (!data || !have_all_forecasts(data)) {
+        return;
+    }
+    
+    data->forecast_fetched_at = g_get_real_time() / G_USEC_PER_SEC;
+    update_age_badge(data);
+    GBytes *bytes = encode_current_forecasts(data);
+    save_forecast_cache(bytes);
+    forecast_broker_publish(data->broker, bytes);
+    g_bytes_unref(bytes);
+    trim_heap(data);
+}
+
+// TRUE if fetched_at falls in the current refresh window: nothing newer will be
+// fetched until the next scheduled refresh anyway
+static gboolean fetched_in_current_window(AppData *data, gint64 fetched_at) {
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    gint64 window_start = now + seconds_until_next_refresh(data) - data->refresh_interval;
+    return fetched_at >= window_start && fetched_at <= now;
+}
+
+// Render the last good forecast before the network is up.
+// Returns TRUE if the cached data was fetched during the current hourly update
+// window, in which case the launch fetch can be skipped.
+static gboolean load_forecast_cache(AppData *data) {
+    if (!data) {
+        return FALSE;
+    }
+    
+    gchar *cache_path = get_cache_file_path();
+    GError *error = NULL;
+    GMappedFile *mapped = g_mapped_file_new(cache_path, FALSE, &error);
+    if (!mapped) {
+        if (!g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+            g_warning("Failed to open forecast cache: %s", error ? error->message : "Unknown error");
+        }
+        g_clear_error(&error);
+        g_free(cache_path);
+        return FALSE;
+    }
+    
+    gint64 fetched_at = 0;
+    ForecastSnapshot *snapshot = decode_stored_forecasts(data, (const guint8 *)g_mapped_file_get_contents(mapped),
+                                                         g_mapped_file_get_length(mapped), "forecast cache",
+                                                         &fetched_at);
+    g_mapped_file_unref(mapped);
+    g_free(cache_path);
+    if (!snapshot) {
+        return FALSE;
+    }
+    
+    // Every strip needs something left to show, or the cache is just noise
+    gboolean expired = FALSE;
+    gint64 now_seconds = g_get_real_time() / G_USEC_PER_SEC;
+    for (guint i = 0; i < snapshot->n_forecasts; i++) {
+        const WeatherForecast *forecast = snapshot->forecasts[i];
+        if (forecast_find_hour(forecast, now_seconds) >= forecast->n_hours) {
+            expired = TRUE;
+        }
+    }
+    
+    gboolean fresh = FALSE;
+    if (expired) {
+        g_info("Cached forecast has no hours left to show");
+    } else if (commit_forecast_snapshot(data, snapshot)) {
+        data->forecast_fetched_at = fetched_at;
+        update_age_badge(data);
+        
+        gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+        fresh = fetched_in_current_window(data, fetched_at);
+        g_info("Showing cached forecast from %" G_GINT64_FORMAT " s ago%s", now - fetched_at,
+               fresh ? " (still current, skipping launch fetch)" : "");
+    }
+    
+    release_snapshot(data, snapshot);
+    return fresh;
+}
+
+// Shared-fetch subscriber: a snapshot published by the owning instance
+static void on_shared_snapshot(GBytes *bytes, gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    if (!data || !data->session) {
+        return;
+    }
+    
+    gsize length = 0;
+    const guint8 *contents = g_bytes_get_data(bytes, &length);
+    gint64 fetched_at = 0;
+    ForecastSnapshot *snapshot = decode_stored_forecasts(data, contents, length, "shared snapshot", &fetched_at);
+    if (snapshot && commit_forecast_snapshot(data, snapshot)) {
+        data->forecast_fetched_at = fetched_at;
+        update_age_badge(data);
+    }
+    release_snapshot(data, snapshot);
+}
+
+static void on_broker_role_changed(ForecastBrokerRole role, gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    if (!data || !data->session || role != FORECAST_BROKER_OWNER) {
+        return;
+    }
+    
+    // Promoted (at launch or because the previous owner exited): fetch unless what
+    // we already show is current, in which case just make it available to others
+    if (have_all_forecasts(data) && fetched_in_current_window(data, data->forecast_fetched_at)) {
+        GBytes *bytes = encode_current_forecasts(data);
+        forecast_broker_publish(data->broker, bytes);
+        g_bytes_unref(bytes);
+    } else {
+        fetch_weather(data);
+    }
+}
+
+// (Re)join the shared-fetch group for the current location
+static void start_forecast_broker(AppData *data) {
+    forecast_broker_free(data->broker);
+    gchar *location_key = get_batch_location_key(data);
+    data->broker = forecast_broker_new(location_key, on_broker_role_changed, on_shared_snapshot, data);
+    g_free(location_key);
+}
+
+// Pause everything that only exists to be looked at: clock ticks, the hourly
+// refresh and any pending retry. On resume the strips are re-rendered from the
+// forecast we hold (or the on-disk cache), and only refetched if it is stale.
+static void set_display_suspended(AppData *data, gboolean suspended) {
+    if (data->display_suspended == suspended) {
+        return;
+    }
+    data->display_suspended = suspended;
+    
+    if (suspended) {
+        g_info("Display not visible: pausing clock and weather refresh");
+        if (data->clock_timer_id != 0) {
+            g_source_remove(data->clock_timer_id);
+            data->clock_timer_id = 0;
+        }
+        if (data->weather_timer_id != 0) {
+            g_source_remove(data->weather_timer_id);
+            data->weather_timer_id = 0;
+        }
+        if (data->retry_timer_id != 0) {
+            g_source_remove(data->retry_timer_id);
+            data->retry_timer_id = 0;
+        }
+        if (data->window_timer_id != 0) {
+            g_source_remove(data->window_timer_id);
+            data->window_timer_id = 0;
+        }
+        return;
+    }
+    
+    g_info("Display visible again: resynchronizing");
+    update_clock(data);
+    data->clock_timer_id = g_timeout_add(clock_tick_delay_ms(data), update_clock_callback, data);
+    data->weather_timer_id = g_timeout_add_seconds(seconds_until_next_refresh(data), update_weather_callback, data);
+    
+    if (!have_all_forecasts(data)) {
+        load_forecast_cache(data);
+    }
+    render_all_locations(data);
+    if (!have_all_forecasts(data) || !fetched_in_current_window(data, data->forecast_fetched_at)) {
+        // Whatever retry sequence was running is moot; start a fresh one
+        retry_engine_reset(&data->retry);
+        fetch_weather(data);
+    }
 }
 
-// Retry callback for failed weather fetches
-static gboolean retry_fetch_weather(gpointer user_data) {
+static void append_counter(GString *out, const gchar *name, const gchar *help, guint64 value) {
+    metrics_append_header(out, name, "counter", help);
+    metrics_append_value(out, name, NULL, (gdouble)value);
+}
+
+static void append_gauge(GString *out, const gchar *name, const gchar *help, gdouble value) {
+    metrics_append_header(out, name, "gauge", help);
+    metrics_append_value(out, name, NULL, value);
+}
+
+// One scrape of the metrics endpoint. Everything is read from state the hot
+// paths keep anyway, so an unscraped endpoint costs nothing.
+static GString* collect_metrics(gpointer user_data) {
     AppData *data = (AppData *)user_data;
-    if (!data) {
-        return G_SOURCE_REMOVE;
+    const gchar *previous_activity = watchdog_begin("metrics scrape");
+    const FetchStats *stats = &data->fetch_stats;
+    const RetryEngine *retry = &data->retry;
+    const AppHistograms *histograms = &data->histograms;
+    GString *out = g_string_sized_new(8192);
+    gchar labels[64];
+    
+    append_counter(out, "weatherclock_fetch_responses_total", "Weather API responses received (any status)",
+                   stats->requests);
+    append_counter(out, "weatherclock_fetch_not_modified_total", "304 responses answered from the current forecast",
+                   stats->not_modified);
+    append_counter(out, "weatherclock_fetch_wire_bytes_total", "Response body bytes as received (compressed)",
+                   stats->wire_bytes);
+    append_counter(out, "weatherclock_fetch_decoded_bytes_total", "Response body bytes after content decoding",
+                   stats->decoded_bytes);
+    metrics_append_header(out, "weatherclock_fetch_connections_total", "counter",
+                          "Responses by whether they needed a new connection");
+    metrics_append_value(out, "weatherclock_fetch_connections_total", "kind=\"new\"", (gdouble)stats->new_connections);
+    metrics_append_value(out, "weatherclock_fetch_connections_total", "kind=\"reused\"",
+                         (gdouble)stats->reused_connections);
+    
+    metrics_append_header(out, "weatherclock_fetch_phase_seconds", "histogram",
+                          "Weather fetch time per phase: DNS, TCP connect, TLS, time to first byte, body, total");
+    for (guint i = 0; i < N_FETCH_PHASES; i++) {
+        g_snprintf(labels, sizeof(labels), "phase=\"%s\"", fetch_phase_names[i]);
+        metrics_append_histogram(out, "weatherclock_fetch_phase_seconds", labels, &histograms->fetch_phase[i]);
     }
-    
-    // Safety check: ensure session is still valid (indicates app is still running)
-    if (!data->session) {
-        return G_SOURCE_REMOVE;
+    metrics_append_header(out, "weatherclock_response_bytes", "histogram", "Wire size of full forecast responses");
+    metrics_append_histogram(out, "weatherclock_response_bytes", NULL, &histograms->response_bytes);
+    metrics_append_header(out, "weatherclock_parse_seconds", "histogram", "Forecast JSON decode time (worker thread)");
+    metrics_append_histogram(out, "weatherclock_parse_seconds", NULL, &histograms->parse);
+    metrics_append_header(out, "weatherclock_commit_seconds", "histogram",
+                          "Main-thread time to apply a decoded forecast to the widgets");
+    metrics_append_histogram(out, "weatherclock_commit_seconds", NULL, &histograms->commit);
+    metrics_append_header(out, "weatherclock_clock_tick_jitter_seconds", "histogram",
+                          "Distance of each clock tick from the boundary it was scheduled for");
+    metrics_append_histogram(out, "weatherclock_clock_tick_jitter_seconds", NULL, &histograms->clock_jitter);
+    metrics_append_header(out, "weatherclock_frame_seconds", "histogram",
+                          "GTK update, layout and paint time per frame");
+    metrics_append_histogram(out, "weatherclock_frame_seconds", NULL, &histograms->frame);
+    append_counter(out, "weatherclock_frames_over_budget_total", "Frames slower than [Display] frame_budget_ms",
+                   data->quality.frames_over_budget);
+    metrics_append_header(out, "weatherclock_render_quality_steps_total", "counter",
+                          "Render quality changes made for frame time, by direction");
+    metrics_append_value(out, "weatherclock_render_quality_steps_total", "direction=\"down\"",
+                         (gdouble)data->quality.steps_down);
+    metrics_append_value(out, "weatherclock_render_quality_steps_total", "direction=\"up\"",
+                         (gdouble)data->quality.steps_up);
+    metrics_append_header(out, "weatherclock_render_quality", "gauge", "1 for the render quality in use");
+    for (RenderQuality quality = RENDER_QUALITY_FULL; quality < RENDER_QUALITY_N_LEVELS; quality++) {
+        g_snprintf(labels, sizeof(labels), "quality=\"%s\"", render_quality_name(quality));
+        metrics_append_value(out, "weatherclock_render_quality", labels, data->quality.quality == quality ? 1 : 0);
     }
     
-    // Timer has fired, clear the ID before calling fetch
-    data->retry_timer_id = 0;
+    metrics_append_header(out, "weatherclock_fetch_failures_total", "counter", "Failed weather fetches by cause");
+    for (guint i = FETCH_ERROR_NONE + 1; i < FETCH_ERROR_N_CLASSES; i++) {
+        g_snprintf(labels, sizeof(labels), "class=\"%s\"", fetch_error_class_name((FetchErrorClass)i));
+        metrics_append_value(out, "weatherclock_fetch_failures_total", labels, (gdouble)retry->failures[i]);
+    }
+    append_counter(out, "weatherclock_retries_scheduled_total", "Retries scheduled after a failed fetch",
+                   retry->retries_scheduled);
+    append_counter(out, "weatherclock_circuit_trips_total", "Times the circuit breaker opened", retry->circuit_trips);
+    append_counter(out, "weatherclock_requests_suppressed_total", "Fetches skipped while the circuit was open",
+                   retry->requests_suppressed);
+    metrics_append_header(out, "weatherclock_circuit_state", "gauge", "1 for the circuit breaker's current state");
+    for (RetryCircuitState state = RETRY_CIRCUIT_CLOSED; state <= RETRY_CIRCUIT_HALF_OPEN; state++) {
+        g_snprintf(labels, sizeof(labels), "state=\"%s\"", retry_circuit_state_name(state));
+        metrics_append_value(out, "weatherclock_circuit_state", labels, retry->circuit == state ? 1 : 0);
+    }
     
-    g_info("Retrying weather fetch (attempt %d/%d)...", data->retry_count + 1, MAX_RETRY_ATTEMPTS);
-    fetch_weather(data);
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    append_gauge(out, "weatherclock_forecast_age_seconds", "Time since the shown forecast was downloaded",
+                 data->forecast_fetched_at > 0 ? (gdouble)(now - data->forecast_fetched_at) : -1);
+    append_gauge(out, "weatherclock_startup_first_frame_seconds", "Time from launch to the first painted frame",
+                 data->first_frame_us > 0 ? data->first_frame_us / (gdouble)G_USEC_PER_SEC : -1);
+    append_gauge(out, "weatherclock_display_suspended", "1 while nothing is visible and polling is paused",
+                 data->display_suspended ? 1 : 0);
+    guint64 resident = metrics_resident_bytes();
+    if (resident > 0) {
+        append_gauge(out, "process_resident_memory_bytes", "Resident memory size in bytes", (gdouble)resident);
+    }
     
-    return G_SOURCE_REMOVE;
+    if (data->watchdog) {
+        const WatchdogStats *watchdog = watchdog_get_stats(data->watchdog);
+        metrics_append_header(out, "weatherclock_main_loop_lag_seconds", "histogram",
+                              "Delay before the main loop dispatched a watchdog ping");
+        metrics_append_histogram(out, "weatherclock_main_loop_lag_seconds", NULL, &watchdog->lag);
+        metrics_append_header(out, "weatherclock_main_loop_stall_seconds", "histogram",
+                              "Main-loop stalls at or above the watchdog threshold");
+        metrics_append_histogram(out, "weatherclock_main_loop_stall_seconds", NULL, &watchdog->stalls);
+        metrics_append_header(out, "weatherclock_main_loop_stalls_total", "counter",
+                              "Main-loop stalls by the activity that was running");
+        for (guint i = 0; i < watchdog->n_activities; i++) {
+            g_snprintf(labels, sizeof(labels), "activity=\"%s\"", watchdog->activities[i]);
+            metrics_append_value(out, "weatherclock_main_loop_stalls_total", labels,
+                                 (gdouble)watchdog->activity_stalls[i]);
+        }
+    }
+    watchdog_end(previous_activity);
+    return out;
 }
 
-static void fetch_weather(AppData *data) {
-    if (!data || !data->session) {
+// (Re)open the endpoint on data->metrics_port, or close it for port 0
+static void start_metrics_server(AppData *data) {
+    g_clear_pointer(&data->metrics_server, metrics_server_free);
+    if (data->metrics_port == 0) {
         return;
     }
     
-    // Cancel any pending request before starting a new one
-    // In libsoup-3.0, unref'ing a message automatically cancels it
-    if (data->pending_message) {
-        g_object_unref(data->pending_message);
-        data->pending_message = NULL;
+    GError *error = NULL;
+    data->metrics_server = metrics_server_new((guint16)data->metrics_port, collect_metrics, data, &error);
+    if (data->metrics_server) {
+        g_info("Metrics on http://127.0.0.1:%u/metrics", data->metrics_port);
+    } else {
+        g_warning("Metrics endpoint not started: %s", error ? error->message : "Unknown error");
+        g_clear_error(&error);
+    }
+}
+
+// (Re)start the stall watchdog for data->stall_threshold_ms, or stop it for 0
+static void start_watchdog(AppData *data) {
+    g_clear_pointer(&data->watchdog, watchdog_free);
+    if (data->stall_threshold_ms == 0) {
+        return;
     }
     
-    // Only reset retry state if this is a FRESH fetch, not a retry
-    // The is_retrying flag is set by on_weather_response() when scheduling a retry
-    if (!data->is_retrying) {
-        // Cancel any pending retry timer to avoid duplicate fetches
-        if (data->retry_timer_id != 0) {
-            g_source_remove(data->retry_timer_id);
-            data->retry_timer_id = 0;
+    data->watchdog = watchdog_new(data->stall_threshold_ms);
+    g_info("Watchdog: logging main-loop stalls of %u ms or more", watchdog_get_threshold(data->watchdog));
+}
+
+// Replace the strip pool, e.g. for a new hours_to_show. Forecasts are kept.
+static void rebuild_location_strips(AppData *data) {
+    const gchar *previous_activity = watchdog_begin("strip rebuild");
+    for (guint i = 0; i < MAX_LOCATIONS; i++) {
+        LocationStrip *location = &data->locations[i];
+        if (location->strip) {
+            gtk_box_remove(GTK_BOX(data->weather_box), location->strip);
+            location->strip = NULL;
+            location->title_label = NULL;
+            location->hours_view = NULL;
         }
-        
-        // Reset retry state for fresh fetches
-        data->retry_count = 0;
-        data->retry_delay = 0;
+    }
+    create_location_strips(data);
+    sync_location_strips(data);
+    render_all_locations(data);
+    watchdog_end(previous_activity);
+}
+
+// The big clock: pre-rendered digits (ClockFace) or a plain GtkLabel
+static GtkWidget *create_clock_widget(AppData *data, gboolean glyph_cache) {
+    const gchar *initial_time = data->clock_text[0] ? data->clock_text
+                                : data->clock_low_power ? "00:00" : "00:00:00";
+    GtkWidget *clock_label;
+    if (glyph_cache) {
+        clock_label = clock_face_new(initial_time);
+        gtk_widget_set_halign(clock_label, GTK_ALIGN_CENTER);
+    } else {
+        clock_label = gtk_label_new(initial_time);
+        gtk_label_set_selectable(GTK_LABEL(clock_label), FALSE);
+    }
+    gtk_widget_add_css_class(clock_label, "clock-time");
+    return clock_label;
+}
+
+// Show data->quality.quality: CSS classes on the window for the panels, a
+// style per strip, and the glyph-cached clock at the lowest level
+static void apply_render_quality(AppData *data) {
+    if (!data->window) {
+        return;
+    }
+    RenderQuality quality = data->quality.quality;
+    if (quality >= RENDER_QUALITY_FLAT) {
+        gtk_widget_add_css_class(data->window, "render-flat");
+    } else {
+        gtk_widget_remove_css_class(data->window, "render-flat");
+    }
+    if (quality >= RENDER_QUALITY_MINIMAL) {
+        gtk_widget_add_css_class(data->window, "render-minimal");
+    } else {
+        gtk_widget_remove_css_class(data->window, "render-minimal");
     }
     
-    // Get location from entries if available, otherwise use stored values
-    const gchar *lat = data->location_lat ? data->location_lat : "52.52";
-    const gchar *lon = data->location_lon ? data->location_lon : "13.41";
+    WeatherStripStyle style = strip_style(data);
+    for (guint i = 0; i < MAX_LOCATIONS; i++) {
+        if (data->locations[i].hours_view) {
+            weather_strip_set_style(WEATHER_STRIP(data->locations[i].hours_view), style);
+        }
+    }
     
+    gboolean glyph_cache = data->clock_glyph_cache || quality >= RENDER_QUALITY_MINIMAL;
+    GtkWidget *clock_box = data->clock_label ? gtk_widget_get_parent(data->clock_label) : NULL;
+    if (clock_box && CLOCK_IS_FACE(data->clock_label) != glyph_cache) {
+        gtk_box_remove(GTK_BOX(clock_box), data->clock_label);
+        data->clock_label = create_clock_widget(data, glyph_cache);
+        gtk_box_prepend(GTK_BOX(clock_box), data->clock_label);
+    }
+}
+
+// Restart frame-time adaptation for the configured quality and budget
+static void reset_render_quality(AppData *data) {
+    RenderQuality floor = RENDER_QUALITY_MINIMAL;
+    RenderQuality ceiling = RENDER_QUALITY_FULL;
+    if (data->render_quality != RENDER_QUALITY_AUTO) {
+        floor = ceiling = (RenderQuality)data->render_quality;
+    }
+    quality_governor_init(&data->quality, floor, ceiling, (gint64)data->frame_budget_ms * 1000,
+                          g_get_monotonic_time());
+}
+
+// Show the reloaded locations in the settings window
+static void update_location_entries(AppData *data) {
     if (data->lat_entry && GTK_IS_EDITABLE(data->lat_entry)) {
-        const gchar *lat_text = gtk_editable_get_text(GTK_EDITABLE(data->lat_entry));
-        if (lat_text && strlen(lat_text) > 0) {
-            lat = lat_text;
-        }
+        gtk_editable_set_text(GTK_EDITABLE(data->lat_entry), data->locations[0].lat ? data->locations[0].lat : "");
     }
     if (data->lon_entry && GTK_IS_EDITABLE(data->lon_entry)) {
-        const gchar *lon_text = gtk_editable_get_text(GTK_EDITABLE(data->lon_entry));
-        if (lon_text && strlen(lon_text) > 0) {
-            lon = lon_text;
+        gtk_editable_set_text(GTK_EDITABLE(data->lon_entry), data->locations[0].lon ? data->locations[0].lon : "");
+    }
+    if (data->extra_locations_entry && GTK_IS_EDITABLE(data->extra_locations_entry)) {
+        gchar *extra_text = format_additional_locations(data);
+        gtk_editable_set_text(GTK_EDITABLE(data->extra_locations_entry), extra_text);
+        g_free(extra_text);
+    }
+}
+
+// A config written by something else (e.g. fleet provisioning) replaces the
+// running settings. Only what changed is redone, and the forecast is only
+// refetched for new coordinates or a longer strip.
+static void apply_reloaded_config(AppData *data, GKeyFile *key_file) {
+    gchar *old_locations = get_batch_location_key(data);
+    gchar *old_timezone = g_strdup(data->timezone);
+    gint old_utc_offset = data->utc_offset_seconds;
+    gboolean old_shared_fetch = data->shared_fetch;
+    gboolean old_low_power = data->clock_low_power;
+    gboolean old_glyph_cache = data->clock_glyph_cache;
+    guint old_hours_to_show = data->hours_to_show;
+    guint old_forecast_days = data->forecast_days;
+    gint old_render_quality = data->render_quality;
+    guint old_frame_budget_ms = data->frame_budget_ms;
+    guint old_refresh_interval = data->refresh_interval;
+    guint old_refresh_jitter_max = data->refresh_jitter_max;
+    guint old_http_timeout = data->http_timeout;
+    guint old_http_idle_timeout = data->http_idle_timeout;
+    guint old_dns_cache_seconds = data->dns_cache_seconds;
+    guint old_metrics_port = data->metrics_port;
+    guint old_stall_threshold_ms = data->stall_threshold_ms;
+    gboolean old_memory_compact = data->memory_compact;
+    
+    set_default_settings(data);
+    apply_config(data, key_file);
+    data->refresh_jitter_max = MIN(data->refresh_jitter_max, data->refresh_interval / 2);
+    
+    gchar *new_locations = get_batch_location_key(data);
+    gboolean locations_changed = strcmp(old_locations, new_locations) != 0;
+    g_free(old_locations);
+    g_free(new_locations);
+    
+    if (g_strcmp0(old_timezone, data->timezone) != 0 || old_utc_offset != data->utc_offset_seconds ||
+        old_low_power != data->clock_low_power) {
+        data->clock_day = G_MININT64;  // The date may differ in the new zone
+        update_clock(data);
+        if (data->clock_timer_id != 0) {
+            g_source_remove(data->clock_timer_id);
+            data->clock_timer_id = g_timeout_add(clock_tick_delay_ms(data), update_clock_callback, data);
         }
     }
+    g_free(old_timezone);
     
-    // Validate lat/lon are reasonable (prevent buffer overflow in URL)
-    if (strlen(lat) > 20 || strlen(lon) > 20) {
-        g_warning("Latitude or longitude too long, using defaults");
-        lat = "52.52";
-        lon = "13.41";
+    if (old_http_timeout != data->http_timeout || old_http_idle_timeout != data->http_idle_timeout ||
+        old_dns_cache_seconds != data->dns_cache_seconds) {
+        data->session_outdated = TRUE;
+        g_clear_object(&data->geocode_session);  // The next search builds one with the new timeouts
     }
     
-    char url[512];
-    // Request 2 days to ensure we always have enough data for 6 hours
-    // This is especially important when it's late in the day (e.g., 19:00-23:00 + next day 00:00)
-    int url_len = snprintf(url, sizeof(url), 
-             "https://api.open-meteo.com/v1/forecast?latitude=%s&longitude=%s&hourly=temperature_2m,weathercode&forecast_days=2&timezone=auto",
-             lat, lon);
+    if (old_refresh_interval != data->refresh_interval || old_refresh_jitter_max != data->refresh_jitter_max) {
+        data->refresh_offset = compute_refresh_offset(data);
+        if (data->weather_timer_id != 0) {
+            g_source_remove(data->weather_timer_id);
+            data->weather_timer_id = g_timeout_add_seconds(seconds_until_next_refresh(data),
+                                                           update_weather_callback, data);
+        }
+    }
     
-    if (url_len < 0 || url_len >= (int)sizeof(url)) {
-        g_warning("URL construction failed or truncated");
-        return;
+    if (old_metrics_port != data->metrics_port) {
+        start_metrics_server(data);
+    }
+    if (old_stall_threshold_ms != data->stall_threshold_ms && data->services_started) {
+        start_watchdog(data);
     }
     
-    g_debug("Fetching weather from: %s", url);
+    if (old_memory_compact != data->memory_compact) {
+        g_info("Config reload: [Memory] compact limits malloc arenas only after a restart");
+    }
     
-    SoupMessage *msg = soup_message_new("GET", url);
-    if (!msg) {
-        g_warning("Failed to create SoupMessage");
-        return;
+    if ((old_hours_to_show != data->hours_to_show || old_forecast_days != data->forecast_days) &&
+        data->weather_box) {
+        for (guint i = 0; i < data->n_locations; i++) {
+            update_daily_aggregates(data, &data->locations[i]);
+        }
+        rebuild_location_strips(data);
+    }
+    if (old_render_quality != data->render_quality || old_frame_budget_ms != data->frame_budget_ms) {
+        reset_render_quality(data);
+        apply_render_quality(data);
+    } else if (old_glyph_cache != data->clock_glyph_cache) {
+        apply_render_quality(data);
     }
     
-    // Store data pointer in message user_data for callback
-    g_object_set_data(G_OBJECT(msg), "app-data", data);
-    data->pending_message = msg;  // Track pending message
-    g_object_ref(msg);  // Keep a reference until callback completes
-    soup_session_send_and_read_async(data->session, msg, G_PRIORITY_DEFAULT, NULL, on_weather_response, msg);
+    if (locations_changed) {
+        g_info("Config reload: locations changed");
+        sync_location_strips(data);
+        update_location_entries(data);
+        retry_engine_reset(&data->retry);
+        if (data->retry_timer_id != 0) {
+            g_source_remove(data->retry_timer_id);
+            data->retry_timer_id = 0;
+        }
+    }
+    
+    if (old_shared_fetch && !data->shared_fetch) {
+        forecast_broker_free(data->broker);
+        data->broker = NULL;
+    }
+    if (data->shared_fetch && (!old_shared_fetch || locations_changed)) {
+        // New sharing group; the role callback fetches if we own it
+        start_forecast_broker(data);
+    } else if (locations_changed || data->hours_to_show > old_hours_to_show ||
+               data->forecast_days > old_forecast_days) {
+        fetch_weather(data);
+    }
 }
 
-static gboolean update_clock_callback(gpointer user_data) {
+static void on_config_read(GObject *source, GAsyncResult *result, gpointer user_data) {
+    gchar *contents = NULL;
+    gsize length = 0;
+    GError *error = NULL;
+    gboolean ok = g_file_load_contents_finish(G_FILE(source), result, &contents, &length, NULL, &error);
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_error_free(error);
+        return; // Superseded by a newer read, or shutting down
+    }
+    
     AppData *data = (AppData *)user_data;
-    if (!data) {
-        return G_SOURCE_REMOVE;
+    g_clear_object(&data->config_read_cancellable);
+    if (!ok) {
+        // Removed or replaced again meanwhile; a later event reads it then
+        g_debug("Config reload: %s", error ? error->message : "Unknown error");
+        g_clear_error(&error);
+        return;
     }
     
-    // Safety check: ensure session is still valid (indicates app is still running)
-    if (!data->session) {
-        return G_SOURCE_REMOVE;
+    // Our own write coming back, or a rewrite with the same contents
+    gsize writing_length = 0;
+    const gchar *writing = data->config_writing ? g_bytes_get_data(data->config_writing, &writing_length) : NULL;
+    if (g_strcmp0(contents, data->config_written) == 0 ||
+        (writing && writing_length == length && memcmp(writing, contents, length) == 0)) {
+        g_free(contents);
+        return;
     }
     
-    // Only update if widgets are valid and part of widget tree
-    if (data->clock_label && data->date_label && 
-        GTK_IS_WIDGET(data->clock_label) && GTK_IS_WIDGET(data->date_label) &&
-        gtk_widget_get_parent(data->clock_label) && gtk_widget_get_parent(data->date_label)) {
-        update_clock(data);
-        // Force widgets to be visible and queue a redraw to ensure rendering
-        gtk_widget_set_visible(data->clock_label, TRUE);
-        gtk_widget_set_visible(data->date_label, TRUE);
-        gtk_widget_queue_draw(data->clock_label);
-        gtk_widget_queue_draw(data->date_label);
+    GKeyFile *key_file = g_key_file_new();
+    if (!g_key_file_load_from_data(key_file, contents, length, G_KEY_FILE_NONE, &error)) {
+        // Most likely caught mid-write by a tool that doesn't rename into place
+        g_warning("Ignoring changed config: %s", error ? error->message : "Unknown error");
+        g_clear_error(&error);
+    } else {
+        g_info("Config file changed, reloading");
+        const gchar *previous_activity = watchdog_begin("config reload");
+        apply_reloaded_config(data, key_file);
+        g_free(data->config_written);
+        data->config_written = build_config_data(data);
+        watchdog_end(previous_activity);
     }
-    return G_SOURCE_CONTINUE;
+    g_key_file_unref(key_file);
+    g_free(contents);
 }
 
-static gboolean update_weather_callback(gpointer user_data) {
+static gboolean config_reload_callback(gpointer user_data) {
     AppData *data = (AppData *)user_data;
-    if (!data) {
+    data->config_reload_timer_id = 0;
+    
+    gchar *config_path = get_config_file_path();
+    if (!config_path) {
         return G_SOURCE_REMOVE;
     }
     
-    // Safety check: ensure session is still valid (indicates app is still running)
-    if (!data->session) {
-        return G_SOURCE_REMOVE;
+    if (data->config_read_cancellable) {
+        g_cancellable_cancel(data->config_read_cancellable);
+        g_object_unref(data->config_read_cancellable);
+    }
+    data->config_read_cancellable = g_cancellable_new();
+    GFile *file = g_file_new_for_path(config_path);
+    g_file_load_contents_async(file, data->config_read_cancellable, on_config_read, data);
+    g_object_unref(file);
+    g_free(config_path);
+    return G_SOURCE_REMOVE;
+}
+
+static void on_config_file_changed(GFileMonitor *monitor, GFile *file, GFile *other_file,
+                                   GFileMonitorEvent event_type, gpointer user_data) {
+    (void)monitor;
+    (void)file;
+    (void)other_file;
+    AppData *data = (AppData *)user_data;
+    
+    // Written in place (CHANGES_DONE_HINT) or renamed over the old file
+    // (CREATED / MOVED_IN / RENAMED); the rest is noise
+    if (event_type != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT && event_type != G_FILE_MONITOR_EVENT_CREATED &&
+        event_type != G_FILE_MONITOR_EVENT_MOVED_IN && event_type != G_FILE_MONITOR_EVENT_RENAMED) {
+        return;
     }
     
-    fetch_weather(data);
+    if (data->config_reload_timer_id != 0) {
+        g_source_remove(data->config_reload_timer_id);
+    }
+    data->config_reload_timer_id = g_timeout_add(CONFIG_RELOAD_DELAY_MS, config_reload_callback, data);
+}
+
+// Follow weatherclock.conf so provisioning changes apply without a restart
+static void start_config_monitor(AppData *data) {
+    gchar *config_path = get_config_file_path();
+    if (!config_path) {
+        return;
+    }
     
-    // After first refresh, reschedule for every hour
-    // Remove the old timer and create a new one that runs every hour
-    if (data->weather_timer_id != 0) {
-        g_source_remove(data->weather_timer_id);
-        data->weather_timer_id = 0;
+    GFile *file = g_file_new_for_path(config_path);
+    GError *error = NULL;
+    data->config_monitor = g_file_monitor_file(file, G_FILE_MONITOR_WATCH_MOVES, NULL, &error);
+    if (data->config_monitor) {
+        g_signal_connect(data->config_monitor, "changed", G_CALLBACK(on_config_file_changed), data);
+    } else {
+        g_warning("Not watching config for changes: %s", error ? error->message : "Unknown error");
+        g_clear_error(&error);
+    }
+    g_object_unref(file);
+    g_free(config_path);
+}
+
+// Visible means mapped, not minimized, not suspended by the compositor (GTK 4.12+)
+// and not behind a blanked screen
+static void update_display_suspended(AppData *data) {
+    if (!data || !data->session) {
+        return;
     }
     
-    // Schedule next refresh for exactly 1 hour from now
-    data->weather_timer_id = g_timeout_add_seconds(UPDATE_INTERVAL_SECONDS, update_weather_callback, data);
+    gboolean visible = data->window && gtk_widget_get_mapped(data->window) && !data->screen_blanked;
+    if (visible && data->watched_surface) {
+        GdkToplevelState state = gdk_toplevel_get_state(GDK_TOPLEVEL(data->watched_surface));
+        if (state & GDK_TOPLEVEL_STATE_MINIMIZED) {
+            visible = FALSE;
+        }
+#if GTK_CHECK_VERSION(4, 12, 0)
+        if (state & GDK_TOPLEVEL_STATE_SUSPENDED) {
+            visible = FALSE;
+        }
+#endif
+    }
+    set_display_suspended(data, !visible);
+}
+
+static void on_window_map_changed(GtkWidget *widget, gpointer user_data) {
+    (void)widget;
+    update_display_suspended((AppData *)user_data);
+}
+
+static void on_toplevel_state_changed(GObject *object, GParamSpec *pspec, gpointer user_data) {
+    (void)object;
+    (void)pspec;
+    update_display_suspended((AppData *)user_data);
+}
+
+static void on_screensaver_active_changed(GDBusConnection *connection, const gchar *sender_name,
+                                          const gchar *object_path, const gchar *interface_name,
+                                          const gchar *signal_name, GVariant *parameters, gpointer user_data) {
+    (void)connection;
+    (void)sender_name;
+    (void)object_path;
+    (void)interface_name;
+    (void)signal_name;
+    AppData *data = (AppData *)user_data;
+    if (!data || !data->session || !g_variant_is_of_type(parameters, G_VARIANT_TYPE("(b)"))) {
+        return;
+    }
     
-    return G_SOURCE_REMOVE; // Remove the one-time timer
+    gboolean active = FALSE;
+    g_variant_get(parameters, "(b)", &active);
+    data->screen_blanked = active;
+    update_display_suspended(data);
 }
 
-// Calculate seconds until the next top of the hour
-static guint seconds_until_next_hour(void) {
-    time_t now = time(NULL);
-    if (now == (time_t)-1) {
-        return UPDATE_INTERVAL_SECONDS; // Fallback to 1 hour
+// DPMS itself isn't exposed to clients; the session screensaver's ActiveChanged
+// signal (blank/lock) is the portable stand-in. Optional: no bus, no watching.
+static void on_screensaver_bus_ready(GObject *source_object, GAsyncResult *res, gpointer user_data) {
+    (void)source_object;
+    GError *error = NULL;
+    GDBusConnection *connection = g_bus_get_finish(res, &error);
+    if (!connection) {
+        g_debug("Screen blanking not watched: %s", error ? error->message : "Unknown error");
+        g_clear_error(&error);
+        return;
     }
     
-    struct tm *tm_info = localtime(&now);
-    if (!tm_info) {
-        return UPDATE_INTERVAL_SECONDS; // Fallback to 1 hour
+    AppData *data = (AppData *)user_data;
+    if (!data || !data->session) {
+        g_object_unref(connection);
+        return;
     }
     
-    // Calculate seconds until next hour
-    int current_minute = tm_info->tm_min;
-    int current_second = tm_info->tm_sec;
-    int seconds_remaining_in_hour = (60 - current_minute) * 60 - current_second;
+    static const gchar *interfaces[] = { "org.freedesktop.ScreenSaver", "org.gnome.ScreenSaver" };
+    data->screensaver_bus = connection;
+    for (guint i = 0; i < G_N_ELEMENTS(interfaces); i++) {
+        data->screensaver_subscriptions[i] = g_dbus_connection_signal_subscribe(
+            connection, NULL, interfaces[i], "ActiveChanged", NULL, NULL, G_DBUS_SIGNAL_FLAGS_NONE,
+            on_screensaver_active_changed, data, NULL);
+    }
+}
+
+// Startup phase timings for the info log; a phase ends where this is called
+static void log_startup_phase(AppData *data, const gchar *phase) {
+    gint64 now = g_get_monotonic_time();
+    g_info("Startup: %s took %.1f ms (%.1f ms since launch)", phase,
+           (now - data->startup_phase_at) / 1000.0, (now - data->startup_started_at) / 1000.0);
+    data->startup_phase_at = now;
+}
+
+static void on_first_frame_painted(GdkFrameClock *frame_clock, gpointer user_data);
+
+// Everything that waits on the network or the session bus. None of it is
+// needed for the first frame, and on a cold boot DNS and D-Bus can be slow to
+// answer, so it starts once the clock and the cached forecast are on screen.
+static gboolean start_deferred_services(gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    data->services_source_id = 0;
+    if (data->first_frame_clock) {
+        // Nothing painted in time (e.g. started minimized); don't wait any longer
+        g_signal_handlers_disconnect_by_func(data->first_frame_clock, on_first_frame_painted, data);
+        g_clear_object(&data->first_frame_clock);
+    }
+    if (data->services_started || !data->session) {
+        return G_SOURCE_REMOVE;
+    }
+    data->services_started = TRUE;
+    
+    // Only hit the network if the cached forecast is stale. In shared-fetch
+    // mode the broker's role decides who fetches.
+    if (data->shared_fetch) {
+        start_forecast_broker(data);
+    } else if (!have_all_forecasts(data) || !fetched_in_current_window(data, data->forecast_fetched_at)) {
+        fetch_weather(data);
+    }
+    g_bus_get(G_BUS_TYPE_SESSION, NULL, on_screensaver_bus_ready, data);
+    start_config_monitor(data);
+    start_metrics_server(data);
+    // After startup, whose slow phases the startup log already times
+    start_watchdog(data);
+    log_startup_phase(data, "services");
+    return G_SOURCE_REMOVE;
+}
+
+static void on_first_frame_painted(GdkFrameClock *frame_clock, gpointer user_data) {
+    AppData *data = (AppData *)user_data;
+    g_signal_handlers_disconnect_by_func(frame_clock, on_first_frame_painted, data);
+    g_clear_object(&data->first_frame_clock);
+    data->first_frame_us = g_get_monotonic_time() - data->startup_started_at;
+    log_startup_phase(data, "first frame");
+    
+    // From an idle rather than here, so the frame isn't held up on its way out
+    if (data->services_source_id != 0) {
+        g_source_remove(data->services_source_id);
+    }
+    data->services_source_id = g_idle_add(start_deferred_services, data);
+}
+
+// GTK's update, layout and paint phases run between these two; a watchdog
+// stall in between is GTK laying out or drawing our widgets, and the time in
+// between is what the render quality governor budgets
+static void on_frame_begin(GdkFrameClock *frame_clock, gpointer user_data) {
+    (void)frame_clock;
+    AppData *data = (AppData *)user_data;
+    watchdog_begin("GTK frame");
+    data->frame_started_at = g_get_monotonic_time();
+}
+
+static void on_frame_end(GdkFrameClock *frame_clock, gpointer user_data) {
+    (void)frame_clock;
+    AppData *data = (AppData *)user_data;
+    watchdog_end(NULL);
+    if (data->frame_started_at == 0 || !data->session) {
+        return;
+    }
     
-    return (guint)seconds_remaining_in_hour;
+    gint64 now = g_get_monotonic_time();
+    gint64 frame_us = now - data->frame_started_at;
+    data->frame_started_at = 0;
+    metrics_histogram_observe(&data->histograms.frame, (gdouble)frame_us / G_USEC_PER_SEC);
+    switch (quality_governor_observe(&data->quality, frame_us, now)) {
+    case QUALITY_CHANGED:
+        apply_render_quality(data);
+        break;
+    case QUALITY_SETTLED:
+        g_info("Render quality: settled on %s (%" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT " frames over %u ms)",
+               render_quality_name(data->quality.quality), data->quality.frames_over_budget,
+               data->quality.frames, data->frame_budget_ms);
+        break;
+    default:
+        break;
+    }
 }
 
 // Callback when window is realized - go fullscreen once
@@ -1309,6 +3666,31 @@ static void on_window_realize_fullscreen(GtkWidget *widget, gpointer user_data)
     AppData *data = (AppData *)user_data;
     if (data && data->window && gtk_widget_get_realized(data->window)) {
         gtk_window_fullscreen(GTK_WINDOW(data->window));
+        
+        // Follow minimize/compositor-suspend state of the new toplevel surface
+        GdkSurface *surface = gtk_native_get_surface(GTK_NATIVE(data->window));
+        if (surface && surface != data->watched_surface) {
+            data->watched_surface = surface;
+            g_signal_connect(surface, "notify::state", G_CALLBACK(on_toplevel_state_changed), data);
+            
+            // Label and time frames for the watchdog and the render quality
+            // governor; the clock goes away with the surface
+            GdkFrameClock *frame_clock = gdk_surface_get_frame_clock(surface);
+            if (frame_clock) {
+                g_signal_connect(frame_clock, "before-paint", G_CALLBACK(on_frame_begin), data);
+                g_signal_connect(frame_clock, "after-paint", G_CALLBACK(on_frame_end), data);
+            }
+        }
+        
+        // Network services wait until the clock is on screen
+        if (!data->services_started && !data->first_frame_clock) {
+            GdkFrameClock *frame_clock = gtk_widget_get_frame_clock(data->window);
+            if (frame_clock) {
+                data->first_frame_clock = g_object_ref(frame_clock);
+                g_signal_connect(frame_clock, "after-paint", G_CALLBACK(on_first_frame_painted), data);
+            }
+        }
+        
         // Force an immediate update of the clock to ensure it's rendered
         update_clock(data);
         // Queue a draw to ensure everything is properly rendered
@@ -1318,6 +3700,7 @@ static void on_window_realize_fullscreen(GtkWidget *widget, gpointer user_data)
 
 static void activate(GtkApplication *app, gpointer user_data) {
     AppData *data = (AppData *)user_data;
+    log_startup_phase(data, "GTK init");
     
     // Create main window
     data->window = gtk_application_window_new(app);
@@ -1360,18 +3743,15 @@ static void activate(GtkApplication *app, gpointer user_data) {
     
     gtk_box_append(GTK_BOX(main_box), button_box);
     
-    // Create settings window
-    create_settings_window(data);
-    
     // Clock section - reduced spacing for compact layout
     GtkWidget *clock_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
     gtk_widget_set_halign(clock_box, GTK_ALIGN_CENTER);
     gtk_widget_set_valign(clock_box, GTK_ALIGN_CENTER);
     gtk_widget_set_vexpand(clock_box, TRUE);
     
-    data->clock_label = gtk_label_new("00:00:00");
-    gtk_widget_add_css_class(data->clock_label, "clock-time");
-    gtk_label_set_selectable(GTK_LABEL(data->clock_label), FALSE);
+    // Pre-rendered digits by default: a tick composites textures instead of
+    // re-shaping and re-rasterizing a 240px string
+    data->clock_label = create_clock_widget(data, data->clock_glyph_cache);
     gtk_box_append(GTK_BOX(clock_box), data->clock_label);
     
     data->date_label = gtk_label_new("Monday, January 1, 2024");
@@ -1384,154 +3764,89 @@ static void activate(GtkApplication *app, gpointer user_data) {
     GtkWidget *weather_section = gtk_box_new(GTK_ORIENTATION_VERTICAL, 6);
     gtk_widget_add_css_class(weather_section, "weather-section");
     
+    // Title centred, data-age badge at the end of the same row
+    GtkWidget *weather_header = gtk_center_box_new();
     GtkWidget *weather_title = gtk_label_new("Hourly Weather Forecast");
     gtk_widget_add_css_class(weather_title, "weather-title");
-    gtk_box_append(GTK_BOX(weather_section), weather_title);
+    gtk_center_box_set_center_widget(GTK_CENTER_BOX(weather_header), weather_title);
+    data->age_label = gtk_label_new("");
+    gtk_widget_add_css_class(data->age_label, "weather-age");
+    gtk_widget_set_valign(data->age_label, GTK_ALIGN_CENTER);
+    gtk_widget_set_visible(data->age_label, FALSE);
+    gtk_center_box_set_end_widget(GTK_CENTER_BOX(weather_header), data->age_label);
+    gtk_box_append(GTK_BOX(weather_section), weather_header);
     
     // Scrollable weather container
     GtkWidget *scrolled = gtk_scrolled_window_new();
     gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled), 
-                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_NEVER);
+                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
     
-    data->weather_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
-    gtk_widget_add_css_class(data->weather_box, "weather-container");
-
+    // One strip per location, stacked vertically
+    data->weather_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
     gtk_widget_set_halign(data->weather_box, GTK_ALIGN_CENTER);
-    gtk_box_set_homogeneous(GTK_BOX(data->weather_box), TRUE);
     
     gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled), data->weather_box);
-
     
-    
-    gtk_box_append(GTK_BOX(weather_section), scrolled);
+    // Fixed pool of strips and hour cards, reused by every refresh
+    create_location_strips(data);
+    sync_location_strips(data);
+    
+    // Error messages float over the cards instead of replacing them
+    GtkWidget *weather_overlay = gtk_overlay_new();
+    gtk_overlay_set_child(GTK_OVERLAY(weather_overlay), scrolled);
+    
+    data->weather_error_label = gtk_label_new("");
+    gtk_widget_add_css_class(data->weather_error_label, "error-text");
+    gtk_widget_add_css_class(data->weather_error_label, "weather-overlay");
+    gtk_widget_set_halign(data->weather_error_label, GTK_ALIGN_CENTER);
+    gtk_widget_set_valign(data->weather_error_label, GTK_ALIGN_CENTER);
+    gtk_widget_set_visible(data->weather_error_label, FALSE);
+    gtk_overlay_add_overlay(GTK_OVERLAY(weather_overlay), data->weather_error_label);
+    // Let the message size the section while no cards are visible yet
+    gtk_overlay_set_measure_overlay(GTK_OVERLAY(weather_overlay), data->weather_error_label, TRUE);
+    
+    gtk_box_append(GTK_BOX(weather_section), weather_overlay);
     gtk_box_append(GTK_BOX(main_box), weather_section);
     
+    // A pinned [Display] render_quality applies from the first frame
+    apply_render_quality(data);
+    
+    log_startup_phase(data, "widgets");
     
-    // CSS styling - sizes optimized for 1080p baseline, scales reasonably to 720p-4K
+    // Stylesheet compiled into the binary (resources/weatherclock.css)
     data->css_provider = gtk_css_provider_new();
-    const char *css = 
-        "#main-window {"
-        "  background-color: #000000;"
-        "}"
-        "window {"
-        "  background-color: #000000;"
-        "}"
-        /* Clock: 140px works on 720p (~19% height), looks good up to 4K */
-        ".clock-time {"
-        "  font-size: 240px;"
-        "  font-weight: bold;"
-        "  color: #ffffff;"
-        "  letter-spacing: -4px;"  /* Tighter spacing for compactness */
-        "}"
-        ".clock-date {"
-        "  font-size: 48px;"
-        "  color: #cccccc;"
-        "  margin-top: 0px;"
-        "}"
-        /* Weather section - compact design */
-        ".weather-section {"
-        "  background-color: rgba(20, 20, 20, 0.85);"
-        "  border-radius: 12px;"
-        "  padding: 8px 12px;"
-        "}"
-        ".weather-title {"
-        "  font-size: 20px;"
-        "  font-weight: bold;"
-        "  color: #ffffff;"
-        "  margin-bottom: 6px;"
-        "}"
-        ".weather-container {"
-        "  padding: 4px;"
-        "}"
-        ".weather-hour {"
-        "  background-color: rgba(50, 50, 50, 0.8);"
-        "  border-radius: 8px;"
-        "  padding: 8px 12px;"
-        "  margin: 3px;"
-        "  min-width: 80px;"
-        "}"
-        ".weather-time {"
-        "  font-size: 22px;"
-        "  font-weight: bold;"
-        "  color: #ffffff;"
-        "}"
-        ".weather-icon {"
-        "  font-size: 32px;"
-        "  margin: 4px 0;"
-        "}"
-        ".weather-temp {"
-        "  font-size: 42px;"
-        "  font-weight: bold;"
-        "  color: #ffffff;"
-        "}"
-        ".weather-desc {"
-        "  font-size: 15px;"
-        "  color: #aaaaaa;"
-        "}"
-        ".error-text {"
-        "  color: #ff6b6b;"
-        "  font-size: 14px;"
-        "  padding: 10px;"
-        "}"
-        /* Settings dialog */
-        ".location-box {"
-        "  padding: 8px;"
-        "  margin-bottom: 8px;"
-        "}"
-        ".location-box label {"
-        "  margin: 0 4px;"
-        "  color: #ffffff;"
-        "  font-size: 14px;"
-        "}"
-        ".location-box entry {"
-        "  min-width: 90px;"
-        "  margin: 0 8px;"
-        "  padding: 4px 8px;"
-        "  background-color: #1a1a1a;"
-        "  color: #ffffff;"
-        "}"
-        ".exit-button {"
-        "  padding: 6px 14px;"
-        "  font-size: 13px;"
-        "  background-color: #bf616a;"
-        "  color: #000000;"
-        "  border-radius: 4px;"
-        "}"
-        ".exit-button:hover {"
-        "  background-color: #a04850;"
-        "}"
-        ".settings-title {"
-        "  font-size: 20px;"
-        "  font-weight: bold;"
-        "  color: #ffffff;"
-        "  margin-bottom: 12px;"
-        "}";
-    
-    gtk_css_provider_load_from_string(data->css_provider, css);
+    gtk_css_provider_load_from_resource(data->css_provider, CSS_RESOURCE_PATH);
     gtk_style_context_add_provider_for_display(gdk_display_get_default(),
                                                GTK_STYLE_PROVIDER(data->css_provider),
                                                GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    log_startup_phase(data, "stylesheet");
     
     // Initialize clock
     update_clock(data);
     
-    // Set up timers and track their IDs
-    data->clock_timer_id = g_timeout_add_seconds(1, update_clock_callback, data);
+    // Set up timers and track their IDs. The clock re-arms itself for each
+    // second (or minute) boundary instead of using a coalesced 1 s interval.
+    data->clock_timer_id = g_timeout_add(clock_tick_delay_ms(data), update_clock_callback, data);
     
-    // Calculate seconds until next top of the hour for weather refresh
-    guint seconds_until_hour = seconds_until_next_hour();
+    // First scheduled refresh at this device's point in the next slot; each
+    // refresh then schedules the following one
+    data->weather_timer_id = g_timeout_add_seconds(seconds_until_next_refresh(data), update_weather_callback, data);
     
-    // Set up initial weather timer to trigger at the next top of the hour
-    // After that, it will refresh every hour automatically
-    data->weather_timer_id = g_timeout_add_seconds(seconds_until_hour, update_weather_callback, data);
-    
-    // Fetch initial weather
-    fetch_weather(data);
+    // Show the cached forecast in the first frame; the network comes after it
+    load_forecast_cache(data);
+    log_startup_phase(data, "cached forecast");
     
     // Connect realize signal to go fullscreen after window is properly created
     // This ensures GTK4 properly calculates the window size with scaling
     g_signal_connect(data->window, "realize", G_CALLBACK(on_window_realize_fullscreen), data);
     
+    // Pause the clock and polling while the window can't be seen
+    g_signal_connect(data->window, "map", G_CALLBACK(on_window_map_changed), data);
+    g_signal_connect(data->window, "unmap", G_CALLBACK(on_window_map_changed), data);
+    
+    // Normally started right after the first frame (see on_first_frame_painted)
+    data->services_source_id = g_timeout_add(SERVICES_MAX_DELAY_MS, start_deferred_services, data);
+    
     // Show window - this will trigger the realize signal
     gtk_widget_set_visible(data->window, TRUE);
 }
@@ -1542,58 +3857,113 @@ int main(int argc, char *argv[]) {
         g_error("Failed to allocate AppData");
         return 1;
     }
+    data->startup_started_at = g_get_monotonic_time();
+    data->startup_phase_at = data->startup_started_at;
     
     // Initialize location (default: Toronto)
     // Can be overridden with command line arguments or config file
-    data->location_lat = g_strdup("43.640");
-    data->location_lon = g_strdup("-79.565");
+    data->locations[0].lat = g_strdup("43.640");
+    data->locations[0].lon = g_strdup("-79.565");
+    data->n_locations = 1;
+    data->clock_day = G_MININT64;
+    data->age_badge_minutes = -1;
+    retry_engine_init(&data->retry);
+    set_default_settings(data);
+    for (guint i = 0; i < N_FETCH_PHASES; i++) {
+        metrics_histogram_init(&data->histograms.fetch_phase[i], fetch_phase_bounds, G_N_ELEMENTS(fetch_phase_bounds));
+    }
+    metrics_histogram_init(&data->histograms.response_bytes, response_bytes_bounds, G_N_ELEMENTS(response_bytes_bounds));
+    metrics_histogram_init(&data->histograms.parse, main_thread_bounds, G_N_ELEMENTS(main_thread_bounds));
+    metrics_histogram_init(&data->histograms.commit, main_thread_bounds, G_N_ELEMENTS(main_thread_bounds));
+    metrics_histogram_init(&data->histograms.clock_jitter, clock_jitter_bounds, G_N_ELEMENTS(clock_jitter_bounds));
+    metrics_histogram_init(&data->histograms.frame, frame_bounds, G_N_ELEMENTS(frame_bounds));
     
-    if (!data->location_lat || !data->location_lon) {
+    if (!data->locations[0].lat || !data->locations[0].lon) {
         g_error("Failed to allocate location strings");
-        g_free(data->location_lat);
-        g_free(data->location_lon);
+        g_free(data->locations[0].lat);
+        g_free(data->locations[0].lon);
         g_free(data);
         return 1;
     }
     
     // Load location from config file (if exists)
     load_location_from_config(data);
+    log_startup_phase(data, "config");
+    
+#ifdef __GLIBC__
+    // Before any thread exists: each thread that allocates would otherwise get
+    // its own heap (up to 8 per core), each holding on to its free pages
+    if (data->memory_compact) {
+        mallopt(M_ARENA_MAX, COMPACT_MALLOC_ARENAS);
+    }
+#endif
+    reset_render_quality(data);
+    
+    // Spread refreshes across the fleet; at most half a slot so a device never
+    // drifts into its neighbour's window
+    data->refresh_jitter_max = MIN(data->refresh_jitter_max, data->refresh_interval / 2);
+    data->refresh_offset = compute_refresh_offset(data);
+    g_debug("Refreshing every %u s, %u s into each slot", data->refresh_interval, data->refresh_offset);
     
     // Command line arguments override config file
     if (argc >= 3) {
-        g_free(data->location_lat);
-        g_free(data->location_lon);
-        data->location_lat = g_strdup(argv[1]);
-        data->location_lon = g_strdup(argv[2]);
+        g_free(data->locations[0].lat);
+        g_free(data->locations[0].lon);
+        data->locations[0].lat = g_strdup(argv[1]);
+        data->locations[0].lon = g_strdup(argv[2]);
         
-        if (!data->location_lat || !data->location_lon) {
+        if (!data->locations[0].lat || !data->locations[0].lon) {
             g_error("Failed to allocate location strings from arguments");
-            g_free(data->location_lat);
-            g_free(data->location_lon);
+            g_free(data->locations[0].lat);
+            g_free(data->locations[0].lon);
             g_free(data);
             return 1;
         }
         
+        // Further "lat lon" pairs replace the configured additional locations
+        if (argc >= 5) {
+            gchar *lats[MAX_LOCATIONS - 1];
+            gchar *lons[MAX_LOCATIONS - 1];
+            guint n_pairs = 0;
+            for (int i = 3; i + 1 < argc; i += 2) {
+                if (!is_valid_coordinate(argv[i], 90.0) || !is_valid_coordinate(argv[i + 1], 180.0)) {
+                    g_warning("Ignoring invalid location %s %s", argv[i], argv[i + 1]);
+                } else if (n_pairs == MAX_LOCATIONS - 1) {
+                    g_warning("Ignoring location %s %s: at most %d locations are shown", argv[i], argv[i + 1],
+                              MAX_LOCATIONS);
+                } else {
+                    lats[n_pairs] = g_strdup(argv[i]);
+                    lons[n_pairs] = g_strdup(argv[i + 1]);
+                    n_pairs++;
+                }
+            }
+            set_additional_locations(data, lats, lons, n_pairs);
+        }
+        
         // Save command line arguments to config
         save_location_to_config(data);
     }
     
     // Create Soup session for HTTP requests
-    data->session = soup_session_new();
+    data->session = create_soup_session(data);
     if (!data->session) {
         g_error("Failed to create SoupSession");
-        g_free(data->location_lat);
-        g_free(data->location_lon);
+        g_free(data->locations[0].lat);
+        g_free(data->locations[0].lon);
         g_free(data);
         return 1;
     }
+    log_startup_phase(data, "HTTP session");
     
-    GtkApplication *app = gtk_application_new("com.weatherclock.app", G_APPLICATION_DEFAULT_FLAGS);
+    // Shared-fetch instances must each run their own process (one per display),
+    // so GApplication uniqueness is turned off and the broker coordinates instead
+    GApplicationFlags app_flags = data->shared_fetch ? G_APPLICATION_NON_UNIQUE : G_APPLICATION_DEFAULT_FLAGS;
+    GtkApplication *app = gtk_application_new("com.weatherclock.app", app_flags);
     if (!app) {
         g_error("Failed to create GtkApplication");
         g_object_unref(data->session);
-        g_free(data->location_lat);
-        g_free(data->location_lon);
+        g_free(data->locations[0].lat);
+        g_free(data->locations[0].lon);
         g_free(data);
         return 1;
     }
@@ -1602,12 +3972,60 @@ int main(int argc, char *argv[]) {
     
     int status = g_application_run(G_APPLICATION(app), argc, argv);
     
-    // Cleanup: cancel pending HTTP requests
-    // In libsoup-3.0, unref'ing a message automatically cancels it
+    // Cleanup: stop the watchdog before the sources it pings through go away
+    g_clear_pointer(&data->watchdog, watchdog_free);
+    
+    // Cleanup: services that never got started
+    if (data->services_source_id != 0) {
+        g_source_remove(data->services_source_id);
+        data->services_source_id = 0;
+    }
+    if (data->first_frame_clock) {
+        g_signal_handlers_disconnect_by_func(data->first_frame_clock, on_first_frame_painted, data);
+        g_clear_object(&data->first_frame_clock);
+    }
+    
+    // Cleanup: leave the shared-fetch group first so another instance takes over
+    forecast_broker_free(data->broker);
+    data->broker = NULL;
+    
+    // Cleanup: cancel pending HTTP requests and forecast decodes
+    if (data->fetch_cancellable) {
+        g_cancellable_cancel(data->fetch_cancellable);
+        g_object_unref(data->fetch_cancellable);
+        data->fetch_cancellable = NULL;
+    }
     if (data->pending_message) {
         g_object_unref(data->pending_message);
         data->pending_message = NULL;
     }
+    if (data->geocode_timer_id != 0) {
+        g_source_remove(data->geocode_timer_id);
+        data->geocode_timer_id = 0;
+    }
+    if (data->geocode_cancellable) {
+        g_cancellable_cancel(data->geocode_cancellable);
+        g_clear_object(&data->geocode_cancellable);
+    }
+    
+    // Cleanup: stop following the config, then don't lose a change still
+    // waiting for its debounced write
+    if (data->config_monitor) {
+        g_signal_handlers_disconnect_by_data(data->config_monitor, data);
+        g_object_unref(data->config_monitor);
+        data->config_monitor = NULL;
+    }
+    if (data->config_reload_timer_id != 0) {
+        g_source_remove(data->config_reload_timer_id);
+        data->config_reload_timer_id = 0;
+    }
+    if (data->config_read_cancellable) {
+        g_cancellable_cancel(data->config_read_cancellable);
+        g_clear_object(&data->config_read_cancellable);
+    }
+    flush_config(data);
+    flush_place_index(data);
+    g_clear_pointer(&data->metrics_server, metrics_server_free);
     
     // Cleanup: remove timer sources
     if (data->clock_timer_id != 0) {
@@ -1622,6 +4040,10 @@ int main(int argc, char *argv[]) {
         g_source_remove(data->retry_timer_id);
         data->retry_timer_id = 0;
     }
+    if (data->window_timer_id != 0) {
+        g_source_remove(data->window_timer_id);
+        data->window_timer_id = 0;
+    }
     
     // Cleanup: remove CSS provider from display before unreffing
     if (data->css_provider) {
@@ -1643,30 +4065,65 @@ int main(int argc, char *argv[]) {
     if (data->window) {
         data->window = NULL;
     }
+    data->watched_surface = NULL;
+    if (data->screensaver_bus) {
+        for (guint i = 0; i < G_N_ELEMENTS(data->screensaver_subscriptions); i++) {
+            if (data->screensaver_subscriptions[i] != 0) {
+                g_dbus_connection_signal_unsubscribe(data->screensaver_bus, data->screensaver_subscriptions[i]);
+            }
+        }
+        g_object_unref(data->screensaver_bus);
+        data->screensaver_bus = NULL;
+    }
     
     // Cleanup: null out widget pointers to prevent use-after-free
     // These widgets are children of windows and are destroyed automatically
     data->clock_label = NULL;
     data->date_label = NULL;
     data->weather_box = NULL;
+    data->weather_error_label = NULL;
+    data->age_label = NULL;
+    data->extra_locations_entry = NULL;
     data->lat_entry = NULL;
     data->lon_entry = NULL;
+    data->search_entry = NULL;
+    data->search_results = NULL;
+    data->search_status = NULL;
     
     g_object_unref(app);
     if (data->session) {
         g_object_unref(data->session);
         data->session = NULL;
     }
+    g_clear_object(&data->geocode_session);
+    g_clear_pointer(&data->places, place_index_free);
     if (data->tz) {
         g_time_zone_unref(data->tz);
         data->tz = NULL;
     }
-    g_free(data->location_lat);
-    data->location_lat = NULL;
-    g_free(data->location_lon);
-    data->location_lon = NULL;
+    if (data->local_tz) {
+        g_time_zone_unref(data->local_tz);
+        data->local_tz = NULL;
+    }
+    if (data->clock_tz_table_zone) {
+        g_time_zone_unref(data->clock_tz_table_zone);
+        data->clock_tz_table_zone = NULL;
+    }
+    for (guint i = 0; i < MAX_LOCATIONS; i++) {
+        LocationStrip *location = &data->locations[i];
+        forecast_free(location->forecast);
+        forecast_daily_free(location->daily);
+        g_free(location->lat);
+        g_free(location->lon);
+        memset(location, 0, sizeof(*location));
+    }
+    data->n_locations = 0;
     g_free(data->timezone);
     data->timezone = NULL;
+    g_free(data->config_written);
+    data->config_written = NULL;
+    clear_validators(data);
+    g_clear_pointer(&data->spare_snapshot, forecast_snapshot_free);
     g_free(data);
     
     return status;
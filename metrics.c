@@ -0,0 +1,241 @@
+#include "metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#define METRICS_REQUEST_MAX 2048  // Request line plus headers; anything longer is rejected
+
+struct _MetricsServer {
+    GSocketService *service;
+    GCancellable *cancellable;   // Requests still being answered
+    MetricsCollectFunc collect;
+    gpointer user_data;
+};
+
+// One scrape in progress
+typedef struct {
+    MetricsServer *server;
+    GSocketConnection *connection;
+    gchar request[METRICS_REQUEST_MAX + 1];
+    gsize length;
+    GBytes *response;
+} MetricsClient;
+
+void metrics_histogram_init(MetricsHistogram *histogram, const gdouble *bounds, guint n_bounds) {
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->bounds = bounds;
+    histogram->n_bounds = MIN(n_bounds, METRICS_HISTOGRAM_MAX_BOUNDS);
+}
+
+void metrics_histogram_observe(MetricsHistogram *histogram, gdouble value) {
+    guint bucket = 0;
+    while (bucket < histogram->n_bounds && value > histogram->bounds[bucket]) {
+        bucket++;
+    }
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    histogram->sum += value;
+}
+
+void metrics_append_header(GString *out, const gchar *name, const gchar *type, const gchar *help) {
+    g_string_append_printf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// Locale-independent: the exposition format wants '.' whatever LC_NUMERIC says.
+// 15 digits keep bounds short ("0.1") and counters exact up to 10^15.
+static void append_number(GString *out, gdouble value) {
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+    g_string_append(out, g_ascii_formatd(buffer, sizeof(buffer), "%.15g", value));
+}
+
+void metrics_append_value(GString *out, const gchar *name, const gchar *labels, gdouble value) {
+    g_string_append(out, name);
+    if (labels && labels[0] != '\0') {
+        g_string_append_printf(out, "{%s}", labels);
+    }
+    g_string_append_c(out, ' ');
+    append_number(out, value);
+    g_string_append_c(out, '\n');
+}
+
+void metrics_append_histogram(GString *out, const gchar *name, const gchar *labels,
+                              const MetricsHistogram *histogram) {
+    const gchar *separator = labels && labels[0] != '\0' ? "," : "";
+    guint64 cumulative = 0;
+    for (guint i = 0; i <= histogram->n_bounds; i++) {
+        cumulative += histogram->buckets[i];
+        g_string_append_printf(out, "%s_bucket{%s%sle=\"", name, labels ? labels : "", separator);
+        if (i < histogram->n_bounds) {
+            append_number(out, histogram->bounds[i]);
+        } else {
+            g_string_append(out, "+Inf");
+        }
+        g_string_append(out, "\"} ");
+        g_string_append_printf(out, "%" G_GUINT64_FORMAT "\n", cumulative);
+    }
+
+    gchar *sum_name = g_strconcat(name, "_sum", NULL);
+    gchar *count_name = g_strconcat(name, "_count", NULL);
+    metrics_append_value(out, sum_name, labels, histogram->sum);
+    metrics_append_value(out, count_name, labels, (gdouble)histogram->count);
+    g_free(sum_name);
+    g_free(count_name);
+}
+
+guint64 metrics_resident_bytes(void) {
+#ifdef __linux__
+    // Second field of statm: resident pages
+    gchar *contents = NULL;
+    guint64 pages = 0;
+    if (g_file_get_contents("/proc/self/statm", &contents, NULL, NULL)) {
+        gchar *resident = strchr(contents, ' ');
+        pages = resident ? g_ascii_strtoull(resident + 1, NULL, 10) : 0;
+        g_free(contents);
+    }
+    long page_size = sysconf(_SC_PAGESIZE);
+    return pages * (guint64)(page_size > 0 ? page_size : 4096);
+#else
+    return 0;
+#endif
+}
+
+static void metrics_client_free(MetricsClient *client) {
+    g_io_stream_close(G_IO_STREAM(client->connection), NULL, NULL);
+    g_object_unref(client->connection);
+    if (client->response) {
+        g_bytes_unref(client->response);
+    }
+    g_free(client);
+}
+
+static void on_response_written(GObject *source, GAsyncResult *result, gpointer user_data) {
+    MetricsClient *client = (MetricsClient *)user_data;
+    GError *error = NULL;
+    if (!g_output_stream_write_all_finish(G_OUTPUT_STREAM(source), result, NULL, &error)) {
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            g_debug("Metrics: response not sent: %s", error->message);
+        }
+        g_error_free(error);
+    }
+    metrics_client_free(client);
+}
+
+// Only GET /metrics (and / for curl convenience) is served. HTTP/1.0 with
+// Connection: close, so there is no keep-alive state to track.
+static void send_response(MetricsClient *client) {
+    const gchar *status = "200 OK";
+    GString *body = NULL;
+    if (strncmp(client->request, "GET ", 4) != 0) {
+        status = "405 Method Not Allowed";
+    } else if (strncmp(client->request + 4, "/metrics ", 9) == 0 || strncmp(client->request + 4, "/ ", 2) == 0) {
+        body = client->server->collect(client->server->user_data);
+    } else {
+        status = "404 Not Found";
+    }
+    if (!body) {
+        body = g_string_new(status);
+        g_string_append_c(body, '\n');
+    }
+
+    GString *response = g_string_sized_new(body->len + 160);
+    g_string_append_printf(response,
+                           "HTTP/1.0 %s\r\n"
+                           "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                           "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                           "Connection: close\r\n"
+                           "\r\n",
+                           status, body->len);
+    g_string_append_len(response, body->str, (gssize)body->len);
+    g_string_free(body, TRUE);
+    client->response = g_string_free_to_bytes(response);
+
+    gsize length = 0;
+    const gchar *data = g_bytes_get_data(client->response, &length);
+    g_output_stream_write_all_async(g_io_stream_get_output_stream(G_IO_STREAM(client->connection)), data, length,
+                                    G_PRIORITY_DEFAULT, client->server->cancellable, on_response_written, client);
+}
+
+static void read_request(MetricsClient *client);
+
+static void on_request_read(GObject *source, GAsyncResult *result, gpointer user_data) {
+    MetricsClient *client = (MetricsClient *)user_data;
+    GError *error = NULL;
+    gssize n_read = g_input_stream_read_finish(G_INPUT_STREAM(source), result, &error);
+    if (n_read <= 0) {
+        // Closed early, failed, or the server is going away
+        g_clear_error(&error);
+        metrics_client_free(client);
+        return;
+    }
+
+    client->length += (gsize)n_read;
+    client->request[client->length] = '\0';
+    if (strstr(client->request, "\r\n\r\n") || strstr(client->request, "\n\n") ||
+        client->length == METRICS_REQUEST_MAX) {
+        send_response(client);
+    } else {
+        read_request(client);
+    }
+}
+
+static void read_request(MetricsClient *client) {
+    g_input_stream_read_async(g_io_stream_get_input_stream(G_IO_STREAM(client->connection)),
+                              client->request + client->length, METRICS_REQUEST_MAX - client->length,
+                              G_PRIORITY_DEFAULT, client->server->cancellable, on_request_read, client);
+}
+
+static gboolean on_incoming(GSocketService *service, GSocketConnection *connection, GObject *source_object,
+                            gpointer user_data) {
+    (void)service;
+    (void)source_object;
+    MetricsClient *client = g_new0(MetricsClient, 1);
+    client->server = (MetricsServer *)user_data;
+    client->connection = g_object_ref(connection);
+    read_request(client);
+    return TRUE;
+}
+
+MetricsServer *metrics_server_new(guint16 port, MetricsCollectFunc collect, gpointer user_data, GError **error) {
+    g_return_val_if_fail(collect != NULL, NULL);
+
+    GSocketService *service = g_socket_service_new();
+    GInetAddress *loopback = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+    GSocketAddress *address = g_inet_socket_address_new(loopback, port);
+    gboolean listening = g_socket_listener_add_address(G_SOCKET_LISTENER(service), address, G_SOCKET_TYPE_STREAM,
+                                                       G_SOCKET_PROTOCOL_DEFAULT, NULL, NULL, error);
+    g_object_unref(address);
+    g_object_unref(loopback);
+    if (!listening) {
+        g_object_unref(service);
+        return NULL;
+    }
+
+    MetricsServer *server = g_new0(MetricsServer, 1);
+    server->service = service;
+    server->cancellable = g_cancellable_new();
+    server->collect = collect;
+    server->user_data = user_data;
+    g_signal_connect(service, "incoming", G_CALLBACK(on_incoming), server);
+    g_socket_service_start(service);
+    return server;
+}
+
+void metrics_server_free(MetricsServer *server) {
+    if (!server) {
+        return;
+    }
+    g_signal_handlers_disconnect_by_data(server->service, server);
+    g_socket_service_stop(server->service);
+    g_socket_listener_close(G_SOCKET_LISTENER(server->service));
+    g_object_unref(server->service);
+
+    // Clients still in flight see G_IO_ERROR_CANCELLED and free themselves
+    // without touching the server again
+    g_cancellable_cancel(server->cancellable);
+    g_object_unref(server->cancellable);
+    g_free(server);
+}
@@ -0,0 +1,46 @@
+#ifndef WEATHERCLOCK_METRICS_H
+#define WEATHERCLOCK_METRICS_H
+
+#include <gio/gio.h>
+
+// Prometheus text-format metrics for fleet monitoring: fixed-bucket histograms
+// cheap enough to feed from the hot paths, helpers that format samples, and a
+// minimal HTTP server answering GET /metrics on a loopback port. The server
+// asks the caller for the current text on every scrape and keeps no state of
+// its own, so the counters stay wherever the code that updates them lives.
+
+#define METRICS_HISTOGRAM_MAX_BOUNDS 16
+
+typedef struct {
+    const gdouble *bounds;   // Bucket upper bounds, ascending; the +Inf bucket is implicit
+    guint n_bounds;
+    guint64 buckets[METRICS_HISTOGRAM_MAX_BOUNDS + 1];  // Per bucket (not cumulative), +Inf last
+    guint64 count;
+    gdouble sum;
+} MetricsHistogram;
+
+// bounds must outlive the histogram (a static array); at most METRICS_HISTOGRAM_MAX_BOUNDS
+void metrics_histogram_init(MetricsHistogram *histogram, const gdouble *bounds, guint n_bounds);
+void metrics_histogram_observe(MetricsHistogram *histogram, gdouble value);
+
+// "# HELP" and "# TYPE" lines; type is "counter", "gauge" or "histogram"
+void metrics_append_header(GString *out, const gchar *name, const gchar *type, const gchar *help);
+// One sample; labels is the inside of the braces ("phase=\"dns\"") or NULL
+void metrics_append_value(GString *out, const gchar *name, const gchar *labels, gdouble value);
+// The _bucket, _sum and _count samples of one histogram
+void metrics_append_histogram(GString *out, const gchar *name, const gchar *labels,
+                              const MetricsHistogram *histogram);
+
+// Resident set size of this process in bytes, 0 where the platform doesn't say
+guint64 metrics_resident_bytes(void);
+
+// Returns the full metrics text for one scrape; the server frees it
+typedef GString *(*MetricsCollectFunc)(gpointer user_data);
+
+typedef struct _MetricsServer MetricsServer;
+
+// Listen on 127.0.0.1:port. Returns NULL (and sets error) if the port is taken.
+MetricsServer *metrics_server_new(guint16 port, MetricsCollectFunc collect, gpointer user_data, GError **error);
+void metrics_server_free(MetricsServer *server);
+
+#endif // WEATHERCLOCK_METRICS_H
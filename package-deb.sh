@@ -1,6 +1,6 @@
 #!/bin/bash
 # Debian Package Builder for WeatherClockGTK
-# Supports both x86_64 (amd64) and arm64 architectures
+# Supports x86_64 (amd64), arm64 and armhf architectures
 
 set -e
 
@@ -15,13 +15,13 @@ PACKAGE_NAME="weatherclockgtk"
 VERSION="1.2.0"
 MAINTAINER="WeatherClockGTK Maintainer <maintainer@example.com>"
 DESCRIPTION="GTK4-based clock and weather application for repurposed tablets"
-ARCHITECTURES="amd64 arm64"
+ARCHITECTURES="amd64 arm64 armhf"
 
 # Detect current architecture
 CURRENT_ARCH=$(dpkg --print-architecture)
-if [ "$CURRENT_ARCH" != "amd64" ] && [ "$CURRENT_ARCH" != "arm64" ]; then
+if [[ " $ARCHITECTURES " != *" $CURRENT_ARCH "* ]]; then
     echo -e "${RED}Error: Unsupported architecture: $CURRENT_ARCH${NC}"
-    echo "Supported architectures: amd64, arm64"
+    echo "Supported architectures: amd64, arm64, armhf"
     exit 1
 fi
 
@@ -57,10 +57,6 @@ if ! pkg-config --exists libsoup-3.0; then
     MISSING_DEPS+=("libsoup-3.0-dev")
 fi
 
-if ! pkg-config --exists json-glib-1.0; then
-    MISSING_DEPS+=("json-glib-dev")
-fi
-
 if [ ${#MISSING_DEPS[@]} -ne 0 ]; then
     echo -e "${YELLOW}Missing build dependencies:${NC}"
     for dep in "${MISSING_DEPS[@]}"; do
@@ -91,17 +87,15 @@ Build-Depends: debhelper (>= 13),
                pkg-config,
                libgtk-4-dev,
                libsoup-3.0-dev,
-               libjson-glib-dev,
                build-essential
 Standards-Version: 4.6.0
 Homepage: https://github.com/yourusername/WeatherClockGTK
 
 Package: $PACKAGE_NAME
-Architecture: amd64 arm64
+Architecture: $ARCHITECTURES
 Depends: \${shlibs:Depends}, \${misc:Depends},
          libgtk-4-1,
          libsoup-3.0-0,
-         libjson-glib-1.0-0,
          libglib2.0-0,
          libc6
 Description: $DESCRIPTION
@@ -118,19 +112,25 @@ Description: $DESCRIPTION
   - Cross-platform support (Windows and Linux)
 EOF
 
-# Create debian/rules
+# Create debian/rules: the release preset's settings, then a PGO rebuild
+# trained on weatherclock-replay (see "Release Build" in README.md)
 cat > debian/rules << 'EOF'
 #!/usr/bin/make -f
 
+RELEASE_FLAGS = -DCMAKE_BUILD_TYPE=Release -DWEATHERCLOCK_LTO=ON -DWEATHERCLOCK_GC_SECTIONS=ON -DWEATHERCLOCK_TUNE=auto
+
 %:
 	dh $@
 
 override_dh_auto_configure:
 	mkdir -p build
-	cd build && cmake -DCMAKE_INSTALL_PREFIX=/usr ..
+	cd build && cmake -DCMAKE_INSTALL_PREFIX=/usr $(RELEASE_FLAGS) -DWEATHERCLOCK_PGO=GENERATE ..
 
 override_dh_auto_build:
-	cd build && cmake --build . -j$(nproc)
+	cd build && cmake --build . -j$$(nproc)
+	cd build && cmake --build . --target pgo-train
+	cd build && cmake -DWEATHERCLOCK_PGO=USE ..
+	cd build && cmake --build . -j$$(nproc)
 
 override_dh_auto_install:
 	cd build && DESTDIR=$(CURDIR)/debian/weatherclockgtk cmake --install .
@@ -182,13 +182,57 @@ EOF
 
 chmod +x debian/postrm
 
+# Stripped size, time to first frame and replay CPU per refresh of one build.
+# Startup and the widget stages of the replay need xvfb-run; without it the
+# startup column is empty and the CPU figure covers decode and cache only.
+measure_build() {
+    local dir="$1"
+    local size startup cpu
+    strip -o "$dir/weatherclock.stripped" "$dir/weatherclock"
+    size=$(stat -c %s "$dir/weatherclock.stripped")
+    rm -f "$dir/weatherclock.stripped"
+
+    startup="n/a"
+    if command -v xvfb-run &> /dev/null; then
+        local home
+        home=$(mktemp -d)
+        # The startup log line: "Startup: first frame took X ms (Y ms since launch)"
+        startup=$(HOME="$home" G_MESSAGES_DEBUG=all xvfb-run -a timeout 5 "$dir/weatherclock" 2>&1 |
+                  sed -n 's/.*Startup: first frame took .* (\([0-9.]*\) ms since launch).*/\1 ms/p' | head -1)
+        rm -rf "$home"
+    fi
+
+    local launcher=()
+    if command -v xvfb-run &> /dev/null; then
+        launcher=(xvfb-run -a)
+    fi
+    local recordings iterations=100 seconds
+    recordings=$(ls bench/data/*.json | wc -l)
+    TIMEFORMAT="%3U %3S"
+    seconds=$( { time "${launcher[@]}" "$dir/weatherclock-replay" --iterations $iterations > /dev/null 2>&1; } 2>&1 |
+               awk '{ print $1 + $2 }')
+    cpu=$(awk -v s="$seconds" -v n=$((iterations * recordings)) 'BEGIN { printf "%.1f us", s * 1e6 / n }')
+
+    printf "  %-10s %10s B  startup %-10s  CPU/refresh %s\n" "$2" "$size" "${startup:-n/a}" "$cpu"
+}
+
+# The packaged build next to a default one (plain "cmake ..", as build.sh makes)
+compare_builds() {
+    echo "Building the default configuration for comparison..."
+    cmake -S . -B build-default > /dev/null
+    cmake --build build-default -j$(nproc) > /dev/null
+    echo "Build comparison (stripped size, time to first frame, replay CPU per refresh):"
+    measure_build build-default "default"
+    measure_build build "release"
+}
+
 # Build the package
 echo ""
 echo "Building Debian package..."
 echo ""
 
 # Clean any previous builds
-rm -rf build
+rm -rf build build-default
 rm -f ../${PACKAGE_NAME}_*.deb ../${PACKAGE_NAME}_*.dsc ../${PACKAGE_NAME}_*.tar.gz ../${PACKAGE_NAME}_*.changes
 
 # Build package
@@ -207,6 +251,8 @@ if [ $? -eq 0 ]; then
         SIZE=$(du -h "$DEB_FILE" | cut -f1)
         echo "Package size: $SIZE"
         echo ""
+        compare_builds
+        echo ""
         echo "To install:"
         echo "  sudo dpkg -i $DEB_FILE"
         echo ""
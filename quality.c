@@ -0,0 +1,111 @@
+#include "quality.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const gchar *quality_names[RENDER_QUALITY_N_LEVELS] = {
+    "full",
+    "flat",
+    "minimal",
+};
+
+const gchar *render_quality_name(RenderQuality quality) {
+    return quality < RENDER_QUALITY_N_LEVELS ? quality_names[quality] : "full";
+}
+
+gboolean render_quality_from_name(const gchar *name, RenderQuality *quality) {
+    for (guint i = 0; name && i < RENDER_QUALITY_N_LEVELS; i++) {
+        if (g_ascii_strcasecmp(name, quality_names[i]) == 0) {
+            *quality = (RenderQuality)i;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void set_quality(QualityGovernor *governor, RenderQuality quality, gint64 now) {
+    governor->quality = quality;
+    governor->n_samples = 0;
+    governor->warmup = QUALITY_WARMUP_FRAMES;
+    governor->headroom_frames = 0;
+    governor->changed_at = now;
+    governor->settled = FALSE;
+}
+
+void quality_governor_init(QualityGovernor *governor, RenderQuality floor, RenderQuality ceiling,
+                           gint64 budget_us, gint64 now) {
+    memset(governor, 0, sizeof(*governor));
+    governor->ceiling = MIN(ceiling, RENDER_QUALITY_N_LEVELS - 1);
+    governor->floor = CLAMP(floor, governor->ceiling, RENDER_QUALITY_N_LEVELS - 1);
+    governor->budget_us = MAX(budget_us, 1);
+    governor->probe_frames = QUALITY_PROBE_FRAMES;
+    set_quality(governor, governor->ceiling, now);
+}
+
+static int compare_frames(const void *a, const void *b) {
+    gint64 x = *(const gint64 *)a;
+    gint64 y = *(const gint64 *)b;
+    return (x > y) - (x < y);
+}
+
+static gint64 window_median(const QualityGovernor *governor) {
+    gint64 sorted[QUALITY_WINDOW];
+    memcpy(sorted, governor->window, sizeof(sorted));
+    qsort(sorted, QUALITY_WINDOW, sizeof(sorted[0]), compare_frames);
+    return sorted[QUALITY_WINDOW / 2];
+}
+
+QualityEvent quality_governor_observe(QualityGovernor *governor, gint64 frame_us, gint64 now) {
+    governor->frames++;
+    if (frame_us > governor->budget_us) {
+        governor->frames_over_budget++;
+    }
+    if (governor->floor == governor->ceiling) {
+        return QUALITY_UNCHANGED;  // Pinned by the config
+    }
+    if (governor->warmup > 0) {
+        governor->warmup--;
+        return QUALITY_UNCHANGED;
+    }
+
+    // The last QUALITY_WINDOW frames at this level, oldest overwritten first
+    governor->window[governor->n_samples % QUALITY_WINDOW] = frame_us;
+    governor->n_samples++;
+    if (governor->n_samples >= QUALITY_WINDOW) {
+        gint64 median = window_median(governor);
+        if (median > governor->budget_us && governor->quality < governor->floor) {
+            if (governor->probing) {
+                // The level we came from can't be held either: wait longer before trying again
+                governor->probe_frames = MIN(governor->probe_frames * 2, QUALITY_MAX_PROBE_FRAMES);
+                governor->probing = FALSE;
+            }
+            g_info("Render quality: frames take %.1f ms (budget %.1f ms), stepping down to %s",
+                   median / 1000.0, governor->budget_us / 1000.0, render_quality_name(governor->quality + 1));
+            governor->steps_down++;
+            set_quality(governor, governor->quality + 1, now);
+            return QUALITY_CHANGED;
+        }
+        if (governor->probing && governor->n_samples == QUALITY_WINDOW) {
+            governor->probing = FALSE;  // A full window within budget: this level holds
+        }
+    }
+
+    if (frame_us * 100 < governor->budget_us * QUALITY_HEADROOM_PERCENT) {
+        governor->headroom_frames++;
+    } else {
+        governor->headroom_frames = 0;
+    }
+    if (governor->headroom_frames >= governor->probe_frames && governor->quality > governor->ceiling) {
+        g_info("Render quality: frames have headroom, trying %s", render_quality_name(governor->quality - 1));
+        governor->steps_up++;
+        set_quality(governor, governor->quality - 1, now);
+        governor->probing = TRUE;
+        return QUALITY_CHANGED;
+    }
+
+    if (!governor->settled && now - governor->changed_at >= (gint64)QUALITY_SETTLE_SECONDS * G_USEC_PER_SEC) {
+        governor->settled = TRUE;
+        return QUALITY_SETTLED;
+    }
+    return QUALITY_UNCHANGED;
+}
@@ -0,0 +1,67 @@
+#ifndef WEATHERCLOCK_QUALITY_H
+#define WEATHERCLOCK_QUALITY_H
+
+#include <glib.h>
+
+// Adaptive render quality for slow GPUs and software rendering. The caller
+// times each frame (GdkFrameClock before-paint to after-paint) and feeds it
+// here; the governor steps quality down when the median of a window of frames
+// misses the budget, and back up after a run of frames with plenty of
+// headroom. A step up that misses again doubles the headroom needed before the
+// next try, so a device that can't hold a level stops flickering between two.
+// Pure bookkeeping: the caller applies the quality and reads the struct.
+
+#define QUALITY_WINDOW 8                  // Frames whose median decides a step down
+#define QUALITY_WARMUP_FRAMES 2           // Frames ignored after a change: restyle and new glyphs
+#define QUALITY_HEADROOM_PERCENT 33       // A frame under this share of the budget has headroom
+#define QUALITY_PROBE_FRAMES 120          // Headroom frames before the first step up
+#define QUALITY_MAX_PROBE_FRAMES 7680     // Doubled after each failed step up, up to this
+#define QUALITY_SETTLE_SECONDS 600        // Unchanged this long: reported as settled
+
+typedef enum {
+    RENDER_QUALITY_FULL,      // Translucent rounded cards and panels, as designed
+    RENDER_QUALITY_FLAT,      // Opaque square cards: no blending, no rounded clips
+    RENDER_QUALITY_MINIMAL,   // No card fills; the clock composites cached glyph textures
+    RENDER_QUALITY_N_LEVELS
+} RenderQuality;
+
+typedef enum {
+    QUALITY_UNCHANGED,
+    QUALITY_CHANGED,          // quality is new: apply it
+    QUALITY_SETTLED           // No change for QUALITY_SETTLE_SECONDS (reported once per level)
+} QualityEvent;
+
+typedef struct {
+    RenderQuality quality;
+    RenderQuality floor;          // Lowest level the governor may pick (config)
+    RenderQuality ceiling;        // Highest level the governor may pick (config)
+    gint64 budget_us;
+    gint64 window[QUALITY_WINDOW];
+    guint n_samples;              // Frames in window at this level, up to QUALITY_WINDOW
+    guint warmup;                 // Frames still to ignore
+    guint headroom_frames;        // Consecutive frames under the headroom threshold
+    guint probe_frames;           // Headroom frames needed for the next step up
+    gboolean probing;             // Stepped up and not yet confirmed by a full window
+    gint64 changed_at;            // Monotonic time of the last change (or init)
+    gboolean settled;             // QUALITY_SETTLED was reported for this level
+
+    // Lifetime counters for metrics
+    guint64 frames;
+    guint64 frames_over_budget;
+    guint64 steps_down;
+    guint64 steps_up;
+} QualityGovernor;
+
+// Starts at ceiling. floor == ceiling pins the quality (adaptation off).
+void quality_governor_init(QualityGovernor *governor, RenderQuality floor, RenderQuality ceiling,
+                           gint64 budget_us, gint64 now);
+
+// One painted frame that took frame_us; now is monotonic time in microseconds
+QualityEvent quality_governor_observe(QualityGovernor *governor, gint64 frame_us, gint64 now);
+
+// Stable lower-case name for logs, config and metric labels ("full", "flat", "minimal")
+const gchar *render_quality_name(RenderQuality quality);
+// Parse a name as above; FALSE if it is none of them
+gboolean render_quality_from_name(const gchar *name, RenderQuality *quality);
+
+#endif // WEATHERCLOCK_QUALITY_H
@@ -0,0 +1,191 @@
+#include "retry.h"
+
+#include <string.h>
+
+static const gchar *class_names[FETCH_ERROR_N_CLASSES] = {
+    "none",
+    "dns",
+    "connect",
+    "timeout",
+    "tls",
+    "http_5xx",
+    "rate_limited",
+    "http_4xx",
+    "empty",
+    "parse",
+    "other",
+};
+
+static const gchar *class_descriptions[FETCH_ERROR_N_CLASSES] = {
+    "no error",
+    "server name lookup failed",
+    "no network connection",
+    "request timed out",
+    "secure connection failed",
+    "server error",
+    "rate limited by server",
+    "request rejected",
+    "empty response",
+    "unusable weather data",
+    "network error",
+};
+
+void retry_engine_init(RetryEngine *engine) {
+    memset(engine, 0, sizeof(*engine));
+    engine->prev_delay = RETRY_BASE_DELAY;
+}
+
+FetchErrorClass retry_classify_error(const GError *error) {
+    if (!error) {
+        return FETCH_ERROR_NONE;
+    }
+    if (error->domain == G_RESOLVER_ERROR) {
+        return FETCH_ERROR_DNS;
+    }
+    if (error->domain == G_TLS_ERROR) {
+        return FETCH_ERROR_TLS;
+    }
+    if (error->domain == G_IO_ERROR) {
+        switch (error->code) {
+        case G_IO_ERROR_HOST_NOT_FOUND:
+            return FETCH_ERROR_DNS;
+        case G_IO_ERROR_TIMED_OUT:
+            return FETCH_ERROR_TIMEOUT;
+        case G_IO_ERROR_CONNECTION_REFUSED:
+        case G_IO_ERROR_HOST_UNREACHABLE:
+        case G_IO_ERROR_NETWORK_UNREACHABLE:
+        case G_IO_ERROR_CONNECTION_CLOSED:  // Same value as G_IO_ERROR_BROKEN_PIPE
+        case G_IO_ERROR_NOT_CONNECTED:
+            return FETCH_ERROR_CONNECT;
+        default:
+            break;
+        }
+    }
+    return FETCH_ERROR_OTHER;
+}
+
+FetchErrorClass retry_classify_status(guint status) {
+    if (status == 429) {
+        return FETCH_ERROR_RATE_LIMITED;
+    }
+    if (status >= 500 && status <= 599) {
+        return FETCH_ERROR_HTTP_5XX;
+    }
+    if (status >= 400 && status <= 499) {
+        return FETCH_ERROR_HTTP_4XX;
+    }
+    return FETCH_ERROR_NONE;
+}
+
+const gchar *fetch_error_class_name(FetchErrorClass error_class) {
+    return error_class < FETCH_ERROR_N_CLASSES ? class_names[error_class] : "other";
+}
+
+const gchar *fetch_error_class_describe(FetchErrorClass error_class) {
+    return error_class < FETCH_ERROR_N_CLASSES ? class_descriptions[error_class] : "network error";
+}
+
+const gchar *retry_circuit_state_name(RetryCircuitState state) {
+    switch (state) {
+    case RETRY_CIRCUIT_OPEN:
+        return "open";
+    case RETRY_CIRCUIT_HALF_OPEN:
+        return "half_open";
+    default:
+        return "closed";
+    }
+}
+
+// Failures that say the upstream (or the path to it) is unhealthy. A 4xx or a
+// bad body means the server answered, so they don't count toward the breaker.
+static gboolean is_upstream_failure(FetchErrorClass error_class) {
+    return error_class != FETCH_ERROR_HTTP_4XX && error_class != FETCH_ERROR_PARSE &&
+           error_class != FETCH_ERROR_NONE;
+}
+
+gboolean retry_engine_allow_request(RetryEngine *engine, gint64 now) {
+    if (engine->circuit != RETRY_CIRCUIT_OPEN) {
+        return TRUE;
+    }
+    if (now < engine->open_until) {
+        engine->requests_suppressed++;
+        return FALSE;
+    }
+    g_info("Retry: cooldown over, probing upstream");
+    engine->circuit = RETRY_CIRCUIT_HALF_OPEN;
+    return TRUE;
+}
+
+void retry_engine_reset(RetryEngine *engine) {
+    engine->attempt = 0;
+    engine->delay = 0;
+    engine->prev_delay = RETRY_BASE_DELAY;
+    engine->retrying = FALSE;
+}
+
+static void open_circuit(RetryEngine *engine, guint cooldown, guint retry_after, gint64 now) {
+    engine->circuit = RETRY_CIRCUIT_OPEN;
+    engine->cooldown = MAX(MIN(cooldown, RETRY_CIRCUIT_MAX_COOLDOWN), retry_after);
+    engine->open_until = now + engine->cooldown;
+    engine->circuit_trips++;
+    retry_engine_reset(engine);
+    g_warning("Retry: %u consecutive failures (last: %s), pausing requests for %u s",
+              engine->consecutive_failures, fetch_error_class_name(engine->last_error), engine->cooldown);
+}
+
+guint retry_engine_failure(RetryEngine *engine, FetchErrorClass error_class, guint retry_after, gint64 now) {
+    if (error_class >= FETCH_ERROR_N_CLASSES) {
+        error_class = FETCH_ERROR_OTHER;
+    }
+    engine->failures[error_class]++;
+    engine->last_error = error_class;
+
+    if (!is_upstream_failure(error_class)) {
+        // The server is up; whatever the breaker was guarding against is over
+        engine->consecutive_failures = 0;
+        engine->circuit = RETRY_CIRCUIT_CLOSED;
+    } else {
+        engine->consecutive_failures++;
+        if (engine->circuit == RETRY_CIRCUIT_OPEN) {
+            // A straggler from before the trip; the probe is already scheduled
+            return 0;
+        }
+        if (engine->circuit == RETRY_CIRCUIT_HALF_OPEN) {
+            open_circuit(engine, engine->cooldown * 2, retry_after, now);
+            return 0;
+        }
+        if (engine->consecutive_failures >= RETRY_CIRCUIT_THRESHOLD) {
+            open_circuit(engine, RETRY_CIRCUIT_COOLDOWN, retry_after, now);
+            return 0;
+        }
+    }
+
+    if (error_class == FETCH_ERROR_HTTP_4XX || engine->attempt >= RETRY_MAX_ATTEMPTS) {
+        retry_engine_reset(engine);
+        return 0;
+    }
+
+    // Decorrelated jitter: uniform in [base, 3 * previous], capped. Spreads
+    // retries from many clients apart instead of keeping them in lockstep.
+    guint upper = MIN(engine->prev_delay * 3, RETRY_MAX_DELAY);
+    guint delay = upper > RETRY_BASE_DELAY ? (guint)g_random_int_range(RETRY_BASE_DELAY, (gint32)upper + 1)
+                                           : RETRY_BASE_DELAY;
+    engine->prev_delay = delay;
+    engine->delay = MAX(delay, retry_after);
+    engine->attempt++;
+    engine->retrying = TRUE;
+    engine->retries_scheduled++;
+    return engine->delay;
+}
+
+void retry_engine_success(RetryEngine *engine) {
+    if (engine->circuit != RETRY_CIRCUIT_CLOSED) {
+        g_info("Retry: upstream recovered, resuming normal requests");
+    }
+    engine->circuit = RETRY_CIRCUIT_CLOSED;
+    engine->cooldown = 0;
+    engine->open_until = 0;
+    engine->consecutive_failures = 0;
+    engine->last_error = FETCH_ERROR_NONE;
+    retry_engine_reset(engine);
+}
@@ -0,0 +1,87 @@
+#ifndef WEATHERCLOCK_RETRY_H
+#define WEATHERCLOCK_RETRY_H
+
+#include <gio/gio.h>
+
+// Retry policy for the weather fetch. Failures are classified by cause, retries
+// within a failure sequence use decorrelated-jitter backoff, and a circuit
+// breaker stops requests for a cooldown once the upstream has failed too many
+// times in a row. Pure bookkeeping: the caller owns the timers and the UI, and
+// reads the state (and counters) straight from the struct.
+
+#define RETRY_MAX_ATTEMPTS 5             // Retries per failure sequence before waiting for the schedule
+#define RETRY_BASE_DELAY 30              // Seconds; lower bound of every retry delay
+#define RETRY_MAX_DELAY 600              // Seconds; upper bound (a longer Retry-After still wins)
+#define RETRY_CIRCUIT_THRESHOLD 8        // Consecutive upstream failures that open the circuit
+#define RETRY_CIRCUIT_COOLDOWN 900       // Seconds the circuit stays open the first time
+#define RETRY_CIRCUIT_MAX_COOLDOWN 3600  // Doubled after each failed probe, up to this
+
+typedef enum {
+    FETCH_ERROR_NONE,
+    FETCH_ERROR_DNS,           // Host name lookup failed
+    FETCH_ERROR_CONNECT,       // Refused, unreachable or reset
+    FETCH_ERROR_TIMEOUT,
+    FETCH_ERROR_TLS,           // Handshake or certificate problem
+    FETCH_ERROR_HTTP_5XX,
+    FETCH_ERROR_RATE_LIMITED,  // 429 Too Many Requests
+    FETCH_ERROR_HTTP_4XX,      // Other client errors: repeating the request won't help
+    FETCH_ERROR_EMPTY,         // No body, or an empty one
+    FETCH_ERROR_PARSE,         // Body wasn't a usable forecast
+    FETCH_ERROR_OTHER,
+    FETCH_ERROR_N_CLASSES
+} FetchErrorClass;
+
+typedef enum {
+    RETRY_CIRCUIT_CLOSED,     // Normal operation
+    RETRY_CIRCUIT_OPEN,       // Upstream considered down: no requests until open_until
+    RETRY_CIRCUIT_HALF_OPEN   // Cooldown over: the next request is a probe
+} RetryCircuitState;
+
+typedef struct {
+    guint attempt;               // Retries scheduled in the current failure sequence
+    guint delay;                 // Delay of the last scheduled retry in seconds, 0 if none
+    guint prev_delay;            // Decorrelated jitter state
+    gboolean retrying;           // A retry is scheduled or in flight
+    guint consecutive_failures;  // Upstream failures since the last success, across sequences
+    RetryCircuitState circuit;
+    gint64 open_until;           // Unix time an open circuit lets a probe through
+    guint cooldown;              // Length of the current (or last) open period in seconds
+    FetchErrorClass last_error;
+
+    // Lifetime counters for metrics
+    guint64 failures[FETCH_ERROR_N_CLASSES];
+    guint64 retries_scheduled;
+    guint64 circuit_trips;
+    guint64 requests_suppressed;
+} RetryEngine;
+
+void retry_engine_init(RetryEngine *engine);
+
+FetchErrorClass retry_classify_error(const GError *error);
+// FETCH_ERROR_NONE for anything that isn't an HTTP error status
+FetchErrorClass retry_classify_status(guint status);
+
+// Stable snake_case name for logs and metric labels
+const gchar *fetch_error_class_name(FetchErrorClass error_class);
+// Short phrase for the UI ("server error", "no network connection", ...)
+const gchar *fetch_error_class_describe(FetchErrorClass error_class);
+const gchar *retry_circuit_state_name(RetryCircuitState state);
+
+// Whether a request may go out at 'now'. FALSE (and counted as suppressed)
+// while the circuit is open; once the cooldown is over the circuit turns
+// half-open and the request becomes the probe.
+gboolean retry_engine_allow_request(RetryEngine *engine, gint64 now);
+
+// Drop the current failure sequence (a fresh, non-retry fetch is starting).
+// The circuit breaker and counters are kept.
+void retry_engine_reset(RetryEngine *engine);
+
+// Record a failed fetch. Returns the seconds to wait before retrying, or 0 if
+// this sequence is over: attempts exhausted, a class that retrying can't fix,
+// or the circuit just opened (retry at open_until instead). retry_after is the
+// server's minimum delay in seconds, 0 if it gave none.
+guint retry_engine_failure(RetryEngine *engine, FetchErrorClass error_class, guint retry_after, gint64 now);
+
+void retry_engine_success(RetryEngine *engine);
+
+#endif // WEATHERCLOCK_RETRY_H
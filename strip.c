@@ -0,0 +1,524 @@
+#include "strip.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Geometry in logical pixels, matching the label cards this widget replaced
+#define STRIP_PADDING 4
+#define CARD_WIDTH 104
+#define CARD_HEIGHT 168
+#define CARD_GAP 14
+#define CARD_RADIUS 8
+#define ROW_TIME 8             // Top of each row within a card
+#define ROW_ICON 40
+#define ROW_TEMP 86
+#define ROW_DESC 140
+#define ICON_SIZE 40           // Square covered by an icon texture
+#define SPARKLINE_GAP 6
+#define SPARKLINE_HEIGHT 32
+#define SPARKLINE_INSET 5      // Keeps the dots inside the band
+#define DAYS_GAP 10            // Between the sparkline and the day panels
+#define DAY_HEIGHT 144         // Day panels share the card width
+#define DAY_ROW_DATE 8
+#define DAY_ROW_ICON 38
+#define DAY_ROW_RANGE 84
+#define DAY_ROW_PRECIP 118
+#define LAYOUT_CACHE_MAX 512   // Distinct strings per role kept shaped before the cache starts over
+
+typedef enum {
+    TEXT_TIME,
+    TEXT_ICON,
+    TEXT_TEMP,
+    TEXT_DESC,
+    TEXT_RANGE,
+    N_TEXT_ROLES
+} TextRole;
+
+static const struct {
+    gdouble size;
+    PangoWeight weight;
+} role_fonts[N_TEXT_ROLES] = {
+    { 22, PANGO_WEIGHT_BOLD },
+    { 32, PANGO_WEIGHT_NORMAL },
+    { 42, PANGO_WEIGHT_BOLD },
+    { 15, PANGO_WEIGHT_NORMAL },
+    { 24, PANGO_WEIGHT_BOLD },
+};
+
+static const GdkRGBA card_colour = { 50 / 255.0f, 50 / 255.0f, 50 / 255.0f, 0.8f };
+// card_colour over the flat .weather-section background (#111111)
+static const GdkRGBA flat_card_colour = { 0x2b / 255.0f, 0x2b / 255.0f, 0x2b / 255.0f, 1.0f };
+static const GdkRGBA text_colour = { 1.0f, 1.0f, 1.0f, 1.0f };
+static const GdkRGBA desc_colour = { 0xaa / 255.0f, 0xaa / 255.0f, 0xaa / 255.0f, 1.0f };
+static const GdkRGBA rain_colour = { 0x7f / 255.0f, 0xb8 / 255.0f, 0xff / 255.0f, 1.0f };
+
+static const gchar *const weekday_names[7] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+
+typedef struct {
+    gint32 hour;
+    gfloat temp;
+    guint8 code;
+} StripHour;
+
+struct _WeatherStrip {
+    GtkWidget parent_instance;
+
+    StripHour *hours;
+    guint max_hours;
+    guint n_hours;
+
+    ForecastDay *days;
+    guint max_days;
+    guint n_days;
+
+    WeatherStripStyle style;
+
+    PangoFontDescription *fonts[N_TEXT_ROLES];  // Derived from the widget's font on first use
+    GHashTable *layouts[N_TEXT_ROLES];           // Text -> shaped PangoLayout
+    GHashTable *icons;                           // Icon string (static) -> GdkTexture at icon_scale
+    gdouble icon_scale;
+    GskRenderNode *sparkline;                    // Built on first draw after the hours change
+};
+
+G_DEFINE_TYPE(WeatherStrip, weather_strip, GTK_TYPE_WIDGET)
+
+const gchar *weather_code_description(gint code) {
+    if (code == 0) return "Clear";
+    if (code <= 3) return "Cloudy";
+    if (code <= 49) return "Foggy";
+    if (code <= 59) return "Drizzle";
+    if (code <= 69) return "Rain";
+    if (code <= 79) return "Snow";
+    if (code <= 84) return "Rain Shower";
+    if (code <= 86) return "Snow Shower";
+    if (code <= 99) return "Thunderstorm";
+    return "Unknown";
+}
+
+const gchar *weather_code_icon(gint code) {
+    if (code == 0) return "☀️";
+    if (code <= 3) return "⛅";
+    if (code <= 49) return "🌫️";
+    if (code <= 59) return "🌦️";
+    if (code <= 69) return "🌧️";
+    if (code <= 79) return "❄️";
+    if (code <= 84) return "🌦️";
+    if (code <= 86) return "❄️";
+    if (code <= 99) return "⛈️";
+    return "❓";
+}
+
+static inline gfloat card_x(guint index) {
+    return STRIP_PADDING + index * (gfloat)(CARD_WIDTH + CARD_GAP);
+}
+
+static inline gint strip_width(guint n_hours) {
+    return n_hours > 0 ? 2 * STRIP_PADDING + (gint)n_hours * CARD_WIDTH + ((gint)n_hours - 1) * CARD_GAP : 0;
+}
+
+static inline gint strip_height(guint n_hours, guint n_days) {
+    gint height = n_hours > 0 ? CARD_HEIGHT + SPARKLINE_GAP + SPARKLINE_HEIGHT : 0;
+    if (n_days > 0) {
+        height += (n_hours > 0 ? DAYS_GAP : 0) + DAY_HEIGHT;
+    }
+    return height > 0 ? 2 * STRIP_PADDING + height : 0;
+}
+
+// Everything derived from the font settings; the next draw rebuilds what it needs
+static void drop_text_caches(WeatherStrip *self) {
+    for (guint i = 0; i < N_TEXT_ROLES; i++) {
+        g_clear_pointer(&self->fonts[i], pango_font_description_free);
+        g_hash_table_remove_all(self->layouts[i]);
+    }
+    g_hash_table_remove_all(self->icons);
+}
+
+static PangoLayout *get_layout(WeatherStrip *self, TextRole role, const gchar *text) {
+    PangoLayout *layout = g_hash_table_lookup(self->layouts[role], text);
+    if (layout) {
+        return layout;
+    }
+
+    if (!self->fonts[role]) {
+        PangoContext *context = gtk_widget_get_pango_context(GTK_WIDGET(self));
+        self->fonts[role] = pango_font_description_copy(pango_context_get_font_description(context));
+        pango_font_description_set_absolute_size(self->fonts[role], role_fonts[role].size * PANGO_SCALE);
+        pango_font_description_set_weight(self->fonts[role], role_fonts[role].weight);
+    }
+    if (g_hash_table_size(self->layouts[role]) >= LAYOUT_CACHE_MAX) {
+        g_hash_table_remove_all(self->layouts[role]);
+    }
+
+    layout = gtk_widget_create_pango_layout(GTK_WIDGET(self), text);
+    pango_layout_set_font_description(layout, self->fonts[role]);
+    g_hash_table_insert(self->layouts[role], g_strdup(text), layout);
+    return layout;
+}
+
+// Device pixels per logical pixel, fractional where GTK supports it
+static gdouble get_scale(WeatherStrip *self) {
+#if GTK_CHECK_VERSION(4, 12, 0)
+    GtkNative *native = gtk_widget_get_native(GTK_WIDGET(self));
+    GdkSurface *surface = native ? gtk_native_get_surface(native) : NULL;
+    if (surface) {
+        return gdk_surface_get_scale(surface);
+    }
+#endif
+    return gtk_widget_get_scale_factor(GTK_WIDGET(self));
+}
+
+// Colour emoji are the slow part of text rendering (font fallback plus bitmap
+// glyph scaling), so each icon is rendered once into a texture at the current
+// scale. NULL if there is no renderer to rasterize with yet.
+static GdkTexture *get_icon(WeatherStrip *self, const gchar *icon) {
+    gdouble scale = get_scale(self);
+    if (scale != self->icon_scale) {
+        g_hash_table_remove_all(self->icons);
+        self->icon_scale = scale;
+    }
+
+    GdkTexture *texture = g_hash_table_lookup(self->icons, icon);
+    if (texture) {
+        return texture;
+    }
+
+    GtkNative *native = gtk_widget_get_native(GTK_WIDGET(self));
+    GskRenderer *renderer = native ? gtk_native_get_renderer(native) : NULL;
+    if (!renderer) {
+        return NULL;
+    }
+
+    PangoLayout *layout = get_layout(self, TEXT_ICON, icon);
+    int width, height;
+    pango_layout_get_pixel_size(layout, &width, &height);
+
+    GtkSnapshot *snapshot = gtk_snapshot_new();
+    gtk_snapshot_scale(snapshot, (float)scale, (float)scale);
+    gtk_snapshot_translate(snapshot, &GRAPHENE_POINT_INIT((ICON_SIZE - width) / 2.0f, (ICON_SIZE - height) / 2.0f));
+    gtk_snapshot_append_layout(snapshot, layout, &text_colour);
+    GskRenderNode *node = gtk_snapshot_free_to_node(snapshot);
+    if (!node) {
+        return NULL;
+    }
+
+    gfloat size = ceilf((gfloat)(ICON_SIZE * scale));
+    texture = gsk_renderer_render_texture(renderer, node, &GRAPHENE_RECT_INIT(0, 0, size, size));
+    gsk_render_node_unref(node);
+    if (texture) {
+        // The icon strings are static, so the pointer is the key
+        g_hash_table_insert(self->icons, (gpointer)icon, texture);
+    }
+    return texture;
+}
+
+// Temperature curve through the card centres, with a dot per hour and gaps
+// where the API sent null
+static GskRenderNode *build_sparkline(WeatherStrip *self) {
+    gfloat low = INFINITY;
+    gfloat high = -INFINITY;
+    for (guint i = 0; i < self->n_hours; i++) {
+        if (!isnan(self->hours[i].temp)) {
+            low = MIN(low, self->hours[i].temp);
+            high = MAX(high, self->hours[i].temp);
+        }
+    }
+    if (low > high) {
+        return NULL;  // No temperatures at all
+    }
+    // A flat day still gets a readable line instead of dividing by zero
+    if (high - low < 2.0f) {
+        gfloat middle = (high + low) / 2.0f;
+        low = middle - 1.0f;
+        high = middle + 1.0f;
+    }
+
+    GtkSnapshot *snapshot = gtk_snapshot_new();
+    cairo_t *cr = gtk_snapshot_append_cairo(snapshot, &GRAPHENE_RECT_INIT(0, 0, (float)strip_width(self->n_hours),
+                                                                           SPARKLINE_HEIGHT));
+    cairo_set_source_rgba(cr, 1.0, 0.78, 0.35, 0.9);
+    cairo_set_line_width(cr, 2.0);
+    cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
+
+    gdouble span = SPARKLINE_HEIGHT - 2 * SPARKLINE_INSET;
+    gboolean drawing = FALSE;
+    for (guint i = 0; i < self->n_hours; i++) {
+        gfloat temp = self->hours[i].temp;
+        if (isnan(temp)) {
+            drawing = FALSE;
+            continue;
+        }
+        gdouble x = card_x(i) + CARD_WIDTH / 2.0;
+        gdouble y = SPARKLINE_INSET + (high - temp) / (high - low) * span;
+        if (drawing) {
+            cairo_line_to(cr, x, y);
+        } else {
+            cairo_move_to(cr, x, y);
+        }
+        drawing = TRUE;
+    }
+    cairo_stroke(cr);
+
+    for (guint i = 0; i < self->n_hours; i++) {
+        gfloat temp = self->hours[i].temp;
+        if (!isnan(temp)) {
+            cairo_new_sub_path(cr);
+            cairo_arc(cr, card_x(i) + CARD_WIDTH / 2.0, SPARKLINE_INSET + (high - temp) / (high - low) * span,
+                      3.0, 0, 2 * G_PI);
+        }
+    }
+    cairo_fill(cr);
+    cairo_destroy(cr);
+
+    return gtk_snapshot_free_to_node(snapshot);
+}
+
+// Text centred horizontally in the card whose left edge is x
+static void append_text(WeatherStrip *self, GtkSnapshot *snapshot, TextRole role, const gchar *text,
+                        gfloat x, gfloat y, const GdkRGBA *colour) {
+    PangoLayout *layout = get_layout(self, role, text);
+    int width;
+    pango_layout_get_pixel_size(layout, &width, NULL);
+
+    gtk_snapshot_save(snapshot);
+    gtk_snapshot_translate(snapshot, &GRAPHENE_POINT_INIT(x + (CARD_WIDTH - width) / 2.0f, y));
+    gtk_snapshot_append_layout(snapshot, layout, colour);
+    gtk_snapshot_restore(snapshot);
+}
+
+// Background of one card or day panel in the current style
+static void append_card(WeatherStrip *self, GtkSnapshot *snapshot, const graphene_rect_t *bounds) {
+    if (self->style == WEATHER_STRIP_STYLE_FLAT) {
+        gtk_snapshot_append_color(snapshot, &flat_card_colour, bounds);
+    } else if (self->style == WEATHER_STRIP_STYLE_ROUNDED) {
+        GskRoundedRect card;
+        gsk_rounded_rect_init_from_rect(&card, bounds, CARD_RADIUS);
+        gtk_snapshot_push_rounded_clip(snapshot, &card);
+        gtk_snapshot_append_color(snapshot, &card_colour, &card.bounds);
+        gtk_snapshot_pop(snapshot);
+    }
+}
+
+// One day panel: date, the day's most severe weather, high / low and rain
+static void append_day(WeatherStrip *self, GtkSnapshot *snapshot, const ForecastDay *day, gfloat x, gfloat y) {
+    append_card(self, snapshot, &GRAPHENE_RECT_INIT(x, y, CARD_WIDTH, DAY_HEIGHT));
+
+    char text[32];
+    gint day_of_month = 0;
+    forecast_civil_from_days(day->day, NULL, NULL, &day_of_month);
+    // 1970-01-01 was a Thursday
+    snprintf(text, sizeof(text), "%s %d", weekday_names[((day->day % 7) + 11) % 7], day_of_month);
+    append_text(self, snapshot, TEXT_TIME, text, x, y + DAY_ROW_DATE, &text_colour);
+
+    const gchar *icon = weather_code_icon(day->code);
+    GdkTexture *texture = get_icon(self, icon);
+    if (texture) {
+        gtk_snapshot_append_texture(snapshot, texture, &GRAPHENE_RECT_INIT(x + (CARD_WIDTH - ICON_SIZE) / 2.0f,
+                                                                           y + DAY_ROW_ICON, ICON_SIZE, ICON_SIZE));
+    } else {
+        append_text(self, snapshot, TEXT_ICON, icon, x, y + DAY_ROW_ICON, &text_colour);
+    }
+
+    if (isnan(day->temp_max)) {
+        g_strlcpy(text, "N/A", sizeof(text));
+    } else {
+        snprintf(text, sizeof(text), "%.0f° / %.0f°", day->temp_max, day->temp_min);
+    }
+    append_text(self, snapshot, TEXT_RANGE, text, x, y + DAY_ROW_RANGE, &text_colour);
+
+    if (!isnan(day->precip)) {
+        snprintf(text, sizeof(text), "%.1f mm", day->precip);
+        append_text(self, snapshot, TEXT_DESC, text, x, y + DAY_ROW_PRECIP, &rain_colour);
+    }
+}
+
+static void weather_strip_snapshot(GtkWidget *widget, GtkSnapshot *snapshot) {
+    WeatherStrip *self = WEATHER_STRIP(widget);
+
+    for (guint i = 0; i < self->n_hours; i++) {
+        const StripHour *hour = &self->hours[i];
+        gfloat x = card_x(i);
+        gfloat y = STRIP_PADDING;
+
+        append_card(self, snapshot, &GRAPHENE_RECT_INIT(x, y, CARD_WIDTH, CARD_HEIGHT));
+
+        char text[32];
+        snprintf(text, sizeof(text), "%02d:00", forecast_hour_of_day(hour->hour));
+        append_text(self, snapshot, TEXT_TIME, text, x, y + ROW_TIME, &text_colour);
+
+        const gchar *icon = weather_code_icon(hour->code);
+        GdkTexture *texture = get_icon(self, icon);
+        if (texture) {
+            gtk_snapshot_append_texture(snapshot, texture, &GRAPHENE_RECT_INIT(x + (CARD_WIDTH - ICON_SIZE) / 2.0f,
+                                                                               y + ROW_ICON, ICON_SIZE, ICON_SIZE));
+        } else {
+            append_text(self, snapshot, TEXT_ICON, icon, x, y + ROW_ICON, &text_colour);
+        }
+
+        if (isnan(hour->temp)) {
+            g_strlcpy(text, "N/A", sizeof(text));
+        } else {
+            snprintf(text, sizeof(text), "%.1f°C", hour->temp);
+        }
+        append_text(self, snapshot, TEXT_TEMP, text, x, y + ROW_TEMP, &text_colour);
+        append_text(self, snapshot, TEXT_DESC, weather_code_description(hour->code), x, y + ROW_DESC, &desc_colour);
+    }
+
+    if (!self->sparkline && self->n_hours > 1) {
+        self->sparkline = build_sparkline(self);
+    }
+    if (self->sparkline) {
+        gtk_snapshot_save(snapshot);
+        gtk_snapshot_translate(snapshot, &GRAPHENE_POINT_INIT(0, STRIP_PADDING + CARD_HEIGHT + SPARKLINE_GAP));
+        gtk_snapshot_append_node(snapshot, self->sparkline);
+        gtk_snapshot_restore(snapshot);
+    }
+
+    gfloat days_y = self->n_hours > 0 ? STRIP_PADDING + CARD_HEIGHT + SPARKLINE_GAP + SPARKLINE_HEIGHT + DAYS_GAP
+                                      : STRIP_PADDING;
+    for (guint i = 0; i < self->n_days; i++) {
+        append_day(self, snapshot, &self->days[i], card_x(i), days_y);
+    }
+}
+
+static void weather_strip_measure(GtkWidget *widget, GtkOrientation orientation, int for_size,
+                                  int *minimum, int *natural, int *minimum_baseline, int *natural_baseline) {
+    (void)for_size;
+    WeatherStrip *self = WEATHER_STRIP(widget);
+
+    if (orientation == GTK_ORIENTATION_HORIZONTAL) {
+        *minimum = *natural = strip_width(MAX(self->n_hours, self->n_days));
+    } else {
+        *minimum = *natural = strip_height(self->n_hours, self->n_days);
+    }
+    *minimum_baseline = *natural_baseline = -1;
+}
+
+static void weather_strip_unrealize(GtkWidget *widget) {
+    // Textures from this surface's renderer don't outlive it
+    g_hash_table_remove_all(WEATHER_STRIP(widget)->icons);
+    GTK_WIDGET_CLASS(weather_strip_parent_class)->unrealize(widget);
+}
+
+static void weather_strip_system_setting_changed(GtkWidget *widget, GtkSystemSetting setting) {
+    GTK_WIDGET_CLASS(weather_strip_parent_class)->system_setting_changed(widget, setting);
+    if (setting == GTK_SYSTEM_SETTING_DPI || setting == GTK_SYSTEM_SETTING_FONT_NAME ||
+        setting == GTK_SYSTEM_SETTING_FONT_CONFIG) {
+        drop_text_caches(WEATHER_STRIP(widget));
+        gtk_widget_queue_draw(widget);
+    }
+}
+
+static void weather_strip_finalize(GObject *object) {
+    WeatherStrip *self = WEATHER_STRIP(object);
+
+    for (guint i = 0; i < N_TEXT_ROLES; i++) {
+        g_clear_pointer(&self->fonts[i], pango_font_description_free);
+        g_hash_table_unref(self->layouts[i]);
+    }
+    g_hash_table_unref(self->icons);
+    g_clear_pointer(&self->sparkline, gsk_render_node_unref);
+    g_free(self->hours);
+    g_free(self->days);
+
+    G_OBJECT_CLASS(weather_strip_parent_class)->finalize(object);
+}
+
+static void weather_strip_class_init(WeatherStripClass *klass) {
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    GtkWidgetClass *widget_class = GTK_WIDGET_CLASS(klass);
+
+    object_class->finalize = weather_strip_finalize;
+    widget_class->snapshot = weather_strip_snapshot;
+    widget_class->measure = weather_strip_measure;
+    widget_class->unrealize = weather_strip_unrealize;
+    widget_class->system_setting_changed = weather_strip_system_setting_changed;
+    gtk_widget_class_set_css_name(widget_class, "weatherstrip");
+}
+
+static void weather_strip_init(WeatherStrip *self) {
+    for (guint i = 0; i < N_TEXT_ROLES; i++) {
+        self->layouts[i] = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
+    }
+    self->icons = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_object_unref);
+}
+
+GtkWidget *weather_strip_new(guint max_hours, guint max_days) {
+    WeatherStrip *self = g_object_new(WEATHER_TYPE_STRIP, NULL);
+    self->max_hours = max_hours;
+    self->hours = g_new0(StripHour, max_hours);
+    self->max_days = max_days;
+    self->days = max_days > 0 ? g_new0(ForecastDay, max_days) : NULL;
+    return GTK_WIDGET(self);
+}
+
+static gboolean same_hour(const StripHour *a, const StripHour *b) {
+    gboolean same_temp = a->temp == b->temp || (isnan(a->temp) && isnan(b->temp));
+    return a->hour == b->hour && a->code == b->code && same_temp;
+}
+
+void weather_strip_set_forecast(WeatherStrip *self, const WeatherForecast *forecast, guint start_index) {
+    g_return_if_fail(WEATHER_IS_STRIP(self));
+
+    guint n = 0;
+    gboolean changed = FALSE;
+    for (guint i = start_index; forecast && i < forecast->n_hours && n < self->max_hours; i++) {
+        if (forecast->hours[i] == FORECAST_HOUR_INVALID) {
+            continue;  // Skip invalid time
+        }
+        StripHour hour = { forecast->hours[i], forecast->temps[i], forecast->codes[i] };
+        if (n >= self->n_hours || !same_hour(&self->hours[n], &hour)) {
+            self->hours[n] = hour;
+            changed = TRUE;
+        }
+        n++;
+    }
+
+    if (n != self->n_hours) {
+        self->n_hours = n;
+        changed = TRUE;
+        gtk_widget_queue_resize(GTK_WIDGET(self));
+    }
+    if (changed) {
+        g_clear_pointer(&self->sparkline, gsk_render_node_unref);
+        gtk_widget_queue_draw(GTK_WIDGET(self));
+    }
+}
+
+static gboolean same_day(const ForecastDay *a, const ForecastDay *b) {
+    // Byte-wise so NAN aggregates compare equal; start and span don't show
+    return a->day == b->day && a->code == b->code && memcmp(&a->temp_min, &b->temp_min, sizeof(gfloat)) == 0 &&
+           memcmp(&a->temp_max, &b->temp_max, sizeof(gfloat)) == 0 &&
+           memcmp(&a->precip, &b->precip, sizeof(gfloat)) == 0;
+}
+
+void weather_strip_set_days(WeatherStrip *self, const ForecastDay *days, guint n_days) {
+    g_return_if_fail(WEATHER_IS_STRIP(self));
+
+    guint n = days ? MIN(n_days, self->max_days) : 0;
+    gboolean changed = FALSE;
+    for (guint i = 0; i < n; i++) {
+        if (i >= self->n_days || !same_day(&self->days[i], &days[i])) {
+            self->days[i] = days[i];
+            changed = TRUE;
+        }
+    }
+
+    if (n != self->n_days) {
+        self->n_days = n;
+        changed = TRUE;
+        gtk_widget_queue_resize(GTK_WIDGET(self));
+    }
+    if (changed) {
+        gtk_widget_queue_draw(GTK_WIDGET(self));
+    }
+}
+
+void weather_strip_set_style(WeatherStrip *self, WeatherStripStyle style) {
+    g_return_if_fail(WEATHER_IS_STRIP(self));
+
+    if (style != self->style) {
+        self->style = style;
+        gtk_widget_queue_draw(GTK_WIDGET(self));
+    }
+}
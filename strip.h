@@ -0,0 +1,41 @@
+#ifndef WEATHERCLOCK_STRIP_H
+#define WEATHERCLOCK_STRIP_H
+
+#include <gtk/gtk.h>
+
+#include "forecast.h"
+
+// One location's forecast hours drawn by a single widget: a row of cards (time,
+// icon, temperature, description) above a temperature sparkline, optionally
+// followed by a row of day panels for the extended forecast. A week-long
+// strip is one CSS node instead of five per hour; icons are rasterized to a
+// texture once per weather icon and display scale, and each distinct string is
+// shaped once and reused from then on.
+
+#define WEATHER_TYPE_STRIP (weather_strip_get_type())
+G_DECLARE_FINAL_TYPE(WeatherStrip, weather_strip, WEATHER, STRIP, GtkWidget)
+
+// Card backgrounds, from the designed look down to what a slow GPU can afford
+typedef enum {
+    WEATHER_STRIP_STYLE_ROUNDED,  // Translucent cards with rounded corners
+    WEATHER_STRIP_STYLE_FLAT,     // The same colour, opaque and square: no blending or clipping
+    WEATHER_STRIP_STYLE_BARE      // No card backgrounds, text only
+} WeatherStripStyle;
+
+// A strip of at most max_hours cards and max_days day panels (0 for none)
+GtkWidget *weather_strip_new(guint max_hours, guint max_days);
+
+// Show the forecast from start_index on, skipping hours with an invalid time.
+// The values are copied, and nothing is redrawn when they didn't change.
+void weather_strip_set_forecast(WeatherStrip *self, const WeatherForecast *forecast, guint start_index);
+
+// Show up to max_days day panels. Copied; nothing is redrawn when they didn't change.
+void weather_strip_set_days(WeatherStrip *self, const ForecastDay *days, guint n_days);
+
+void weather_strip_set_style(WeatherStrip *self, WeatherStripStyle style);
+
+// WMO weather code to a short description and an emoji icon
+const gchar *weather_code_description(gint code);
+const gchar *weather_code_icon(gint code);
+
+#endif // WEATHERCLOCK_STRIP_H
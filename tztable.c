@@ -0,0 +1,56 @@
+#include "tztable.h"
+
+static gint32 offset_at(GTimeZone *tz, gint64 time) {
+    gint interval = g_time_zone_find_interval(tz, G_TIME_TYPE_UNIVERSAL, time);
+    return interval >= 0 ? g_time_zone_get_offset(tz, interval) : 0;
+}
+
+// First second in (lo, hi] whose offset differs from the one at lo
+static gint64 find_transition(GTimeZone *tz, gint64 lo, gint64 hi, gint32 offset_lo) {
+    while (hi - lo > 1) {
+        gint64 mid = lo + (hi - lo) / 2;
+        if (offset_at(tz, mid) == offset_lo) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return hi;
+}
+
+void tz_table_build(TzTable *table, GTimeZone *tz, gint64 now) {
+    table->valid_from = now;
+    table->valid_until = now + TZ_TABLE_SPAN;
+    table->n_transitions = 0;
+    for (guint i = 0; i < TZ_TABLE_SLOTS; i++) {
+        table->transitions[i] = G_MAXINT64;
+    }
+
+    gint32 offset = offset_at(tz, now);
+    for (guint i = 0; i <= TZ_TABLE_SLOTS; i++) {
+        table->offsets[i] = offset;
+    }
+
+    // GTimeZone has no public way to enumerate its transitions, so walk the
+    // span a day at a time and bisect each step where the offset changed:
+    // about 400 interval lookups per year, done once instead of every tick
+    for (gint64 t = now; t < table->valid_until; t += TZ_TABLE_PROBE_STEP) {
+        gint64 next = MIN(t + TZ_TABLE_PROBE_STEP, table->valid_until);
+        gint32 next_offset = offset_at(tz, next);
+        if (next_offset == offset) {
+            continue;
+        }
+
+        gint64 transition = find_transition(tz, t, next, offset);
+        if (table->n_transitions == TZ_TABLE_SLOTS) {
+            // Out of slots: end the window here, the next build picks up from it
+            table->valid_until = transition;
+            break;
+        }
+        table->transitions[table->n_transitions++] = transition;
+        for (guint i = table->n_transitions; i <= TZ_TABLE_SLOTS; i++) {
+            table->offsets[i] = next_offset;
+        }
+        offset = next_offset;
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef WEATHERCLOCK_TZTABLE_H
+#define WEATHERCLOCK_TZTABLE_H
+
+#include <glib.h>
+
+// UTC offsets of one timezone over the coming year, precomputed so the clock
+// can look the offset up every tick without touching GTimeZone or the heap.
+// Built by probing the zone once; rebuilt when the window runs out or the zone
+// changes.
+
+#define TZ_TABLE_SLOTS 8               // Transitions kept per window; real zones have at most 2 a year
+#define TZ_TABLE_SPAN (366 * 86400)    // Seconds a table is built to cover
+#define TZ_TABLE_PROBE_STEP 86400      // Zones are assumed never to change offset twice within this
+
+typedef struct {
+    gint64 valid_from;                   // Unix time range the table answers for;
+    gint64 valid_until;                  // valid_until == 0 means not built
+    gint64 transitions[TZ_TABLE_SLOTS];  // Unix time each later offset takes effect, ascending;
+                                         // unused slots hold G_MAXINT64
+    gint32 offsets[TZ_TABLE_SLOTS + 1];  // offsets[i] applies once i transitions have passed
+    guint n_transitions;
+} TzTable;
+
+void tz_table_build(TzTable *table, GTimeZone *tz, gint64 now);
+
+static inline void tz_table_invalidate(TzTable *table) {
+    table->valid_until = 0;
+}
+
+static inline gboolean tz_table_covers(const TzTable *table, gint64 now) {
+    return now >= table->valid_from && now < table->valid_until;
+}
+
+// Offset at `now`, which must be covered by the table. Counts passed
+// transitions over every slot, padding included, so there is no data-dependent
+// branch for the tick to mispredict.
+static inline gint32 tz_table_lookup(const TzTable *table, gint64 now) {
+    guint passed = 0;
+    for (guint i = 0; i < TZ_TABLE_SLOTS; i++) {
+        passed += (guint)(now >= table->transitions[i]);
+    }
+    return table->offsets[passed];
+}
+
+#endif // WEATHERCLOCK_TZTABLE_H
@@ -0,0 +1,188 @@
+#include "watchdog.h"
+
+#include <string.h>
+
+#define WATCHDOG_MIN_PERIOD_MS 10
+
+// Bucket bounds in seconds
+static const gdouble lag_bounds[] = { 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1 };
+static const gdouble stall_bounds[] = { 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30 };
+
+// Label set by watchdog_begin(); read by the watchdog thread
+static const gchar *current_activity = NULL;
+
+typedef struct {
+    GSource source;
+    Watchdog *watchdog;
+} PingSource;
+
+struct _Watchdog {
+    guint threshold_ms;
+    gint64 period_us;
+    GSource *ping;            // High priority, made ready by the thread for each ping
+    GThread *thread;
+    WatchdogStats stats;
+
+    // Shared with the thread, under lock
+    GMutex lock;
+    GCond cond;               // Signalled to stop the thread
+    gboolean stopping;
+    gint64 ping_sent_at;      // Monotonic time of the outstanding ping, 0 if none
+    gboolean stall_sampled;   // The outstanding ping is late; stall_activity holds the label then
+    const gchar *stall_activity;
+    gboolean hang_logged;
+};
+
+static const gchar *activity_name(const gchar *activity) {
+    return activity ? activity : "other";
+}
+
+static void record_stall(Watchdog *watchdog, gint64 stall_us, const gchar *activity) {
+    WatchdogStats *stats = &watchdog->stats;
+    metrics_histogram_observe(&stats->stalls, (gdouble)stall_us / G_USEC_PER_SEC);
+
+    // Labels are static strings, but the same text may come from several places
+    guint slot = 0;
+    if (activity) {
+        for (slot = 1; slot < stats->n_activities; slot++) {
+            if (strcmp(stats->activities[slot], activity) == 0) {
+                break;
+            }
+        }
+        if (slot == stats->n_activities) {
+            if (slot < WATCHDOG_MAX_ACTIVITIES) {
+                stats->activities[slot] = activity;
+                stats->n_activities++;
+            } else {
+                slot = 0;  // Table full: counted as "other"
+            }
+        }
+    }
+    stats->activity_stalls[slot]++;
+
+    g_warning("Main loop stalled for %.0f ms (in %s)", stall_us / 1000.0, activity_name(activity));
+}
+
+static gboolean ping_dispatch(GSource *source, GSourceFunc callback, gpointer user_data) {
+    (void)callback;
+    (void)user_data;
+    Watchdog *watchdog = ((PingSource *)source)->watchdog;
+    g_source_set_ready_time(source, -1);
+
+    g_mutex_lock(&watchdog->lock);
+    gint64 sent_at = watchdog->ping_sent_at;
+    gboolean sampled = watchdog->stall_sampled;
+    const gchar *activity = watchdog->stall_activity;
+    watchdog->ping_sent_at = 0;
+    watchdog->stall_sampled = FALSE;
+    watchdog->stall_activity = NULL;
+    watchdog->hang_logged = FALSE;
+    g_mutex_unlock(&watchdog->lock);
+    if (sent_at == 0) {
+        return G_SOURCE_CONTINUE;
+    }
+
+    gint64 lag_us = g_get_monotonic_time() - sent_at;
+    metrics_histogram_observe(&watchdog->stats.lag, (gdouble)lag_us / G_USEC_PER_SEC);
+    if (lag_us >= (gint64)watchdog->threshold_ms * 1000) {
+        // Not sampled: the loop got free just as the thread would have looked
+        record_stall(watchdog, lag_us, sampled ? activity : NULL);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs ping_source_funcs = {
+    NULL,
+    NULL,
+    ping_dispatch,
+    NULL,
+    NULL,
+    NULL,
+};
+
+static gpointer watchdog_thread(gpointer user_data) {
+    Watchdog *watchdog = (Watchdog *)user_data;
+    gint64 threshold_us = (gint64)watchdog->threshold_ms * 1000;
+
+    g_mutex_lock(&watchdog->lock);
+    while (!watchdog->stopping) {
+        gint64 now = g_get_monotonic_time();
+        if (watchdog->ping_sent_at == 0) {
+            watchdog->ping_sent_at = now;
+            g_source_set_ready_time(watchdog->ping, 0);
+        } else {
+            gint64 waiting = now - watchdog->ping_sent_at;
+            if (!watchdog->stall_sampled && waiting >= threshold_us) {
+                // Whatever the main thread is in right now is what holds the loop
+                watchdog->stall_activity = g_atomic_pointer_get(&current_activity);
+                watchdog->stall_sampled = TRUE;
+            }
+            if (!watchdog->hang_logged && waiting >= WATCHDOG_HANG_MS * 1000) {
+                // The ping may never be dispatched; say so while it's happening
+                g_warning("Main loop unresponsive for %.0f ms (in %s)", waiting / 1000.0,
+                          activity_name(watchdog->stall_activity));
+                watchdog->hang_logged = TRUE;
+            }
+        }
+        g_cond_wait_until(&watchdog->cond, &watchdog->lock, now + watchdog->period_us);
+    }
+    g_mutex_unlock(&watchdog->lock);
+    return NULL;
+}
+
+Watchdog *watchdog_new(guint threshold_ms) {
+    Watchdog *watchdog = g_new0(Watchdog, 1);
+    watchdog->threshold_ms = CLAMP(threshold_ms, WATCHDOG_MIN_THRESHOLD_MS, WATCHDOG_MAX_THRESHOLD_MS);
+    watchdog->period_us = (gint64)MAX(watchdog->threshold_ms / 2, WATCHDOG_MIN_PERIOD_MS) * 1000;
+    metrics_histogram_init(&watchdog->stats.lag, lag_bounds, G_N_ELEMENTS(lag_bounds));
+    metrics_histogram_init(&watchdog->stats.stalls, stall_bounds, G_N_ELEMENTS(stall_bounds));
+    watchdog->stats.activities[0] = activity_name(NULL);
+    watchdog->stats.n_activities = 1;
+    g_mutex_init(&watchdog->lock);
+    g_cond_init(&watchdog->cond);
+
+    // Ahead of redraws and timers, so the delay measured is the loop's, not the queue's
+    watchdog->ping = g_source_new(&ping_source_funcs, sizeof(PingSource));
+    ((PingSource *)watchdog->ping)->watchdog = watchdog;
+    g_source_set_priority(watchdog->ping, G_PRIORITY_HIGH);
+    g_source_set_name(watchdog->ping, "weatherclock watchdog ping");
+    g_source_attach(watchdog->ping, NULL);
+
+    watchdog->thread = g_thread_new("watchdog", watchdog_thread, watchdog);
+    return watchdog;
+}
+
+void watchdog_free(Watchdog *watchdog) {
+    if (!watchdog) {
+        return;
+    }
+    g_mutex_lock(&watchdog->lock);
+    watchdog->stopping = TRUE;
+    g_cond_signal(&watchdog->cond);
+    g_mutex_unlock(&watchdog->lock);
+    g_thread_join(watchdog->thread);
+
+    g_source_destroy(watchdog->ping);
+    g_source_unref(watchdog->ping);
+    g_cond_clear(&watchdog->cond);
+    g_mutex_clear(&watchdog->lock);
+    g_free(watchdog);
+}
+
+guint watchdog_get_threshold(const Watchdog *watchdog) {
+    return watchdog->threshold_ms;
+}
+
+const WatchdogStats *watchdog_get_stats(const Watchdog *watchdog) {
+    return &watchdog->stats;
+}
+
+const gchar *watchdog_begin(const gchar *activity) {
+    const gchar *previous = g_atomic_pointer_get(&current_activity);
+    g_atomic_pointer_set(&current_activity, activity);
+    return previous;
+}
+
+void watchdog_end(const gchar *previous) {
+    g_atomic_pointer_set(&current_activity, previous);
+}
@@ -0,0 +1,48 @@
+#ifndef WEATHERCLOCK_WATCHDOG_H
+#define WEATHERCLOCK_WATCHDOG_H
+
+#include <glib.h>
+
+#include "metrics.h"
+
+// Main-loop stall profiler. A watchdog thread pings the default GMainContext
+// every half threshold through a high-priority source and measures how long the
+// ping waits to be dispatched. A ping that waits threshold_ms or longer is a
+// stall: it is logged and counted against the activity the main thread had
+// announced with watchdog_begin() when the watchdog thread looked, so the
+// culprit is the code that was running, not whatever ran once the loop was free.
+//
+// Costs two wakeups per period and an atomic pointer store per labelled
+// activity; nothing is allocated after watchdog_new().
+
+#define WATCHDOG_MIN_THRESHOLD_MS 20
+#define WATCHDOG_MAX_THRESHOLD_MS 60000
+#define WATCHDOG_HANG_MS 5000          // Logged from the watchdog thread while still stuck
+#define WATCHDOG_MAX_ACTIVITIES 16     // Distinct labels counted; activities[0] is "other"
+
+typedef struct {
+    MetricsHistogram lag;      // Dispatch delay of every ping, in seconds
+    MetricsHistogram stalls;   // Length of the stalls (pings that waited threshold_ms or longer)
+    guint n_activities;
+    const gchar *activities[WATCHDOG_MAX_ACTIVITIES];  // Labels seen in stalls; unlabelled time is "other"
+    guint64 activity_stalls[WATCHDOG_MAX_ACTIVITIES];
+} WatchdogStats;
+
+typedef struct _Watchdog Watchdog;
+
+// Starts the thread and attaches the ping source to the default main context.
+// Call from the main thread; threshold_ms is clamped to the limits above.
+Watchdog *watchdog_new(guint threshold_ms);
+void watchdog_free(Watchdog *watchdog);
+
+guint watchdog_get_threshold(const Watchdog *watchdog);
+// Main thread only; updated as pings are dispatched
+const WatchdogStats *watchdog_get_stats(const Watchdog *watchdog);
+
+// Label what the main thread is about to do ("config save"). activity must be
+// a static string. Returns the previous label for watchdog_end(), so labelled
+// code may nest. Works (and costs the same) whether or not a watchdog runs.
+const gchar *watchdog_begin(const gchar *activity);
+void watchdog_end(const gchar *previous);
+
+#endif // WEATHERCLOCK_WATCHDOG_H